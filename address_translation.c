@@ -31,16 +31,56 @@
 // Module Name: Address Translator
 // File Name: address translation.c
 //
-// Version: v1.0.0
+// Version: v1.8.2
 //
 // Description:
 //   - translate address between address space of host system and address space of NAND device
 //   - manage bad blocks in NAND device
+//   - separate hot and cold data into per-die write streams
+//   - restore the maps from the map checkpoint at power-on
 //////////////////////////////////////////////////////////////////////////////////
 
 //////////////////////////////////////////////////////////////////////////////////
 // Revision History:
 //
+// * v1.8.2
+//   - checkpoint slot blocks are taken from the good blocks of the bad block table
+//
+// * v1.8.1
+//   - erases of user blocks are issued and counted in one place, lazy erases of unerased free blocks included
+//
+// * v1.8.0
+//   - write streams are picked by the temperature of the slice group kept by the write temperature tracker
+//
+// * v1.7.0
+//   - erased free blocks are kept in the free block heaps of the wear leveler, the least worn one is taken first
+//   - GC erases are counted for static wear leveling
+//
+// * v1.6.0
+//   - a format leaves the user blocks on the dirty free block lists instead of erasing them
+//   - unerased free blocks are erased when taken or by LazyEraseScheduler in the idle loop
+//
+// * v1.5.0
+//   - the bad block scan reads the marks of BAD_BLOCK_SCAN_DEPTH blocks of every die per round
+//   - format erases keep INIT_ERASE_QUEUE_DEPTH requests queued on every way
+//   - both report their progress
+//
+// * v1.4.0
+//   - the maps are restored from the last checkpoint instead of erasing the user blocks at power-on
+//
+// * v1.3.0
+//   - a die short of free blocks is skipped by host slice allocation instead of collecting in the write path
+//
+// * v1.2.1
+//   - host writes earn GC copy tokens of their die
+//
+// * v1.2.0
+//   - slices of a write stream alternate between open blocks of both planes page by page
+//
+// * v1.1.0
+//   - each die has WRITE_STREAM_COUNT current blocks, selected by LSA temperature
+//   - AddrTransTrim deallocates logical slices for Dataset Management
+//
 // * v1.0.0
 //   - First draft
 //////////////////////////////////////////////////////////////////////////////////
@@ -82,10 +122,10 @@ void InitAddressMap()
 		bbtInfoMapPtr->bbtInfo[dieNo].grownBadUpdate = BBT_INFO_GROWN_BAD_UPDATE_NONE;
 	}
 
-	sliceAllocationTargetDie = FindDieForFreeSliceAllocation();
-
 	InitSliceMap();
 	InitBlockDieMap();
+
+	sliceAllocationTargetDie = FindDieForFreeSliceAllocation();
 }
 
 void InitSliceMap()
@@ -211,9 +251,11 @@ void InitDieMap()
 
 	for(dieNo=0 ; dieNo<USER_DIES ; dieNo++)
 	{
-		virtualDieMapPtr->die[dieNo].headFreeBlock = BLOCK_NONE;
-		virtualDieMapPtr->die[dieNo].tailFreeBlock = BLOCK_NONE;
+		ResetFreeBlockHeap(dieNo);
 		virtualDieMapPtr->die[dieNo].freeBlockCnt = 0;
+		virtualDieMapPtr->die[dieNo].headDirtyFreeBlock = BLOCK_NONE;
+		virtualDieMapPtr->die[dieNo].tailDirtyFreeBlock = BLOCK_NONE;
+		virtualDieMapPtr->die[dieNo].dirtyFreeBlockCnt = 0;
 	}
 }
 
@@ -230,6 +272,7 @@ void InitBlockMap()
 			virtualBlockMapPtr->block[dieNo][virtualBlockNo].bad = phyBlockMapPtr->phyBlock[dieNo][remappedPhyBlock].bad;
 
 			virtualBlockMapPtr->block[dieNo][virtualBlockNo].free = 1;
+			virtualBlockMapPtr->block[dieNo][virtualBlockNo].unerased = 0;
 			virtualBlockMapPtr->block[dieNo][virtualBlockNo].invalidSliceCnt = 0;
 			virtualBlockMapPtr->block[dieNo][virtualBlockNo].currentPage = 0;
 			virtualBlockMapPtr->block[dieNo][virtualBlockNo].eraseCnt = 0;
@@ -247,13 +290,35 @@ void InitBlockMap()
 
 void InitCurrentBlockOfDieMap()
 {
-	unsigned int dieNo;
+	unsigned int dieNo, writeStream;
 
 	for(dieNo=0 ; dieNo<USER_DIES ; dieNo++)
+		for(writeStream=0 ; writeStream<WRITE_STREAM_COUNT ; writeStream++)
+		{
+			virtualDieMapPtr->die[dieNo].currentBlock[writeStream] = GetFromFbList(dieNo, GET_FREE_BLOCK_NORMAL);
+			if(virtualDieMapPtr->die[dieNo].currentBlock[writeStream] == BLOCK_FAIL)
+				assert(!"[WARNING] There is no free block [WARNING]");
+
+			virtualDieMapPtr->die[dieNo].planeBlock[writeStream] = BLOCK_NONE;
+#if SUPPORT_MULTI_PLANE
+			virtualDieMapPtr->die[dieNo].planeBlock[writeStream] = GetFromFbListOfPlane(dieNo, Vblock2PplaneTranslation(dieNo, virtualDieMapPtr->die[dieNo].currentBlock[writeStream]) ^ 1);
+#endif
+		}
+}
+
+//prints every INIT_PROGRESS_STEPS th of the blocks of a die handled by all dies
+static void ReportInitProgress(char* action, unsigned int doneBlockCnt, unsigned int blockCnt, unsigned int* reportedStep)
+{
+	unsigned int step;
+
+	if(doneBlockCnt > blockCnt)
+		doneBlockCnt = blockCnt;
+
+	step = doneBlockCnt * INIT_PROGRESS_STEPS / blockCnt;
+	if(step > *reportedStep)
 	{
-		virtualDieMapPtr->die[dieNo].currentBlock = GetFromFbList(dieNo, GET_FREE_BLOCK_NORMAL);
-		if(virtualDieMapPtr->die[dieNo].currentBlock == BLOCK_FAIL)
-			assert(!"[WARNING] There is no free block [WARNING]");
+		*reportedStep = step;
+		xil_printf("	%d%% of blocks are %s\r\n", step * 100 / INIT_PROGRESS_STEPS, action);
 	}
 }
 
@@ -301,100 +366,69 @@ void ReadBadBlockTable(unsigned int tempBbtBufAddr[], unsigned int tempBbtBufEnt
 
 void FindBadBlock(unsigned char dieState[], unsigned int tempBbtBufAddr[], unsigned int tempBbtBufEntrySize, unsigned int tempReadBufAddr[], unsigned int tempReadBufEntrySize)
 {
-	unsigned int phyBlockNo, dieNo, reqSlotTag;
-	unsigned char blockChecker[USER_DIES];
+	unsigned int baseBlockNo, phyBlockNo, dieNo, scanCnt, markPage, reqSlotTag, reportedStep;
+	unsigned char blockChecker;
 	unsigned char* markPointer0;
 	unsigned char* markPointer1;
 	unsigned char* bbtUpdater;
 
-	//check bad block mark of each block
-	for(phyBlockNo = 0; phyBlockNo < TOTAL_BLOCKS_PER_DIE; phyBlockNo++)
+	//check bad block marks of BAD_BLOCK_SCAN_DEPTH blocks of every die at a time, both mark pages are read together
+	reportedStep = 0;
+	for(baseBlockNo = 0; baseBlockNo < TOTAL_BLOCKS_PER_DIE; baseBlockNo += BAD_BLOCK_SCAN_DEPTH)
 	{
 		for(dieNo=0; dieNo < USER_DIES; dieNo++)
 			if(!dieState[dieNo])
-			{
-				blockChecker[dieNo] = BLOCK_STATE_NORMAL;
+				for(scanCnt = 0; (scanCnt < BAD_BLOCK_SCAN_DEPTH) && (baseBlockNo + scanCnt < TOTAL_BLOCKS_PER_DIE); scanCnt++)
+					for(markPage = 0; markPage < 2; markPage++)
+					{
+						reqSlotTag = GetFromFreeReqQ();
 
-				reqSlotTag = GetFromFreeReqQ();
+						reqPoolPtr->reqPool[reqSlotTag].reqType = REQ_TYPE_NAND;
+						reqPoolPtr->reqPool[reqSlotTag].reqCode = REQ_CODE_READ;
+						reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufFormat = REQ_OPT_DATA_BUF_ADDR;
+						reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandAddr = REQ_OPT_NAND_ADDR_PHY_ORG;
+						reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandEcc = REQ_OPT_NAND_ECC_OFF;
+						reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandEccWarning = REQ_OPT_NAND_ECC_WARNING_OFF;
+						reqPoolPtr->reqPool[reqSlotTag].reqOpt.rowAddrDependencyCheck = REQ_OPT_ROW_ADDR_DEPENDENCY_NONE;
+						reqPoolPtr->reqPool[reqSlotTag].reqOpt.blockSpace = REQ_OPT_BLOCK_SPACE_TOTAL;
 
-				reqPoolPtr->reqPool[reqSlotTag].reqType = REQ_TYPE_NAND;
-				reqPoolPtr->reqPool[reqSlotTag].reqCode = REQ_CODE_READ;
-				reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufFormat = REQ_OPT_DATA_BUF_ADDR;
-				reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandAddr = REQ_OPT_NAND_ADDR_PHY_ORG;
-				reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandEcc = REQ_OPT_NAND_ECC_OFF;
-				reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandEccWarning = REQ_OPT_NAND_ECC_WARNING_OFF;
-				reqPoolPtr->reqPool[reqSlotTag].reqOpt.rowAddrDependencyCheck = REQ_OPT_ROW_ADDR_DEPENDENCY_NONE;
-				reqPoolPtr->reqPool[reqSlotTag].reqOpt.blockSpace = REQ_OPT_BLOCK_SPACE_TOTAL;
+						reqPoolPtr->reqPool[reqSlotTag].dataBufInfo.addr = tempReadBufAddr[dieNo] + (2 * scanCnt + markPage) * tempReadBufEntrySize;
 
-				reqPoolPtr->reqPool[reqSlotTag].dataBufInfo.addr = tempReadBufAddr[dieNo];
-
-				reqPoolPtr->reqPool[reqSlotTag].nandInfo.physicalCh = Vdie2PchTranslation(dieNo);
-				reqPoolPtr->reqPool[reqSlotTag].nandInfo.physicalWay = Vdie2PwayTranslation(dieNo);
-				reqPoolPtr->reqPool[reqSlotTag].nandInfo.physicalBlock = phyBlockNo;
-				reqPoolPtr->reqPool[reqSlotTag].nandInfo.physicalPage = BAD_BLOCK_MARK_PAGE0;
+						reqPoolPtr->reqPool[reqSlotTag].nandInfo.physicalCh = Vdie2PchTranslation(dieNo);
+						reqPoolPtr->reqPool[reqSlotTag].nandInfo.physicalWay = Vdie2PwayTranslation(dieNo);
+						reqPoolPtr->reqPool[reqSlotTag].nandInfo.physicalBlock = baseBlockNo + scanCnt;
+						reqPoolPtr->reqPool[reqSlotTag].nandInfo.physicalPage = markPage ? BAD_BLOCK_MARK_PAGE1 : BAD_BLOCK_MARK_PAGE0;
 
-				SelectLowLevelReqQ(reqSlotTag);
-			}
+						SelectLowLevelReqQ(reqSlotTag);
+					}
 
 		SyncAllLowLevelReqDone();
 
 		for(dieNo=0; dieNo < USER_DIES; dieNo++)
 			if(!dieState[dieNo])
-			{
-				markPointer0 = (unsigned char*)(tempReadBufAddr[dieNo] + BAD_BLOCK_MARK_BYTE0);
-				markPointer1 = (unsigned char*)(tempReadBufAddr[dieNo] + BAD_BLOCK_MARK_BYTE1);
-
-				if((*markPointer0 == CLEAN_DATA_IN_BYTE) && (*markPointer1 == CLEAN_DATA_IN_BYTE))
+				for(scanCnt = 0; (scanCnt < BAD_BLOCK_SCAN_DEPTH) && (baseBlockNo + scanCnt < TOTAL_BLOCKS_PER_DIE); scanCnt++)
 				{
-					reqSlotTag = GetFromFreeReqQ();
+					phyBlockNo = baseBlockNo + scanCnt;
+					blockChecker = BLOCK_STATE_NORMAL;
 
-					reqPoolPtr->reqPool[reqSlotTag].reqType = REQ_TYPE_NAND;
-					reqPoolPtr->reqPool[reqSlotTag].reqCode = REQ_CODE_READ;
-					reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufFormat = REQ_OPT_DATA_BUF_ADDR;
-					reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandAddr = REQ_OPT_NAND_ADDR_PHY_ORG;
-					reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandEcc = REQ_OPT_NAND_ECC_OFF;
-					reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandEccWarning = REQ_OPT_NAND_ECC_WARNING_OFF;
-					reqPoolPtr->reqPool[reqSlotTag].reqOpt.rowAddrDependencyCheck = REQ_OPT_ROW_ADDR_DEPENDENCY_NONE;
-					reqPoolPtr->reqPool[reqSlotTag].reqOpt.blockSpace = REQ_OPT_BLOCK_SPACE_TOTAL;
-
-					reqPoolPtr->reqPool[reqSlotTag].dataBufInfo.addr = tempReadBufAddr[dieNo];
-
-					reqPoolPtr->reqPool[reqSlotTag].nandInfo.physicalCh = Vdie2PchTranslation(dieNo);
-					reqPoolPtr->reqPool[reqSlotTag].nandInfo.physicalWay = Vdie2PwayTranslation(dieNo);
-					reqPoolPtr->reqPool[reqSlotTag].nandInfo.physicalBlock = phyBlockNo;
-					reqPoolPtr->reqPool[reqSlotTag].nandInfo.physicalPage = BAD_BLOCK_MARK_PAGE1;
-
-					SelectLowLevelReqQ(reqSlotTag);
-				}
-				else
-				{
-					xil_printf("	bad block is detected: Ch %d Way %d phyBlock %d \r\n",Vdie2PchTranslation(dieNo), Vdie2PwayTranslation(dieNo), phyBlockNo);
-
-					blockChecker[dieNo] = BLOCK_STATE_BAD;
-				}
-			}
-
-		SyncAllLowLevelReqDone();
+					for(markPage = 0; markPage < 2; markPage++)
+					{
+						markPointer0 = (unsigned char*)(tempReadBufAddr[dieNo] + (2 * scanCnt + markPage) * tempReadBufEntrySize + BAD_BLOCK_MARK_BYTE0);
+						markPointer1 = (unsigned char*)(tempReadBufAddr[dieNo] + (2 * scanCnt + markPage) * tempReadBufEntrySize + BAD_BLOCK_MARK_BYTE1);
 
-		for(dieNo=0; dieNo < USER_DIES; dieNo++)
-			if(!dieState[dieNo])
-			{
-				markPointer0 = (unsigned char*)(tempReadBufAddr[dieNo] + BAD_BLOCK_MARK_BYTE0);
-				markPointer1 = (unsigned char*)(tempReadBufAddr[dieNo] + BAD_BLOCK_MARK_BYTE1);
+						if(!((*markPointer0 == CLEAN_DATA_IN_BYTE) && (*markPointer1 == CLEAN_DATA_IN_BYTE)))
+							blockChecker = BLOCK_STATE_BAD;
+					}
 
-				if(!((*markPointer0 == CLEAN_DATA_IN_BYTE) && (*markPointer1 == CLEAN_DATA_IN_BYTE)))
-					if(blockChecker[dieNo] == BLOCK_STATE_NORMAL)
-					{
+					if(blockChecker == BLOCK_STATE_BAD)
 						xil_printf("	bad block is detected: Ch %d Way %d phyBlock %d \r\n",Vdie2PchTranslation(dieNo), Vdie2PwayTranslation(dieNo), phyBlockNo);
 
-						blockChecker[dieNo] = BLOCK_STATE_BAD;
-
-					}
+					bbtUpdater= (unsigned char*)(tempBbtBufAddr[dieNo] + phyBlockNo);
+					*bbtUpdater = blockChecker;
+					phyBlockMapPtr->phyBlock[dieNo][phyBlockNo].bad = blockChecker;
+				}
 
-				bbtUpdater= (unsigned char*)(tempBbtBufAddr[dieNo] + phyBlockNo);
-				*bbtUpdater = blockChecker[dieNo];
-				phyBlockMapPtr->phyBlock[dieNo][phyBlockNo].bad = blockChecker[dieNo];
-			}
+		ReportInitProgress("checked", baseBlockNo + BAD_BLOCK_SCAN_DEPTH, TOTAL_BLOCKS_PER_DIE, &reportedStep);
 	}
 }
 
@@ -483,7 +517,7 @@ void RecoverBadBlockTable(unsigned int tempBufAddr)
 	for(dieNo = 0; dieNo < USER_DIES; dieNo++)
 	{
 		tempBbtBufAddr[dieNo] = tempBbtBufBaseAddr + dieNo * USED_PAGES_FOR_BAD_BLOCK_TABLE_PER_DIE * tempBbtBufEntrySize;
-		tempReadBufAddr[dieNo] = tempReadBufBaseAddr + dieNo * tempReadBufEntrySize;
+		tempReadBufAddr[dieNo] = tempReadBufBaseAddr + dieNo * 2 * BAD_BLOCK_SCAN_DEPTH * tempReadBufEntrySize;
 	}
 
 	//read bad block tables
@@ -533,70 +567,128 @@ void RecoverBadBlockTable(unsigned int tempBufAddr)
 
 
 
-void EraseTotalBlockSpace()
+//every erase of a user block is issued here, so that the wear leveler counts them all
+static void IssueUserBlockErase(unsigned int dieNo, unsigned int blockNo, unsigned int rowAddrDependencyCheck, unsigned int programmedPageCnt)
 {
-	unsigned int blockNo, dieNo, reqSlotTag;
+	unsigned int reqSlotTag;
 
-	xil_printf("Erase total block space...wait for a minute...\r\n");
+	reqSlotTag = GetFromFreeReqQ();
+
+	reqPoolPtr->reqPool[reqSlotTag].reqType = REQ_TYPE_NAND;
+	reqPoolPtr->reqPool[reqSlotTag].reqCode = REQ_CODE_ERASE;
+	reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandAddr = REQ_OPT_NAND_ADDR_VSA;
+	reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufFormat = REQ_OPT_DATA_BUF_NONE;
+	reqPoolPtr->reqPool[reqSlotTag].reqOpt.rowAddrDependencyCheck = rowAddrDependencyCheck;
+	reqPoolPtr->reqPool[reqSlotTag].reqOpt.blockSpace = REQ_OPT_BLOCK_SPACE_MAIN;
+	reqPoolPtr->reqPool[reqSlotTag].nandInfo.virtualSliceAddr = Vorg2VsaTranslation(dieNo, blockNo, 0);
+	reqPoolPtr->reqPool[reqSlotTag].nandInfo.programmedPageCnt = programmedPageCnt;
+
+	SelectLowLevelReqQ(reqSlotTag);
 
-	for(blockNo=0 ; blockNo<TOTAL_BLOCKS_PER_DIE ; blockNo++)
+	virtualBlockMapPtr->block[dieNo][blockNo].eraseCnt++;
+	wearLevelingMapPtr->die[dieNo].erasedBlockCnt++;
+}
+
+//erases are queued die by die up to INIT_ERASE_QUEUE_DEPTH, so that every way is kept busy
+//and a slow die does not take the request pool from the others
+static void EraseBlockSpaceOfAllDies(unsigned int blockCnt, unsigned int blockSpace)
+{
+	unsigned int dieNo, chNo, wayNo, reqSlotTag, remaining, minBlockNo, reportedStep;
+	unsigned int nextBlockNo[USER_DIES];
+
+	for(dieNo=0 ; dieNo<USER_DIES ; dieNo++)
+		nextBlockNo[dieNo] = 0;
+
+	reportedStep = 0;
+	do
+	{
+		remaining = 0;
+		minBlockNo = blockCnt;
 		for(dieNo=0 ; dieNo<USER_DIES ; dieNo++)
 		{
-			reqSlotTag = GetFromFreeReqQ();
+			chNo = Vdie2PchTranslation(dieNo);
+			wayNo = Vdie2PwayTranslation(dieNo);
 
-			reqPoolPtr->reqPool[reqSlotTag].reqType = REQ_TYPE_NAND;
-			reqPoolPtr->reqPool[reqSlotTag].reqCode = REQ_CODE_ERASE;
-			reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandAddr = REQ_OPT_NAND_ADDR_PHY_ORG;
-			reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufFormat = REQ_OPT_DATA_BUF_NONE;
-			reqPoolPtr->reqPool[reqSlotTag].reqOpt.rowAddrDependencyCheck = REQ_OPT_ROW_ADDR_DEPENDENCY_NONE;
-			reqPoolPtr->reqPool[reqSlotTag].reqOpt.blockSpace = REQ_OPT_BLOCK_SPACE_TOTAL;
+			while((nextBlockNo[dieNo] < blockCnt) && (nandReqQ[chNo][wayNo].reqCnt < INIT_ERASE_QUEUE_DEPTH))
+			{
+				if((blockSpace == REQ_OPT_BLOCK_SPACE_MAIN) && virtualBlockMapPtr->block[dieNo][nextBlockNo[dieNo]].bad)
+				{
+					nextBlockNo[dieNo]++;
+					continue;
+				}
 
-			reqPoolPtr->reqPool[reqSlotTag].nandInfo.physicalCh = Vdie2PchTranslation(dieNo);
-			reqPoolPtr->reqPool[reqSlotTag].nandInfo.physicalWay = Vdie2PwayTranslation(dieNo);
-			reqPoolPtr->reqPool[reqSlotTag].nandInfo.physicalBlock = blockNo;
-			reqPoolPtr->reqPool[reqSlotTag].nandInfo.physicalPage = 0;
+				if(blockSpace == REQ_OPT_BLOCK_SPACE_MAIN)
+					IssueUserBlockErase(dieNo, nextBlockNo[dieNo], REQ_OPT_ROW_ADDR_DEPENDENCY_NONE, 0);
+				else
+				{
+					reqSlotTag = GetFromFreeReqQ();
 
-			SelectLowLevelReqQ(reqSlotTag);
+					reqPoolPtr->reqPool[reqSlotTag].reqType = REQ_TYPE_NAND;
+					reqPoolPtr->reqPool[reqSlotTag].reqCode = REQ_CODE_ERASE;
+					reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandAddr = REQ_OPT_NAND_ADDR_PHY_ORG;
+					reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufFormat = REQ_OPT_DATA_BUF_NONE;
+					reqPoolPtr->reqPool[reqSlotTag].reqOpt.rowAddrDependencyCheck = REQ_OPT_ROW_ADDR_DEPENDENCY_NONE;
+					reqPoolPtr->reqPool[reqSlotTag].reqOpt.blockSpace = blockSpace;
+					reqPoolPtr->reqPool[reqSlotTag].nandInfo.physicalCh = chNo;
+					reqPoolPtr->reqPool[reqSlotTag].nandInfo.physicalWay = wayNo;
+					reqPoolPtr->reqPool[reqSlotTag].nandInfo.physicalBlock = nextBlockNo[dieNo];
+					reqPoolPtr->reqPool[reqSlotTag].nandInfo.physicalPage = 0;
+
+					SelectLowLevelReqQ(reqSlotTag);
+				}
+				nextBlockNo[dieNo]++;
+			}
+
+			if(nextBlockNo[dieNo] < blockCnt)
+				remaining = 1;
+			if(nextBlockNo[dieNo] < minBlockNo)
+				minBlockNo = nextBlockNo[dieNo];
 		}
 
+		ReportInitProgress("erased", minBlockNo, blockCnt, &reportedStep);
+
+		if(remaining)
+		{
+			CheckDoneNvmeDmaReq();
+			SchedulingNandReq();
+		}
+	} while(remaining);
 
 	SyncAllLowLevelReqDone();
-	xil_printf("Done.\r\n");
 }
 
-
-void EraseUserBlockSpace()
+void EraseTotalBlockSpace()
 {
-	unsigned int blockNo, dieNo, reqSlotTag;
+	xil_printf("Erase total block space...wait for a minute...\r\n");
 
-	xil_printf("Erase User block space...wait for a minute...\r\n");
+	EraseBlockSpaceOfAllDies(TOTAL_BLOCKS_PER_DIE, REQ_OPT_BLOCK_SPACE_TOTAL);
 
-	for(blockNo=0 ; blockNo<USER_BLOCKS_PER_DIE ; blockNo++)
-		for(dieNo=0 ; dieNo<USER_DIES ; dieNo++)
-			if(!virtualBlockMapPtr->block[dieNo][blockNo].bad)
-			{
-				reqSlotTag = GetFromFreeReqQ();
+	xil_printf("Done.\r\n");
+}
 
-				reqPoolPtr->reqPool[reqSlotTag].reqType = REQ_TYPE_NAND;
-				reqPoolPtr->reqPool[reqSlotTag].reqCode = REQ_CODE_ERASE;
-				reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandAddr = REQ_OPT_NAND_ADDR_VSA;
-				reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufFormat = REQ_OPT_DATA_BUF_NONE;
-				reqPoolPtr->reqPool[reqSlotTag].reqOpt.rowAddrDependencyCheck = REQ_OPT_ROW_ADDR_DEPENDENCY_NONE;
-				reqPoolPtr->reqPool[reqSlotTag].reqOpt.blockSpace = REQ_OPT_BLOCK_SPACE_MAIN;
 
-				reqPoolPtr->reqPool[reqSlotTag].nandInfo.virtualSliceAddr = Vorg2VsaTranslation(dieNo, blockNo, 0);
+//the user blocks are erased when they are taken or while their die is idle, so that a format does not wait for them
+void MarkUserBlockSpaceUnerased()
+{
+	unsigned int dieNo, blockNo;
 
-				SelectLowLevelReqQ(reqSlotTag);
-			}
+	for(dieNo=0 ; dieNo<USER_DIES ; dieNo++)
+	{
+		ResetFreeBlockHeap(dieNo);
+		virtualDieMapPtr->die[dieNo].freeBlockCnt = 0;
 
-	SyncAllLowLevelReqDone();
-	xil_printf("Done.\r\n");
+		for(blockNo=0 ; blockNo<USER_BLOCKS_PER_DIE ; blockNo++)
+			if(!virtualBlockMapPtr->block[dieNo][blockNo].bad)
+				PutToDirtyFbList(dieNo, blockNo);
+	}
+
+	xil_printf("User blocks are erased in the background.\r\n");
 }
 
 
 void InitBlockDieMap()
 {
-	unsigned int dieNo;
+	unsigned int dieNo, slotNo;
 	unsigned char eraseFlag = 1;
 
 	xil_printf("Press 'X' to re-make the bad block table.\r\n");
@@ -611,18 +703,30 @@ void InitBlockDieMap()
 	//make bad block table
 	RecoverBadBlockTable(RESERVED_DATA_BUFFER_BASE_ADDR);
 
-	//to prevent accessing bbtBlock by host
+	SelectCheckpointSlotBlocks();
+
+	//to prevent accessing bbtBlock and checkpoint slot blocks by host
 	for(dieNo=0 ; dieNo<USER_DIES ; dieNo++)
+	{
 		phyBlockMapPtr->phyBlock[dieNo][bbtInfoMapPtr->bbtInfo[dieNo].phyBlock].bad = 1;
+		for(slotNo=0 ; slotNo<CHECKPOINT_SLOT_COUNT ; slotNo++)
+			phyBlockMapPtr->phyBlock[dieNo][checkpointMapPtr->die[dieNo].slotBlock[slotNo]].bad = 1;
+	}
 
 	RemapBadBlock();
 
 	InitBlockMap();
 
 	if(eraseFlag)
-		EraseUserBlockSpace();
+		if(RecoverCheckpoint())
+			eraseFlag = 0;
+
+	if(eraseFlag)
+		MarkUserBlockSpaceUnerased();
 
 	InitCurrentBlockOfDieMap();
+
+	SaveCheckpoint();
 }
 
 unsigned int AddrTransRead(unsigned int logicalSliceAddr)
@@ -644,13 +748,19 @@ unsigned int AddrTransRead(unsigned int logicalSliceAddr)
 
 unsigned int AddrTransWrite(unsigned int logicalSliceAddr)
 {
-	unsigned int virtualSliceAddr;
+	unsigned int virtualSliceAddr, temperature;
 
 	if(logicalSliceAddr < SLICES_PER_SSD)
 	{
 		InvalidateOldVsa(logicalSliceAddr);
 
-		virtualSliceAddr = FindFreeVirtualSlice();
+		//data being written is a step hotter than data GC relocates from the same slice group
+		temperature = GetSliceTemperature(logicalSliceAddr);
+		if(temperature < LSA_TEMPERATURE_MAX)
+			temperature++;
+
+		virtualSliceAddr = FindFreeVirtualSlice(Temperature2WriteStream(temperature));
+		EarnGcCopyTokens(Vsa2VdieTranslation(virtualSliceAddr));
 
 		logicalSliceMapPtr->logicalSlice[logicalSliceAddr].virtualSliceAddr = virtualSliceAddr;
 		virtualSliceMapPtr->virtualSlice[virtualSliceAddr].logicalSliceAddr = logicalSliceAddr;
@@ -661,32 +771,58 @@ unsigned int AddrTransWrite(unsigned int logicalSliceAddr)
 		assert(!"[WARNING] Logical address is larger than maximum logical address served by SSD [WARNING]");
 }
 
+//deallocate a logical slice, a dirty buffer of it is dropped instead of being written back
+void AddrTransTrim(unsigned int logicalSliceAddr)
+{
+	if(logicalSliceAddr < SLICES_PER_SSD)
+	{
+		DropDataBuf(logicalSliceAddr);
+		InvalidateOldVsa(logicalSliceAddr);
+	}
+	else
+		assert(!"[WARNING] Logical address is larger than maximum logical address served by SSD [WARNING]");
+}
 
-unsigned int FindFreeVirtualSlice()
+
+unsigned int FindFreeVirtualSlice(unsigned int writeStream)
 {
 	unsigned int currentBlock, virtualSliceAddr, dieNo;
+#if SUPPORT_MULTI_PLANE
+	unsigned int planeBlock;
+#endif
 
 	dieNo = sliceAllocationTargetDie;
-	currentBlock = virtualDieMapPtr->die[dieNo].currentBlock;
+	currentBlock = virtualDieMapPtr->die[dieNo].currentBlock[writeStream];
+
+#if SUPPORT_MULTI_PLANE
+	//the open block of the other plane takes the slice when it is behind, so that both blocks advance in pairs of
+	//programs to the same page, the behind one is always taken first and is full only when both are
+	planeBlock = virtualDieMapPtr->die[dieNo].planeBlock[writeStream];
+	if((planeBlock != BLOCK_NONE) && (virtualBlockMapPtr->block[dieNo][planeBlock].currentPage < virtualBlockMapPtr->block[dieNo][currentBlock].currentPage))
+	{
+		virtualDieMapPtr->die[dieNo].planeBlock[writeStream] = currentBlock;
+		virtualDieMapPtr->die[dieNo].currentBlock[writeStream] = planeBlock;
+		currentBlock = planeBlock;
+	}
+#endif
 
 	if(virtualBlockMapPtr->block[dieNo][currentBlock].currentPage == USER_PAGES_PER_BLOCK)
 	{
 		currentBlock = GetFromFbList(dieNo, GET_FREE_BLOCK_NORMAL);
 
 		if(currentBlock != BLOCK_FAIL)
-			virtualDieMapPtr->die[dieNo].currentBlock = currentBlock;
+			virtualDieMapPtr->die[dieNo].currentBlock[writeStream] = currentBlock;
 		else
 		{
+			//every die is short of free blocks, the host slice waits for a victim of this die
 			GarbageCollection(dieNo);
-			//TriggerGc(dieNo);
-			//xil_printf("[IGC] Triggered GC for Die %d\r\n", dieNo);
-			currentBlock = virtualDieMapPtr->die[dieNo].currentBlock;
+			currentBlock = virtualDieMapPtr->die[dieNo].currentBlock[writeStream];
 
 			if(virtualBlockMapPtr->block[dieNo][currentBlock].currentPage == USER_PAGES_PER_BLOCK)
 			{
 				currentBlock = GetFromFbList(dieNo, GET_FREE_BLOCK_NORMAL);
 				if(currentBlock != BLOCK_FAIL)
-					virtualDieMapPtr->die[dieNo].currentBlock = currentBlock;
+					virtualDieMapPtr->die[dieNo].currentBlock[writeStream] = currentBlock;
 				else
 					assert(!"[WARNING] There is no available block [WARNING]");
 			}
@@ -697,27 +833,41 @@ unsigned int FindFreeVirtualSlice()
 	else if(virtualBlockMapPtr->block[dieNo][currentBlock].currentPage > USER_PAGES_PER_BLOCK)
 		assert(!"[WARNING] Current page management fail [WARNING]");
 
+#if SUPPORT_MULTI_PLANE
+	//a new block in the current plane starts a new pair, the other plane opens a new block as well once its block is full
+	planeBlock = virtualDieMapPtr->die[dieNo].planeBlock[writeStream];
+	if((virtualBlockMapPtr->block[dieNo][currentBlock].currentPage == 0) && ((planeBlock == BLOCK_NONE) || (virtualBlockMapPtr->block[dieNo][planeBlock].currentPage == USER_PAGES_PER_BLOCK)))
+		virtualDieMapPtr->die[dieNo].planeBlock[writeStream] = GetFromFbListOfPlane(dieNo, Vblock2PplaneTranslation(dieNo, currentBlock) ^ 1);
+#endif
 
 	virtualSliceAddr = Vorg2VsaTranslation(dieNo, currentBlock, virtualBlockMapPtr->block[dieNo][currentBlock].currentPage);
 	virtualBlockMapPtr->block[dieNo][currentBlock].currentPage++;
+#if SUPPORT_MULTI_PLANE
+	//the other slice of the pair goes to the same die before the next die is chosen
+	planeBlock = virtualDieMapPtr->die[dieNo].planeBlock[writeStream];
+	if((planeBlock != BLOCK_NONE) && (virtualBlockMapPtr->block[dieNo][planeBlock].currentPage + 1 == virtualBlockMapPtr->block[dieNo][currentBlock].currentPage))
+		return virtualSliceAddr;
+#endif
 	sliceAllocationTargetDie = FindDieForFreeSliceAllocation();
 	dieNo = sliceAllocationTargetDie;
 	return virtualSliceAddr;
 }
 
 
-unsigned int FindFreeVirtualSliceForGc(unsigned int copyTargetDieNo, unsigned int victimBlockNo)
+unsigned int FindFreeVirtualSliceForGc(unsigned int copyTargetDieNo, unsigned int victimBlockNo, unsigned int writeStream)
 {
 	unsigned int currentBlock, virtualSliceAddr, dieNo;
 
 	dieNo = copyTargetDieNo;
-	if(victimBlockNo == virtualDieMapPtr->die[dieNo].currentBlock)
+	if(victimBlockNo == virtualDieMapPtr->die[dieNo].planeBlock[writeStream])
+		virtualDieMapPtr->die[dieNo].planeBlock[writeStream] = BLOCK_NONE;
+	if(victimBlockNo == virtualDieMapPtr->die[dieNo].currentBlock[writeStream])
 	{
-		virtualDieMapPtr->die[dieNo].currentBlock = GetFromFbList(dieNo, GET_FREE_BLOCK_GC);
-		if(virtualDieMapPtr->die[dieNo].currentBlock == BLOCK_FAIL)
+		virtualDieMapPtr->die[dieNo].currentBlock[writeStream] = GetFromFbList(dieNo, GET_FREE_BLOCK_GC);
+		if(virtualDieMapPtr->die[dieNo].currentBlock[writeStream] == BLOCK_FAIL)
 			assert(!"[WARNING] There is no available block [WARNING]");
 	}
-	currentBlock = virtualDieMapPtr->die[dieNo].currentBlock;
+	currentBlock = virtualDieMapPtr->die[dieNo].currentBlock[writeStream];
 
 	if(virtualBlockMapPtr->block[dieNo][currentBlock].currentPage == USER_PAGES_PER_BLOCK)
 	{
@@ -725,7 +875,7 @@ unsigned int FindFreeVirtualSliceForGc(unsigned int copyTargetDieNo, unsigned in
 		currentBlock = GetFromFbList(dieNo, GET_FREE_BLOCK_GC);
 
 		if(currentBlock != BLOCK_FAIL)
-			virtualDieMapPtr->die[dieNo].currentBlock = currentBlock;
+			virtualDieMapPtr->die[dieNo].currentBlock[writeStream] = currentBlock;
 		else
 			assert(!"[WARNING] There is no available block [WARNING]");
 	}
@@ -738,24 +888,43 @@ unsigned int FindFreeVirtualSliceForGc(unsigned int copyTargetDieNo, unsigned in
 	return virtualSliceAddr;
 }
 
+//GC relocations see the slice group at half its temperature, so that data which stopped being rewritten drifts to colder streams
+unsigned int CoolDownLogicalSlice(unsigned int logicalSliceAddr)
+{
+	return Temperature2WriteStream(GetSliceTemperature(logicalSliceAddr) >> 1);
+}
 
+
+//dies take host slices in turn, a die down to HOST_FREE_BLOCK_FLOOR is skipped and left to background GC
+//so that a host write waits for a GC cycle only when every die is short
 unsigned int FindDieForFreeSliceAllocation()
 {
 	static unsigned char targetCh = 0;
 	static unsigned char targetWay = 0;
-	unsigned int targetDie;
-
-	targetDie = Pcw2VdieTranslation(targetCh, targetWay);
+	unsigned int targetDie, firstDie, dieCnt;
 
-	if(targetCh != (USER_CHANNELS - 1))
-		targetCh = targetCh + 1;
-	else
+	firstDie = DIE_NONE;
+	for(dieCnt = 0; dieCnt < USER_DIES; dieCnt++)
 	{
-		targetCh = 0;
-		targetWay = (targetWay + 1) % USER_WAYS;
+		targetDie = Pcw2VdieTranslation(targetCh, targetWay);
+
+		if(targetCh != (USER_CHANNELS - 1))
+			targetCh = targetCh + 1;
+		else
+		{
+			targetCh = 0;
+			targetWay = (targetWay + 1) % USER_WAYS;
+		}
+
+		if(virtualDieMapPtr->die[targetDie].freeBlockCnt > HOST_FREE_BLOCK_FLOOR)
+			return targetDie;
+
+		if(firstDie == DIE_NONE)
+			firstDie = targetDie;
+		TriggerGc(targetDie);
 	}
 
-	return targetDie;
+	return firstDie;
 }
 
 void InvalidateOldVsa(unsigned int logicalSliceAddr)
@@ -785,24 +954,12 @@ void InvalidateOldVsa(unsigned int logicalSliceAddr)
 
 void EraseBlock(unsigned int dieNo, unsigned int blockNo)
 {
-	unsigned int pageNo, virtualSliceAddr, reqSlotTag;
-
-	reqSlotTag = GetFromFreeReqQ();
-
-	reqPoolPtr->reqPool[reqSlotTag].reqType = REQ_TYPE_NAND;
-	reqPoolPtr->reqPool[reqSlotTag].reqCode = REQ_CODE_ERASE;
-	reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandAddr = REQ_OPT_NAND_ADDR_VSA;
-	reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufFormat = REQ_OPT_DATA_BUF_NONE;
-	reqPoolPtr->reqPool[reqSlotTag].reqOpt.rowAddrDependencyCheck = REQ_OPT_ROW_ADDR_DEPENDENCY_CHECK;
-	reqPoolPtr->reqPool[reqSlotTag].reqOpt.blockSpace = REQ_OPT_BLOCK_SPACE_MAIN;
-	reqPoolPtr->reqPool[reqSlotTag].nandInfo.virtualSliceAddr = Vorg2VsaTranslation(dieNo, blockNo, 0);
-	reqPoolPtr->reqPool[reqSlotTag].nandInfo.programmedPageCnt = virtualBlockMapPtr->block[dieNo][blockNo].currentPage;
+	unsigned int pageNo, virtualSliceAddr;
 
-	SelectLowLevelReqQ(reqSlotTag);
+	IssueUserBlockErase(dieNo, blockNo, REQ_OPT_ROW_ADDR_DEPENDENCY_CHECK, virtualBlockMapPtr->block[dieNo][blockNo].currentPage);
 
 	// block map indicated blockNo initialization
 	virtualBlockMapPtr->block[dieNo][blockNo].free = 1;
-	virtualBlockMapPtr->block[dieNo][blockNo].eraseCnt++;
 	virtualBlockMapPtr->block[dieNo][blockNo].invalidSliceCnt = 0;
 	virtualBlockMapPtr->block[dieNo][blockNo].currentPage = 0;
 
@@ -815,32 +972,84 @@ void EraseBlock(unsigned int dieNo, unsigned int blockNo)
 	}
 }
 
+//erased free blocks wait in the free block heap of their plane
 void PutToFbList(unsigned int dieNo, unsigned int blockNo) //fb means free block
 {
-	if(virtualDieMapPtr->die[dieNo].tailFreeBlock != BLOCK_NONE)
+	virtualBlockMapPtr->block[dieNo][blockNo].prevBlock = BLOCK_NONE;
+	virtualBlockMapPtr->block[dieNo][blockNo].nextBlock = BLOCK_NONE;
+	PushFreeBlockHeap(dieNo, blockNo);
+
+	virtualDieMapPtr->die[dieNo].freeBlockCnt++;
+}
+
+void PutToDirtyFbList(unsigned int dieNo, unsigned int blockNo)
+{
+	if(virtualDieMapPtr->die[dieNo].tailDirtyFreeBlock != BLOCK_NONE)
 	{
-		virtualBlockMapPtr->block[dieNo][blockNo].prevBlock = virtualDieMapPtr->die[dieNo].tailFreeBlock;
+		virtualBlockMapPtr->block[dieNo][blockNo].prevBlock = virtualDieMapPtr->die[dieNo].tailDirtyFreeBlock;
 		virtualBlockMapPtr->block[dieNo][blockNo].nextBlock = BLOCK_NONE;
-		virtualBlockMapPtr->block[dieNo][virtualDieMapPtr->die[dieNo].tailFreeBlock].nextBlock = blockNo;
-		virtualDieMapPtr->die[dieNo].tailFreeBlock = blockNo;
+		virtualBlockMapPtr->block[dieNo][virtualDieMapPtr->die[dieNo].tailDirtyFreeBlock].nextBlock = blockNo;
+		virtualDieMapPtr->die[dieNo].tailDirtyFreeBlock = blockNo;
 	}
 	else
 	{
 		virtualBlockMapPtr->block[dieNo][blockNo].prevBlock = BLOCK_NONE;
 		virtualBlockMapPtr->block[dieNo][blockNo].nextBlock = BLOCK_NONE;
-		virtualDieMapPtr->die[dieNo].headFreeBlock = blockNo;
-		virtualDieMapPtr->die[dieNo].tailFreeBlock = blockNo;
+		virtualDieMapPtr->die[dieNo].headDirtyFreeBlock = blockNo;
+		virtualDieMapPtr->die[dieNo].tailDirtyFreeBlock = blockNo;
 	}
 
+	virtualBlockMapPtr->block[dieNo][blockNo].unerased = 1;
+	virtualDieMapPtr->die[dieNo].dirtyFreeBlockCnt++;
 	virtualDieMapPtr->die[dieNo].freeBlockCnt++;
 }
 
+static void SelectiveGetFromDirtyFbList(unsigned int dieNo, unsigned int blockNo)
+{
+	unsigned int prevBlock, nextBlock;
+
+	prevBlock = virtualBlockMapPtr->block[dieNo][blockNo].prevBlock;
+	nextBlock = virtualBlockMapPtr->block[dieNo][blockNo].nextBlock;
+	if(prevBlock != BLOCK_NONE)
+		virtualBlockMapPtr->block[dieNo][prevBlock].nextBlock = nextBlock;
+	else
+		virtualDieMapPtr->die[dieNo].headDirtyFreeBlock = nextBlock;
+	if(nextBlock != BLOCK_NONE)
+		virtualBlockMapPtr->block[dieNo][nextBlock].prevBlock = prevBlock;
+	else
+		virtualDieMapPtr->die[dieNo].tailDirtyFreeBlock = prevBlock;
+
+	virtualDieMapPtr->die[dieNo].dirtyFreeBlockCnt--;
+	virtualDieMapPtr->die[dieNo].freeBlockCnt--;
+
+	virtualBlockMapPtr->block[dieNo][blockNo].nextBlock = BLOCK_NONE;
+	virtualBlockMapPtr->block[dieNo][blockNo].prevBlock = BLOCK_NONE;
+}
+
+//programs of the block are queued behind the erase, so the block can be taken before the erase is done
+static void EraseDirtyFreeBlock(unsigned int dieNo, unsigned int blockNo)
+{
+	IssueUserBlockErase(dieNo, blockNo, REQ_OPT_ROW_ADDR_DEPENDENCY_CHECK, 0);
+
+	virtualBlockMapPtr->block[dieNo][blockNo].unerased = 0;
+}
+
+//a die without an erased free block takes an unerased one
+static unsigned int GetFromDirtyFbList(unsigned int dieNo, unsigned int blockNo)
+{
+	SelectiveGetFromDirtyFbList(dieNo, blockNo);
+	EraseDirtyFreeBlock(dieNo, blockNo);
+
+	virtualBlockMapPtr->block[dieNo][blockNo].free = 0;
+	checkpointMapPtr->die[dieNo].openedBlockCnt++;
+
+	return blockNo;
+}
+
 unsigned int GetFromFbList(unsigned int dieNo, unsigned int getFreeBlockOption) //fb means free block
 {
 	unsigned int evictedBlockNo;
 
-	evictedBlockNo = virtualDieMapPtr->die[dieNo].headFreeBlock;
-
 	if(getFreeBlockOption == GET_FREE_BLOCK_NORMAL)
 	{
 		if(virtualDieMapPtr->die[dieNo].freeBlockCnt <= RESERVED_FREE_BLOCK_COUNT)
@@ -848,32 +1057,78 @@ unsigned int GetFromFbList(unsigned int dieNo, unsigned int getFreeBlockOption)
 	}
 	else if(getFreeBlockOption == GET_FREE_BLOCK_GC)
 	{
-		if(evictedBlockNo == BLOCK_NONE)
+		if(virtualDieMapPtr->die[dieNo].freeBlockCnt == 0)
 			return BLOCK_FAIL;
 	}
 	else
 		assert(!"[WARNING] Wrong getFreeBlockOption [WARNING]");
 
-	if(virtualBlockMapPtr->block[dieNo][evictedBlockNo].nextBlock != BLOCK_NONE)
-	{
-		virtualDieMapPtr->die[dieNo].headFreeBlock = virtualBlockMapPtr->block[dieNo][evictedBlockNo].nextBlock;
-		virtualBlockMapPtr->block[dieNo][virtualBlockMapPtr->block[dieNo][evictedBlockNo].nextBlock].prevBlock = BLOCK_NONE;
-	}
-	else
+	evictedBlockNo = PopLeastWornFreeBlock(dieNo);
+	if(evictedBlockNo == BLOCK_NONE)
+		return GetFromDirtyFbList(dieNo, virtualDieMapPtr->die[dieNo].headDirtyFreeBlock);
+
+	virtualBlockMapPtr->block[dieNo][evictedBlockNo].free = 0;
+	virtualDieMapPtr->die[dieNo].freeBlockCnt--;
+	checkpointMapPtr->die[dieNo].openedBlockCnt++;
+
+	return evictedBlockNo;
+}
+
+
+//a free block of the given plane, taken with the reserve of GET_FREE_BLOCK_NORMAL, BLOCK_NONE when there is none
+unsigned int GetFromFbListOfPlane(unsigned int dieNo, unsigned int planeNo)
+{
+	unsigned int blockNo;
+
+	if(virtualDieMapPtr->die[dieNo].freeBlockCnt <= RESERVED_FREE_BLOCK_COUNT)
+		return BLOCK_NONE;
+
+	blockNo = PopFreeBlockHeap(dieNo, planeNo);
+	if(blockNo == BLOCK_NONE)
 	{
-		virtualDieMapPtr->die[dieNo].headFreeBlock = BLOCK_NONE;
-		virtualDieMapPtr->die[dieNo].tailFreeBlock = BLOCK_NONE;
+		blockNo = virtualDieMapPtr->die[dieNo].headDirtyFreeBlock;
+		while((blockNo != BLOCK_NONE) && (Vblock2PplaneTranslation(dieNo, blockNo) != planeNo))
+			blockNo = virtualBlockMapPtr->block[dieNo][blockNo].nextBlock;
+
+		if(blockNo == BLOCK_NONE)
+			return BLOCK_NONE;
+
+		return GetFromDirtyFbList(dieNo, blockNo);
 	}
 
-	virtualBlockMapPtr->block[dieNo][evictedBlockNo].free = 0;
+	virtualBlockMapPtr->block[dieNo][blockNo].free = 0;
 	virtualDieMapPtr->die[dieNo].freeBlockCnt--;
+	checkpointMapPtr->die[dieNo].openedBlockCnt++;
 
-	virtualBlockMapPtr->block[dieNo][evictedBlockNo].nextBlock = BLOCK_NONE;
-	virtualBlockMapPtr->block[dieNo][evictedBlockNo].prevBlock = BLOCK_NONE;
+	return blockNo;
+}
 
-	return evictedBlockNo;
+//plane of the physical block a virtual block is remapped to
+unsigned int Vblock2PplaneTranslation(unsigned int dieNo, unsigned int blockNo)
+{
+	return Pblock2PplaneTranslation(phyBlockMapPtr->phyBlock[dieNo][Vblock2PblockOfTbsTranslation(blockNo)].remappedPhyBlock);
 }
 
+//called from the idle loop, unerased free blocks of a lightly loaded die are erased and join the free block list
+void LazyEraseScheduler()
+{
+	unsigned int dieNo, chNo, wayNo, blockNo;
+
+	for(dieNo=0 ; dieNo<USER_DIES ; dieNo++)
+	{
+		chNo = Vdie2PchTranslation(dieNo);
+		wayNo = Vdie2PwayTranslation(dieNo);
+
+		while((virtualDieMapPtr->die[dieNo].headDirtyFreeBlock != BLOCK_NONE) &&
+				(nandReqQ[chNo][wayNo].reqCnt < LAZY_ERASE_QUEUE_DEPTH) && (freeReqQ.headReq != REQ_SLOT_TAG_NONE))
+		{
+			blockNo = virtualDieMapPtr->die[dieNo].headDirtyFreeBlock;
+			SelectiveGetFromDirtyFbList(dieNo, blockNo);
+			EraseDirtyFreeBlock(dieNo, blockNo);
+			PutToFbList(dieNo, blockNo);
+		}
+	}
+}
 
 void UpdatePhyBlockMapForGrownBadBlock(unsigned int dieNo, unsigned int phyBlockNo)
 {
@@ -905,7 +1160,7 @@ void UpdateBadBlockTableForGrownBadBlock(unsigned int tempBufAddr)
 			{
 				bbtUpdater = (unsigned char*)(tempBbtBufAddr[dieNo] + phyBlockNo);
 
-				if(phyBlockNo != bbtInfoMapPtr->bbtInfo[dieNo].phyBlock)
+				if((phyBlockNo != bbtInfoMapPtr->bbtInfo[dieNo].phyBlock) && !IsCheckpointSlotBlock(dieNo, phyBlockNo))
 					*bbtUpdater = phyBlockMapPtr->phyBlock[dieNo][phyBlockNo].bad;
 				else
 					*bbtUpdater = BLOCK_STATE_NORMAL;
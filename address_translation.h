@@ -30,7 +30,7 @@
 // Module Name: Address Translator
 // File Name: address translation.h
 //
-// Version: v1.0.0
+// Version: v1.7.0
 //
 // Description:
 //   - define parameters, data structure and functions of address translator
@@ -39,6 +39,28 @@
 //////////////////////////////////////////////////////////////////////////////////
 // Revision History:
 //
+// * v1.7.0
+//   - per-slice temperature map is replaced by the write temperature tracker
+//
+// * v1.6.0
+//   - erased free blocks are kept by the wear leveler instead of a list of the die
+//
+// * v1.5.0
+//   - free blocks left unerased by a format wait on a dirty free block list of their die
+//
+// * v1.4.0
+//   - queue depths of the bad block scan and format erases, progress report steps of both
+//
+// * v1.3.0
+//   - HOST_FREE_BLOCK_FLOOR of free blocks per die is kept for GC
+//
+// * v1.2.0
+//   - a write stream keeps an open block in the other plane (planeBlock) for multi-plane programs
+//
+// * v1.1.0
+//   - one current block per write stream, streams are chosen by LSA temperature
+//   - logical slices can be deallocated (AddrTransTrim)
+//
 // * v1.0.0
 //   - First draft
 //////////////////////////////////////////////////////////////////////////////////
@@ -65,10 +87,15 @@
 #define DIE_FAIL	0xff
 
 #define RESERVED_FREE_BLOCK_COUNT	0x1
+#define HOST_FREE_BLOCK_FLOOR		(RESERVED_FREE_BLOCK_COUNT + 2 * WRITE_STREAM_COUNT)	//free blocks below which host slices go to other dies
 
 #define GET_FREE_BLOCK_NORMAL	0x0
 #define GET_FREE_BLOCK_GC		0x1
 
+#define WRITE_STREAM_COUNT			2		//write frontiers per die, stream 0 takes the hottest data
+#define LSA_TEMPERATURE_PER_STREAM	2		//temperature steps between neighbouring streams
+#define LSA_TEMPERATURE_MAX			(WRITE_STREAM_COUNT * LSA_TEMPERATURE_PER_STREAM - 1)
+
 #define BLOCK_STATE_NORMAL						0
 #define BLOCK_STATE_BAD							1
 
@@ -86,6 +113,11 @@
 #define DATA_SIZE_OF_BAD_BLOCK_TABLE_PER_DIE	(TOTAL_BLOCKS_PER_DIE)
 #define START_PAGE_NO_OF_BAD_BLOCK_TABLE_BLOCK	(1)		//bad block table begins at second page for preserving a bad block mark of the block allocated to save bad block table
 
+#define BAD_BLOCK_SCAN_DEPTH					8		//blocks of a die whose bad block marks are read per round
+#define INIT_ERASE_QUEUE_DEPTH					8		//queued erases of a die while formatting
+#define INIT_PROGRESS_STEPS						10
+#define LAZY_ERASE_QUEUE_DEPTH					1		//queued NAND requests of a die below which an unerased free block is erased
+
 #define BBT_INFO_GROWN_BAD_UPDATE_NONE			0
 #define BBT_INFO_GROWN_BAD_UPDATE_BOOKED		1
 
@@ -101,9 +133,13 @@
 #define Vdie2PchTranslation(dieNo) ((dieNo) % (USER_CHANNELS))
 #define Vdie2PwayTranslation(dieNo) ((dieNo) / (USER_CHANNELS))
 #define Vblock2PblockOfTbsTranslation(blockNo) (((blockNo) / (USER_BLOCKS_PER_LUN)) * (TOTAL_BLOCKS_PER_LUN) + ((blockNo) % (USER_BLOCKS_PER_LUN))) //Tbs = Total block space
+#define Pblock2PplaneTranslation(blockNo) ((blockNo) % (PLANES_PER_DIE))
 #define Vblock2PblockOfMbsTranslation(blockNo) (((blockNo) / (USER_BLOCKS_PER_LUN)) * (MAIN_BLOCKS_PER_LUN) + ((blockNo) % (USER_BLOCKS_PER_LUN))) //Mbs = Main block space
 #define Vpage2PlsbPageTranslation(pageNo) ((pageNo) > (0) ? (2 * (pageNo) - 1): (0))
 
+// LSA temperature to write stream, colder slices go to higher streams
+#define Temperature2WriteStream(temperature) ((WRITE_STREAM_COUNT - 1) - (temperature) / (LSA_TEMPERATURE_PER_STREAM))
+
 // physical to virtual translation
 #define Pcw2VdieTranslation(chNo, wayNo) ((chNo) + (wayNo) * (USER_CHANNELS))
 #define PlsbPage2VpageTranslation(pageNo) ((pageNo) > (0) ? ( ((pageNo) + 1) / 2): (0))
@@ -131,7 +167,8 @@ typedef struct _VIRTUAL_BLOCK_ENTRY {
 	unsigned int bad : 1;
 	unsigned int free : 1;
 	unsigned int invalidSliceCnt : 16;
-	unsigned int reserved0 :10;
+	unsigned int unerased : 1;	//free block on the dirty free block list
+	unsigned int reserved0 :9;
 	unsigned int currentPage : 16;
 	unsigned int eraseCnt : 16;
 	unsigned int prevBlock : 16;
@@ -144,12 +181,14 @@ typedef struct _VIRTUAL_BLOCK_MAP {
 
 
 typedef struct _VIRTUAL_DIE_ENTRY {
-	unsigned int currentBlock : 16;
-	unsigned int headFreeBlock : 16;
-	unsigned int tailFreeBlock : 16;
+	unsigned short currentBlock[WRITE_STREAM_COUNT];
+	unsigned short planeBlock[WRITE_STREAM_COUNT];	//open block of the other plane, BLOCK_NONE without multi-plane
 	unsigned int freeBlockCnt : 16;
 	unsigned int prevDie : 8;
 	unsigned int nextDie : 8;
+	unsigned int dirtyFreeBlockCnt : 16;	//included in freeBlockCnt
+	unsigned int headDirtyFreeBlock : 16;
+	unsigned int tailDirtyFreeBlock : 16;
 	unsigned int reserved0 : 16;
 } VIRTUAL_DIE_ENTRY, *P_VIRTUAL_DIE_ENTRY;
 
@@ -190,15 +229,21 @@ void InitBlockDieMap();
 
 unsigned int AddrTransRead(unsigned int logicalSliceAddr);
 unsigned int AddrTransWrite(unsigned int logicalSliceAddr);
-unsigned int FindFreeVirtualSlice();
-unsigned int FindFreeVirtualSliceForGc(unsigned int copyTargetDieNo, unsigned int victimBlockNo);
+void AddrTransTrim(unsigned int logicalSliceAddr);
+unsigned int FindFreeVirtualSlice(unsigned int writeStream);
+unsigned int FindFreeVirtualSliceForGc(unsigned int copyTargetDieNo, unsigned int victimBlockNo, unsigned int writeStream);
+unsigned int CoolDownLogicalSlice(unsigned int logicalSliceAddr);
 unsigned int FindDieForFreeSliceAllocation();
 
 void InvalidateOldVsa(unsigned int logicalSliceAddr);
 void EraseBlock(unsigned int dieNo, unsigned int blockNo);
 
 void PutToFbList(unsigned int dieNo, unsigned int blockNo);
+void PutToDirtyFbList(unsigned int dieNo, unsigned int blockNo);
 unsigned int GetFromFbList(unsigned int dieNo, unsigned int getFreeBlockOption);
+unsigned int GetFromFbListOfPlane(unsigned int dieNo, unsigned int planeNo);
+unsigned int Vblock2PplaneTranslation(unsigned int dieNo, unsigned int blockNo);
+void LazyEraseScheduler();
 
 void UpdatePhyBlockMapForGrownBadBlock(unsigned int dieNo, unsigned int phyBlockNo);
 void UpdateBadBlockTableForGrownBadBlock(unsigned int tempBufAddr);
@@ -0,0 +1,738 @@
+//////////////////////////////////////////////////////////////////////////////////
+// checkpoint.c for Cosmos+ OpenSSD
+//
+// This file is part of Cosmos+ OpenSSD.
+//
+// Cosmos+ OpenSSD is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3, or (at your option)
+// any later version.
+//
+// Cosmos+ OpenSSD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Cosmos+ OpenSSD; see the file COPYING.
+// If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Project Name: Cosmos+ OpenSSD
+// Design Name: Cosmos+ Firmware
+// Module Name: Map Checkpoint
+// File Name: checkpoint.c
+//
+// Version: v1.3.2
+//
+// Description:
+//   - save the block map and the logical slice map of each die to its checkpoint slot blocks
+//   - tag every programmed slice with its logical slice and write sequence in the spare region
+//   - restore the maps at power-on from the newest complete checkpoint and the tags of the slices
+//     programmed after it
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Revision History:
+//
+// * v1.3.2
+//   - checkpoint mappings into blocks opened after the checkpoint are dropped before the roll-forward
+//   - a virtual slice mapped by two logical slices after recovery is reported
+//
+// * v1.3.1
+//   - a block that was open at the checkpoint and already full is not scanned
+//
+// * v1.3.0
+//   - a snapshot is taken without draining the NAND requests, its header waits for the programs and erases issued before it
+//
+// * v1.2.0
+//   - slot blocks are the first good blocks of the bad block table instead of fixed blocks
+//
+// * v1.1.1
+//   - erased free blocks are put back into the free block heaps of the wear leveler
+//
+// * v1.1.0
+//   - blocks left unerased by a format are told from blocks programmed after it by the format sequence of their tags
+//
+// * v1.0.0
+//   - First draft
+//////////////////////////////////////////////////////////////////////////////////
+
+
+#include "xil_printf.h"
+#include <assert.h>
+#include "memory_map.h"
+
+P_CHECKPOINT_MAP checkpointMapPtr;
+
+//blocks programmed after the checkpoint, scanned at power-on from their start page
+static unsigned short scanBlock[USER_DIES][USER_BLOCKS_PER_DIE];
+static unsigned short scanStartPage[USER_DIES][USER_BLOCKS_PER_DIE];
+static unsigned int scanBlockCnt[USER_DIES];
+
+void InitCheckpoint()
+{
+	unsigned int dieNo;
+
+	checkpointMapPtr = (P_CHECKPOINT_MAP) CHECKPOINT_MAP_ADDR;
+
+	for(dieNo = 0; dieNo < USER_DIES; dieNo++)
+	{
+		checkpointMapPtr->die[dieNo].openedBlockCnt = 0;
+		checkpointMapPtr->die[dieNo].nextPage = CHECKPOINT_PAGES_PER_DIE;
+	}
+
+	checkpointMapPtr->checkpointSeq = CHECKPOINT_SEQ_NONE;
+	checkpointMapPtr->sliceWriteSeq = 1;
+	checkpointMapPtr->formatSeq = 1;
+	checkpointMapPtr->writing = 0;
+	checkpointMapPtr->fenceGen = 0;
+	checkpointMapPtr->fencedReqCnt[0] = 0;
+	checkpointMapPtr->fencedReqCnt[1] = 0;
+	checkpointMapPtr->pageReqCnt = 0;
+}
+
+//the slot blocks are the first blocks of the die the bad block table marks good, after the bad block table block,
+//the table is never updated for them, so that they are found again at the next power-on
+void SelectCheckpointSlotBlocks()
+{
+	unsigned int dieNo, phyBlockNo, slotNo;
+
+	for(dieNo = 0; dieNo < USER_DIES; dieNo++)
+	{
+		slotNo = 0;
+		for(phyBlockNo = 0; (phyBlockNo < TOTAL_BLOCKS_PER_DIE) && (slotNo < CHECKPOINT_SLOT_COUNT); phyBlockNo++)
+			if((phyBlockNo != bbtInfoMapPtr->bbtInfo[dieNo].phyBlock) && (phyBlockMapPtr->phyBlock[dieNo][phyBlockNo].bad == BLOCK_STATE_NORMAL))
+				checkpointMapPtr->die[dieNo].slotBlock[slotNo++] = phyBlockNo;
+
+		if(slotNo < CHECKPOINT_SLOT_COUNT)
+			assert(!"[WARNING] no good block is left for a checkpoint slot [WARNING]");
+	}
+}
+
+unsigned int IsCheckpointSlotBlock(unsigned int dieNo, unsigned int phyBlockNo)
+{
+	unsigned int slotNo;
+
+	for(slotNo = 0; slotNo < CHECKPOINT_SLOT_COUNT; slotNo++)
+		if(checkpointMapPtr->die[dieNo].slotBlock[slotNo] == phyBlockNo)
+			return 1;
+
+	return 0;
+}
+
+static unsigned int CheckpointBufAddr(unsigned int dieNo, unsigned int pageNo)
+{
+	return CHECKPOINT_DATA_BUFFER_BASE_ADDR + (dieNo * CHECKPOINT_PAGES_PER_DIE + pageNo) * BYTES_PER_CHECKPOINT_BUFFER_ENTRY;
+}
+
+static P_VIRTUAL_BLOCK_ENTRY StagedBlockEntry(unsigned int dieNo, unsigned int blockNo)
+{
+	return (P_VIRTUAL_BLOCK_ENTRY)CheckpointBufAddr(dieNo, blockNo / CHECKPOINT_BLOCK_ENTRIES_PER_PAGE) + blockNo % CHECKPOINT_BLOCK_ENTRIES_PER_PAGE;
+}
+
+static P_LOGICAL_SLICE_ENTRY StagedSliceEntry(unsigned int dieNo, unsigned int sliceNo)
+{
+	return (P_LOGICAL_SLICE_ENTRY)CheckpointBufAddr(dieNo, CHECKPOINT_BLOCK_MAP_PAGES + sliceNo / CHECKPOINT_SLICE_ENTRIES_PER_PAGE) + sliceNo % CHECKPOINT_SLICE_ENTRIES_PER_PAGE;
+}
+
+static P_CHECKPOINT_HEADER StagedHeader(unsigned int dieNo)
+{
+	return (P_CHECKPOINT_HEADER)CheckpointBufAddr(dieNo, CHECKPOINT_HEADER_PAGE);
+}
+
+//checkpoint pages are saved at lsb pages of the slot block
+static void IssueCheckpointNandReq(unsigned int dieNo, unsigned int reqCode, unsigned int slotNo, unsigned int pageNo, unsigned int bufAddr)
+{
+	unsigned int reqSlotTag;
+
+	reqSlotTag = GetFromFreeReqQ();
+
+	reqPoolPtr->reqPool[reqSlotTag].reqType = REQ_TYPE_NAND;
+	reqPoolPtr->reqPool[reqSlotTag].reqCode = reqCode;
+	reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandAddr = REQ_OPT_NAND_ADDR_PHY_ORG;
+	reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandEcc = REQ_OPT_NAND_ECC_ON;
+	reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandEccWarning = REQ_OPT_NAND_ECC_WARNING_OFF;
+	reqPoolPtr->reqPool[reqSlotTag].reqOpt.rowAddrDependencyCheck = REQ_OPT_ROW_ADDR_DEPENDENCY_NONE;
+	reqPoolPtr->reqPool[reqSlotTag].reqOpt.blockSpace = REQ_OPT_BLOCK_SPACE_TOTAL;
+
+	if(reqCode == REQ_CODE_ERASE)
+		reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufFormat = REQ_OPT_DATA_BUF_NONE;
+	else
+	{
+		reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufFormat = REQ_OPT_DATA_BUF_ADDR;
+		reqPoolPtr->reqPool[reqSlotTag].dataBufInfo.addr = bufAddr;
+	}
+
+	reqPoolPtr->reqPool[reqSlotTag].nandInfo.physicalCh = Vdie2PchTranslation(dieNo);
+	reqPoolPtr->reqPool[reqSlotTag].nandInfo.physicalWay = Vdie2PwayTranslation(dieNo);
+	reqPoolPtr->reqPool[reqSlotTag].nandInfo.physicalBlock = checkpointMapPtr->die[dieNo].slotBlock[slotNo];
+	reqPoolPtr->reqPool[reqSlotTag].nandInfo.physicalPage = 0;
+	if(reqCode != REQ_CODE_ERASE)
+		reqPoolPtr->reqPool[reqSlotTag].nandInfo.physicalPage = Vpage2PlsbPageTranslation(PlsbPage2VpageTranslation(START_PAGE_NO_OF_CHECKPOINT_BLOCK) + pageNo);
+
+	SelectLowLevelReqQ(reqSlotTag);
+}
+
+//the snapshot may refer to programs and erases still in flight, they are fenced by a new checkpointGen
+//and the headers are queued once they are done, slices mapped later are found by the roll-forward
+static void StageCheckpoint()
+{
+	unsigned int dieNo, blockNo, sliceNo, slotNo;
+	P_CHECKPOINT_HEADER header;
+
+	checkpointMapPtr->fenceGen ^= 1;
+	if(checkpointMapPtr->fencedReqCnt[checkpointMapPtr->fenceGen])
+		assert(!"[WARNING] requests fenced by the checkpoint before the last one are in flight [WARNING]");
+
+	checkpointMapPtr->checkpointSeq++;
+	slotNo = checkpointMapPtr->checkpointSeq % CHECKPOINT_SLOT_COUNT;
+
+	for(dieNo = 0; dieNo < USER_DIES; dieNo++)
+	{
+		for(blockNo = 0; blockNo < USER_BLOCKS_PER_DIE; blockNo++)
+			*StagedBlockEntry(dieNo, blockNo) = virtualBlockMapPtr->block[dieNo][blockNo];
+
+		for(sliceNo = 0; sliceNo < SLICES_PER_DIE; sliceNo++)
+			*StagedSliceEntry(dieNo, sliceNo) = logicalSliceMapPtr->logicalSlice[dieNo * SLICES_PER_DIE + sliceNo];
+
+		header = StagedHeader(dieNo);
+		header->signature = CHECKPOINT_SIGNATURE;
+		header->checkpointSeq = checkpointMapPtr->checkpointSeq;
+		header->sliceWriteSeq = checkpointMapPtr->sliceWriteSeq;
+		header->formatSeq = checkpointMapPtr->formatSeq;
+		header->die = virtualDieMapPtr->die[dieNo];
+
+		checkpointMapPtr->die[dieNo].openedBlockCnt = 0;
+		checkpointMapPtr->die[dieNo].nextPage = 0;
+
+		IssueCheckpointNandReq(dieNo, REQ_CODE_ERASE, slotNo, 0, 0);
+	}
+
+	checkpointMapPtr->writing = 1;
+}
+
+//staged pages are queued while the die is lightly loaded and in step with the blocks it opens,
+//so that all are queued by the time the next checkpoint is due, or all at once when forced,
+//the headers are held back until the requests fenced by the snapshot are done
+static void IssueCheckpointPages(unsigned int force)
+{
+	unsigned int dieNo, chNo, wayNo, slotNo, pacedPageCnt, pageCnt;
+
+	slotNo = checkpointMapPtr->checkpointSeq % CHECKPOINT_SLOT_COUNT;
+	checkpointMapPtr->writing = 0;
+	pageCnt = checkpointMapPtr->fencedReqCnt[checkpointMapPtr->fenceGen ^ 1] ? CHECKPOINT_HEADER_PAGE : CHECKPOINT_PAGES_PER_DIE;
+
+	for(dieNo = 0; dieNo < USER_DIES; dieNo++)
+	{
+		chNo = Vdie2PchTranslation(dieNo);
+		wayNo = Vdie2PwayTranslation(dieNo);
+
+		pacedPageCnt = (checkpointMapPtr->die[dieNo].openedBlockCnt + 1) * CHECKPOINT_PAGES_PER_DIE / CHECKPOINT_INTERVAL_BLOCKS;
+
+		while((checkpointMapPtr->die[dieNo].nextPage < pageCnt) &&
+				(force || (checkpointMapPtr->die[dieNo].nextPage < pacedPageCnt) ||
+				((nandReqQ[chNo][wayNo].reqCnt < CHECKPOINT_QUEUE_DEPTH) && (freeReqQ.headReq != REQ_SLOT_TAG_NONE))))
+		{
+			IssueCheckpointNandReq(dieNo, REQ_CODE_WRITE, slotNo, checkpointMapPtr->die[dieNo].nextPage,
+					CheckpointBufAddr(dieNo, checkpointMapPtr->die[dieNo].nextPage));
+			checkpointMapPtr->die[dieNo].nextPage++;
+		}
+
+		if(checkpointMapPtr->die[dieNo].nextPage < CHECKPOINT_PAGES_PER_DIE)
+			checkpointMapPtr->writing = 1;
+	}
+}
+
+static unsigned int CheckpointDue()
+{
+	unsigned int dieNo;
+
+	for(dieNo = 0; dieNo < USER_DIES; dieNo++)
+		if(checkpointMapPtr->die[dieNo].openedBlockCnt >= CHECKPOINT_INTERVAL_BLOCKS)
+			return 1;
+
+	return 0;
+}
+
+//called from the main loop, a snapshot is taken once a die opened CHECKPOINT_INTERVAL_BLOCKS blocks
+//and the pages of the last one are programmed, its pages are forced out if a die opens another interval
+//of blocks before they are queued, which bounds the blocks scanned at power-on
+void CheckpointScheduler()
+{
+	if(!checkpointMapPtr->writing)
+	{
+		if(!CheckpointDue() || checkpointMapPtr->pageReqCnt)
+			return;
+
+		StageCheckpoint();
+	}
+
+	IssueCheckpointPages(CheckpointDue());
+}
+
+//synchronous checkpoint at power-on and shutdown, a background checkpoint in progress completes first
+//because the new one erases the slot of the one before
+void SaveCheckpoint()
+{
+	SyncAllLowLevelReqDone();
+	if(checkpointMapPtr->writing)
+	{
+		IssueCheckpointPages(1);
+		SyncAllLowLevelReqDone();
+	}
+
+	StageCheckpoint();
+	IssueCheckpointPages(1);
+	SyncAllLowLevelReqDone();
+
+	xil_printf("[ checkpoint %d is saved. ]\r\n", checkpointMapPtr->checkpointSeq);
+}
+
+//called when a program of a mapped slice is issued, a GC copy holds the tag of the slice it was read from until then
+void StampSliceSpareTag(unsigned int reqSlotTag)
+{
+	P_SLICE_SPARE_TAG tag;
+
+	if((reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandAddr != REQ_OPT_NAND_ADDR_VSA) ||
+			((reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufFormat != REQ_OPT_DATA_BUF_ENTRY) && (reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufFormat != REQ_OPT_DATA_BUF_TEMP_ENTRY)))
+		return;
+
+	tag = (P_SLICE_SPARE_TAG)GenerateSpareDataBufAddr(reqSlotTag);
+	tag->logicalSliceAddr = reqPoolPtr->reqPool[reqSlotTag].logicalSliceAddr;
+	tag->writeSeq = reqPoolPtr->reqPool[reqSlotTag].nandInfo.writeSeq;
+	tag->formatSeq = checkpointMapPtr->formatSeq;
+}
+
+//called for every NAND request when it is selected, so that a request blocked by a dependency is fenced as well
+void TrackCheckpointReq(unsigned int reqSlotTag)
+{
+	P_SSD_REQ_FORMAT req = &reqPoolPtr->reqPool[reqSlotTag];
+
+	if((req->reqOpt.nandAddr == REQ_OPT_NAND_ADDR_VSA) && ((req->reqCode == REQ_CODE_WRITE) || (req->reqCode == REQ_CODE_ERASE)))
+	{
+		req->reqOpt.checkpointReq = REQ_OPT_CHECKPOINT_REQ_FENCED;
+		req->reqOpt.checkpointGen = checkpointMapPtr->fenceGen;
+		checkpointMapPtr->fencedReqCnt[checkpointMapPtr->fenceGen]++;
+	}
+	else if((req->reqOpt.nandAddr == REQ_OPT_NAND_ADDR_PHY_ORG) && (req->reqCode == REQ_CODE_WRITE) &&
+			IsCheckpointSlotBlock(Pcw2VdieTranslation(req->nandInfo.physicalCh, req->nandInfo.physicalWay), req->nandInfo.physicalBlock))
+	{
+		req->reqOpt.checkpointReq = REQ_OPT_CHECKPOINT_REQ_PAGE;
+		checkpointMapPtr->pageReqCnt++;
+	}
+	else
+		req->reqOpt.checkpointReq = REQ_OPT_CHECKPOINT_REQ_NONE;
+}
+
+void CheckpointReqDone(unsigned int reqSlotTag)
+{
+	P_SSD_REQ_FORMAT req = &reqPoolPtr->reqPool[reqSlotTag];
+
+	if(req->reqOpt.checkpointReq == REQ_OPT_CHECKPOINT_REQ_FENCED)
+		checkpointMapPtr->fencedReqCnt[req->reqOpt.checkpointGen]--;
+	else if(req->reqOpt.checkpointReq == REQ_OPT_CHECKPOINT_REQ_PAGE)
+		checkpointMapPtr->pageReqCnt--;
+}
+
+//header pages of both slots are read, the newest checkpoint that every die completed is taken
+static unsigned int FindCheckpointSlot()
+{
+	unsigned int dieNo, slotNo, seq, complete, latestSlotNo, latestSeq;
+	P_CHECKPOINT_HEADER header;
+
+	for(slotNo = 0; slotNo < CHECKPOINT_SLOT_COUNT; slotNo++)
+		for(dieNo = 0; dieNo < USER_DIES; dieNo++)
+			IssueCheckpointNandReq(dieNo, REQ_CODE_READ, slotNo, CHECKPOINT_HEADER_PAGE, CheckpointBufAddr(dieNo, slotNo));
+
+	SyncAllLowLevelReqDone();
+
+	latestSlotNo = CHECKPOINT_SLOT_NONE;
+	latestSeq = CHECKPOINT_SEQ_NONE;
+	for(slotNo = 0; slotNo < CHECKPOINT_SLOT_COUNT; slotNo++)
+	{
+		seq = ((P_CHECKPOINT_HEADER)CheckpointBufAddr(0, slotNo))->checkpointSeq;
+		complete = (seq % CHECKPOINT_SLOT_COUNT == slotNo);
+
+		for(dieNo = 0; dieNo < USER_DIES; dieNo++)
+		{
+			header = (P_CHECKPOINT_HEADER)CheckpointBufAddr(dieNo, slotNo);
+			if(header->signature != CHECKPOINT_SIGNATURE)
+			{
+				complete = 0;
+				continue;
+			}
+
+			//a new checkpoint has to be newer than any header left on the NAND
+			if(header->checkpointSeq > checkpointMapPtr->checkpointSeq)
+				checkpointMapPtr->checkpointSeq = header->checkpointSeq;
+			if(header->checkpointSeq != seq)
+				complete = 0;
+		}
+
+		if(complete && (seq > latestSeq))
+		{
+			latestSlotNo = slotNo;
+			latestSeq = seq;
+		}
+	}
+
+	return latestSlotNo;
+}
+
+static void LoadCheckpoint(unsigned int slotNo)
+{
+	unsigned int dieNo, blockNo, sliceNo, pageNo, bad;
+	P_VIRTUAL_BLOCK_ENTRY block;
+
+	for(pageNo = 0; pageNo < CHECKPOINT_PAGES_PER_DIE; pageNo++)
+		for(dieNo = 0; dieNo < USER_DIES; dieNo++)
+			IssueCheckpointNandReq(dieNo, REQ_CODE_READ, slotNo, pageNo, CheckpointBufAddr(dieNo, pageNo));
+
+	SyncAllLowLevelReqDone();
+
+	for(dieNo = 0; dieNo < USER_DIES; dieNo++)
+	{
+		//blocks that went bad after the checkpoint keep the mark of the bad block table
+		for(blockNo = 0; blockNo < USER_BLOCKS_PER_DIE; blockNo++)
+		{
+			block = &virtualBlockMapPtr->block[dieNo][blockNo];
+			bad = block->bad;
+			*block = *StagedBlockEntry(dieNo, blockNo);
+			if(bad && !block->bad)
+			{
+				block->bad = 1;
+				block->free = 0;
+			}
+		}
+
+		for(sliceNo = 0; sliceNo < SLICES_PER_DIE; sliceNo++)
+			logicalSliceMapPtr->logicalSlice[dieNo * SLICES_PER_DIE + sliceNo] = *StagedSliceEntry(dieNo, sliceNo);
+
+		virtualDieMapPtr->die[dieNo] = StagedHeader(dieNo)->die;
+	}
+
+	checkpointMapPtr->sliceWriteSeq = StagedHeader(0)->sliceWriteSeq;
+	checkpointMapPtr->formatSeq = StagedHeader(0)->formatSeq;
+}
+
+static void IssueScanRead(unsigned int reqSlotTag, unsigned int dieNo, unsigned int blockNo, unsigned int pageNo, unsigned int bufAddr)
+{
+	reqPoolPtr->reqPool[reqSlotTag].reqType = REQ_TYPE_NAND;
+	reqPoolPtr->reqPool[reqSlotTag].reqCode = REQ_CODE_READ;
+	reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufFormat = REQ_OPT_DATA_BUF_ADDR;
+	reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandAddr = REQ_OPT_NAND_ADDR_VSA;
+	reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandEcc = REQ_OPT_NAND_ECC_ON;
+	reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandEccWarning = REQ_OPT_NAND_ECC_WARNING_OFF;
+	reqPoolPtr->reqPool[reqSlotTag].reqOpt.rowAddrDependencyCheck = REQ_OPT_ROW_ADDR_DEPENDENCY_NONE;
+	reqPoolPtr->reqPool[reqSlotTag].reqOpt.blockSpace = REQ_OPT_BLOCK_SPACE_MAIN;
+	reqPoolPtr->reqPool[reqSlotTag].dataBufInfo.addr = bufAddr;
+	reqPoolPtr->reqPool[reqSlotTag].nandInfo.virtualSliceAddr = Vorg2VsaTranslation(dieNo, blockNo, pageNo);
+
+	SelectLowLevelReqQ(reqSlotTag);
+}
+
+static void AddScanBlock(unsigned int dieNo, unsigned int blockNo, unsigned int startPage)
+{
+	scanBlock[dieNo][scanBlockCnt[dieNo]] = blockNo;
+	scanStartPage[dieNo][scanBlockCnt[dieNo]] = startPage;
+	scanBlockCnt[dieNo]++;
+}
+
+static unsigned int IsCheckpointOpenBlock(unsigned int dieNo, unsigned int blockNo)
+{
+	unsigned int writeStream;
+
+	for(writeStream = 0; writeStream < WRITE_STREAM_COUNT; writeStream++)
+		if((virtualDieMapPtr->die[dieNo].currentBlock[writeStream] == blockNo) || (virtualDieMapPtr->die[dieNo].planeBlock[writeStream] == blockNo))
+			return 1;
+
+	return 0;
+}
+
+//the tag of the first page tells how a block changed after the checkpoint
+static void ClassifyProbedBlock(unsigned int dieNo, unsigned int blockNo, P_SLICE_SPARE_TAG tag, unsigned int checkpointSliceWriteSeq)
+{
+	P_VIRTUAL_BLOCK_ENTRY block;
+
+	block = &virtualBlockMapPtr->block[dieNo][blockNo];
+
+	//erased, the valid slices it had were copied to a block programmed after the checkpoint
+	if(tag->logicalSliceAddr == LSA_NONE)
+	{
+		block->free = 1;
+		block->unerased = 0;
+		block->currentPage = 0;
+		block->invalidSliceCnt = 0;
+	}
+	//left unerased by the format, it is still on the dirty free block list
+	else if(tag->formatSeq != checkpointMapPtr->formatSeq)
+		return;
+	//opened after the checkpoint, none of the slices the checkpoint maps to it are there any more
+	else if(tag->writeSeq >= checkpointSliceWriteSeq)
+	{
+		block->unerased = 0;
+		block->currentPage = 0;
+		AddScanBlock(dieNo, blockNo, 0);
+	}
+	//open at the checkpoint, a full block is still the current block until the next slice is allocated
+	else if(!block->free && (block->currentPage < USER_PAGES_PER_BLOCK) && IsCheckpointOpenBlock(dieNo, blockNo))
+		AddScanBlock(dieNo, blockNo, block->currentPage);
+}
+
+//the first page of every block is read, so that a block erased by GC and taken again after the checkpoint is found
+static void ProbeBlocks(unsigned int checkpointSliceWriteSeq)
+{
+	unsigned int dieNo, blockNo, baseBlockNo, probeCnt, reqSlotTag;
+
+	for(dieNo = 0; dieNo < USER_DIES; dieNo++)
+		scanBlockCnt[dieNo] = 0;
+
+	for(baseBlockNo = 0; baseBlockNo < USER_BLOCKS_PER_DIE; baseBlockNo += CHECKPOINT_PROBE_DEPTH)
+	{
+		for(dieNo = 0; dieNo < USER_DIES; dieNo++)
+			for(probeCnt = 0; (probeCnt < CHECKPOINT_PROBE_DEPTH) && (baseBlockNo + probeCnt < USER_BLOCKS_PER_DIE); probeCnt++)
+			{
+				blockNo = baseBlockNo + probeCnt;
+				if(virtualBlockMapPtr->block[dieNo][blockNo].bad)
+					continue;
+
+				reqSlotTag = GetFromFreeReqQ();
+				IssueScanRead(reqSlotTag, dieNo, blockNo, 0, CheckpointBufAddr(dieNo, probeCnt));
+			}
+
+		SyncAllLowLevelReqDone();
+
+		for(dieNo = 0; dieNo < USER_DIES; dieNo++)
+			for(probeCnt = 0; (probeCnt < CHECKPOINT_PROBE_DEPTH) && (baseBlockNo + probeCnt < USER_BLOCKS_PER_DIE); probeCnt++)
+			{
+				blockNo = baseBlockNo + probeCnt;
+				if(!virtualBlockMapPtr->block[dieNo][blockNo].bad)
+					ClassifyProbedBlock(dieNo, blockNo, (P_SLICE_SPARE_TAG)(CheckpointBufAddr(dieNo, probeCnt) + BYTES_PER_DATA_REGION_OF_PAGE), checkpointSliceWriteSeq);
+			}
+	}
+}
+
+//a logical slice trimmed after the checkpoint may still be mapped to a page erased and programmed again since,
+//the mappings past the programmed pages of their blocks are dropped and the roll-forward sets the ones still valid
+static void DropStaleCheckpointMappings()
+{
+	unsigned int sliceAddr, virtualSliceAddr;
+	P_VIRTUAL_BLOCK_ENTRY block;
+
+	for(sliceAddr = 0; sliceAddr < SLICES_PER_SSD; sliceAddr++)
+	{
+		virtualSliceAddr = logicalSliceMapPtr->logicalSlice[sliceAddr].virtualSliceAddr;
+		if(virtualSliceAddr == VSA_NONE)
+			continue;
+
+		block = &virtualBlockMapPtr->block[Vsa2VdieTranslation(virtualSliceAddr)][Vsa2VblockTranslation(virtualSliceAddr)];
+		if(block->free || (Vsa2VpageTranslation(virtualSliceAddr) >= block->currentPage))
+			logicalSliceMapPtr->logicalSlice[sliceAddr].virtualSliceAddr = VSA_NONE;
+	}
+}
+
+//the virtual slice map holds the writeSeq of the mapping of each logical slice set by the scan, the higher one is kept
+static void ApplySpareTag(unsigned int virtualSliceAddr, P_SLICE_SPARE_TAG tag, unsigned int checkpointSliceWriteSeq)
+{
+	unsigned int logicalSliceAddr;
+
+	logicalSliceAddr = tag->logicalSliceAddr;
+	if((logicalSliceAddr >= SLICES_PER_SSD) || (tag->writeSeq < checkpointSliceWriteSeq))
+		return;
+
+	if(tag->writeSeq > virtualSliceMapPtr->virtualSlice[logicalSliceAddr].logicalSliceAddr)
+	{
+		logicalSliceMapPtr->logicalSlice[logicalSliceAddr].virtualSliceAddr = virtualSliceAddr;
+		virtualSliceMapPtr->virtualSlice[logicalSliceAddr].logicalSliceAddr = tag->writeSeq;
+	}
+
+	if(tag->writeSeq >= checkpointMapPtr->sliceWriteSeq)
+		checkpointMapPtr->sliceWriteSeq = tag->writeSeq + 1;
+}
+
+//the scanned block keeps the slices programmed up to its first clean page, it is closed unless it has none
+static void CloseScannedBlock(unsigned int dieNo, unsigned int blockNo, unsigned int programmedPageCnt)
+{
+	if(programmedPageCnt == 0)
+	{
+		virtualBlockMapPtr->block[dieNo][blockNo].free = 1;
+		virtualBlockMapPtr->block[dieNo][blockNo].currentPage = 0;
+		return;
+	}
+
+	virtualBlockMapPtr->block[dieNo][blockNo].free = 0;
+	virtualBlockMapPtr->block[dieNo][blockNo].currentPage = USER_PAGES_PER_BLOCK;
+}
+
+//reads of all dies go out together, CHECKPOINT_SCAN_DEPTH pages of the scanned block of each die per round
+static unsigned int RollForward(unsigned int checkpointSliceWriteSeq)
+{
+	unsigned int dieNo, blockNo, readCnt, reqSlotTag, active, rolledSliceCnt;
+	unsigned int scanIndex[USER_DIES], scanPage[USER_DIES], scanReadCnt[USER_DIES];
+	P_SLICE_SPARE_TAG tag;
+
+	for(dieNo = 0; dieNo < USER_DIES; dieNo++)
+	{
+		scanIndex[dieNo] = 0;
+		scanPage[dieNo] = scanStartPage[dieNo][0];
+	}
+
+	rolledSliceCnt = 0;
+	do
+	{
+		active = 0;
+		for(dieNo = 0; dieNo < USER_DIES; dieNo++)
+		{
+			scanReadCnt[dieNo] = 0;
+			if(scanIndex[dieNo] >= scanBlockCnt[dieNo])
+				continue;
+
+			blockNo = scanBlock[dieNo][scanIndex[dieNo]];
+			for(readCnt = 0; (readCnt < CHECKPOINT_SCAN_DEPTH) && (scanPage[dieNo] + readCnt < USER_PAGES_PER_BLOCK); readCnt++)
+			{
+				reqSlotTag = GetFromFreeReqQ();
+				IssueScanRead(reqSlotTag, dieNo, blockNo, scanPage[dieNo] + readCnt, CheckpointBufAddr(dieNo, readCnt));
+			}
+
+			scanReadCnt[dieNo] = readCnt;
+			active = 1;
+		}
+
+		if(!active)
+			break;
+
+		SyncAllLowLevelReqDone();
+
+		for(dieNo = 0; dieNo < USER_DIES; dieNo++)
+		{
+			if(!scanReadCnt[dieNo])
+				continue;
+
+			blockNo = scanBlock[dieNo][scanIndex[dieNo]];
+			for(readCnt = 0; readCnt < scanReadCnt[dieNo]; readCnt++)
+			{
+				//slices are programmed in page order, a page without a tag of this format ends the block
+				tag = (P_SLICE_SPARE_TAG)(CheckpointBufAddr(dieNo, readCnt) + BYTES_PER_DATA_REGION_OF_PAGE);
+				if((tag->logicalSliceAddr == LSA_NONE) || (tag->formatSeq != checkpointMapPtr->formatSeq))
+					break;
+
+				ApplySpareTag(Vorg2VsaTranslation(dieNo, blockNo, scanPage[dieNo] + readCnt), tag, checkpointSliceWriteSeq);
+				rolledSliceCnt++;
+			}
+
+			scanPage[dieNo] += readCnt;
+			if((readCnt < scanReadCnt[dieNo]) || (scanPage[dieNo] == USER_PAGES_PER_BLOCK))
+			{
+				CloseScannedBlock(dieNo, blockNo, scanPage[dieNo]);
+
+				scanIndex[dieNo]++;
+				if(scanIndex[dieNo] < scanBlockCnt[dieNo])
+					scanPage[dieNo] = scanStartPage[dieNo][scanIndex[dieNo]];
+			}
+		}
+	} while(active);
+
+	return rolledSliceCnt;
+}
+
+static void RebuildFreeBlockList()
+{
+	unsigned int dieNo, blockNo;
+
+	for(dieNo = 0; dieNo < USER_DIES; dieNo++)
+	{
+		ResetFreeBlockHeap(dieNo);
+		virtualDieMapPtr->die[dieNo].freeBlockCnt = 0;
+		virtualDieMapPtr->die[dieNo].headDirtyFreeBlock = BLOCK_NONE;
+		virtualDieMapPtr->die[dieNo].tailDirtyFreeBlock = BLOCK_NONE;
+		virtualDieMapPtr->die[dieNo].dirtyFreeBlockCnt = 0;
+
+		for(blockNo = 0; blockNo < USER_BLOCKS_PER_DIE; blockNo++)
+			if(virtualBlockMapPtr->block[dieNo][blockNo].free && !virtualBlockMapPtr->block[dieNo][blockNo].bad)
+			{
+				if(virtualBlockMapPtr->block[dieNo][blockNo].unerased)
+					PutToDirtyFbList(dieNo, blockNo);
+				else
+					PutToFbList(dieNo, blockNo);
+			}
+	}
+}
+
+//the virtual slice map is inverted from the logical one, invalid slices are the programmed ones no logical slice maps to
+//a logical slice left mapped to a block erased after the checkpoint was trimmed before the erase
+static void RebuildVirtualSliceMap()
+{
+	unsigned int sliceAddr, virtualSliceAddr, dieNo, blockNo, pageNo, validSliceCnt;
+
+	for(sliceAddr = 0; sliceAddr < SLICES_PER_SSD; sliceAddr++)
+		virtualSliceMapPtr->virtualSlice[sliceAddr].logicalSliceAddr = LSA_NONE;
+
+	for(sliceAddr = 0; sliceAddr < SLICES_PER_SSD; sliceAddr++)
+	{
+		virtualSliceAddr = logicalSliceMapPtr->logicalSlice[sliceAddr].virtualSliceAddr;
+		if(virtualSliceAddr == VSA_NONE)
+			continue;
+
+		dieNo = Vsa2VdieTranslation(virtualSliceAddr);
+		blockNo = Vsa2VblockTranslation(virtualSliceAddr);
+		if(virtualBlockMapPtr->block[dieNo][blockNo].free || virtualBlockMapPtr->block[dieNo][blockNo].bad)
+			logicalSliceMapPtr->logicalSlice[sliceAddr].virtualSliceAddr = VSA_NONE;
+		else if(virtualSliceMapPtr->virtualSlice[virtualSliceAddr].logicalSliceAddr != LSA_NONE)
+			assert(!"[WARNING] two logical slices are mapped to a virtual slice after recovery [WARNING]");
+		else
+			virtualSliceMapPtr->virtualSlice[virtualSliceAddr].logicalSliceAddr = sliceAddr;
+	}
+
+	for(dieNo = 0; dieNo < USER_DIES; dieNo++)
+		for(blockNo = 0; blockNo < USER_BLOCKS_PER_DIE; blockNo++)
+			if(!virtualBlockMapPtr->block[dieNo][blockNo].free && !virtualBlockMapPtr->block[dieNo][blockNo].bad)
+			{
+				validSliceCnt = 0;
+				for(pageNo = 0; pageNo < virtualBlockMapPtr->block[dieNo][blockNo].currentPage; pageNo++)
+					if(virtualSliceMapPtr->virtualSlice[Vorg2VsaTranslation(dieNo, blockNo, pageNo)].logicalSliceAddr != LSA_NONE)
+						validSliceCnt++;
+
+				virtualBlockMapPtr->block[dieNo][blockNo].invalidSliceCnt = virtualBlockMapPtr->block[dieNo][blockNo].currentPage - validSliceCnt;
+
+				//programmed pages of a restored block are readable, an erase of it waits for them as usual
+				rowAddrDependencyTablePtr->block[Vdie2PchTranslation(dieNo)][Vdie2PwayTranslation(dieNo)][blockNo].permittedProgPage =
+						virtualBlockMapPtr->block[dieNo][blockNo].currentPage;
+			}
+}
+
+//called by InitBlockDieMap instead of erasing the user blocks, returns 0 when there is no complete checkpoint
+//the start-up work is the checkpoint, a page of each block and the blocks programmed after the checkpoint
+unsigned int RecoverCheckpoint()
+{
+	unsigned int slotNo, sliceAddr, checkpointSliceWriteSeq, rolledSliceCnt;
+
+	slotNo = FindCheckpointSlot();
+	if(slotNo == CHECKPOINT_SLOT_NONE)
+	{
+		//the user blocks are formatted, tags they hold from before are older than any checkpoint header on the NAND
+		checkpointMapPtr->formatSeq = checkpointMapPtr->checkpointSeq + 1;
+
+		xil_printf("[ checkpoint does not exist. ]\r\n");
+		return 0;
+	}
+
+	LoadCheckpoint(slotNo);
+
+	//the virtual slice map is scratch for the writeSeq of the mapping of each logical slice
+	for(sliceAddr = 0; sliceAddr < SLICES_PER_SSD; sliceAddr++)
+		virtualSliceMapPtr->virtualSlice[sliceAddr].logicalSliceAddr = 0;
+
+	checkpointSliceWriteSeq = checkpointMapPtr->sliceWriteSeq;
+	ProbeBlocks(checkpointSliceWriteSeq);
+	DropStaleCheckpointMappings();
+	rolledSliceCnt = RollForward(checkpointSliceWriteSeq);
+
+	RebuildFreeBlockList();
+	RebuildVirtualSliceMap();
+
+	xil_printf("[ checkpoint %d is loaded, %d slices programmed after it are scanned. ]\r\n", checkpointMapPtr->checkpointSeq, rolledSliceCnt);
+
+	return 1;
+}
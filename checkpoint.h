@@ -0,0 +1,122 @@
+//////////////////////////////////////////////////////////////////////////////////
+// checkpoint.h for Cosmos+ OpenSSD
+//
+// This file is part of Cosmos+ OpenSSD.
+//
+// Cosmos+ OpenSSD is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3, or (at your option)
+// any later version.
+//
+// Cosmos+ OpenSSD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Cosmos+ OpenSSD; see the file COPYING.
+// If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Project Name: Cosmos+ OpenSSD
+// Design Name: Cosmos+ Firmware
+// Module Name: Map Checkpoint
+// File Name: checkpoint.h
+//
+// Version: v1.3.0
+//
+// Description:
+//   - define parameters, data structure and functions of map checkpoints
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Revision History:
+//
+// * v1.3.0
+//   - a snapshot is taken without draining the NAND requests, its header waits for the programs and erases issued before it
+//
+// * v1.2.0
+//   - slot blocks are the first good blocks of the bad block table instead of fixed blocks
+//
+// * v1.1.0
+//   - tags and headers carry the format sequence, tags left by data from before a format are stale
+//
+// * v1.0.0
+//   - First draft
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CHECKPOINT_H_
+#define CHECKPOINT_H_
+
+#include "address_translation.h"
+
+#define CHECKPOINT_SIGNATURE				0x43504B54
+#define CHECKPOINT_SEQ_NONE					0
+
+#define CHECKPOINT_SLOT_COUNT				2	//checkpoints take the slot blocks in turn, the older one is valid until the newer one is complete
+#define CHECKPOINT_SLOT_NONE				0xff
+#define START_PAGE_NO_OF_CHECKPOINT_BLOCK	(1)	//preserves the bad block mark like the bad block table block
+
+#define CHECKPOINT_INTERVAL_BLOCKS			32	//blocks a die opens between checkpoints
+#define CHECKPOINT_QUEUE_DEPTH				2	//queued NAND requests of a die below which a background checkpoint adds a page
+#define CHECKPOINT_SCAN_DEPTH				8	//pages of a die read per round of the power-on scan
+#define CHECKPOINT_PROBE_DEPTH				64	//blocks of a die whose first page is read per round of the power-on probe
+
+//a page holds whole entries, so that staged pages can be read back in any order
+#define CHECKPOINT_BLOCK_ENTRIES_PER_PAGE	(BYTES_PER_DATA_REGION_OF_PAGE / sizeof(VIRTUAL_BLOCK_ENTRY))
+#define CHECKPOINT_SLICE_ENTRIES_PER_PAGE	(BYTES_PER_DATA_REGION_OF_PAGE / sizeof(LOGICAL_SLICE_ENTRY))
+#define CHECKPOINT_BLOCK_MAP_PAGES			((USER_BLOCKS_PER_DIE + CHECKPOINT_BLOCK_ENTRIES_PER_PAGE - 1) / CHECKPOINT_BLOCK_ENTRIES_PER_PAGE)
+#define CHECKPOINT_SLICE_MAP_PAGES			((SLICES_PER_DIE + CHECKPOINT_SLICE_ENTRIES_PER_PAGE - 1) / CHECKPOINT_SLICE_ENTRIES_PER_PAGE)
+#define CHECKPOINT_PAGES_PER_DIE			(CHECKPOINT_BLOCK_MAP_PAGES + CHECKPOINT_SLICE_MAP_PAGES + 1)
+#define CHECKPOINT_HEADER_PAGE				(CHECKPOINT_PAGES_PER_DIE - 1)	//programmed last, a slot without it is incomplete
+
+#define BYTES_PER_CHECKPOINT_BUFFER_ENTRY	(BYTES_PER_DATA_REGION_OF_PAGE + BYTES_PER_SPARE_REGION_OF_PAGE)
+#define CHECKPOINT_BUFFER_ENTRY_COUNT		(CHECKPOINT_PAGES_PER_DIE * USER_DIES)
+
+//carried in the spare region of every programmed slice, the mapping with the highest writeSeq of a logical slice is the current one
+typedef struct _SLICE_SPARE_TAG {
+	unsigned int logicalSliceAddr;
+	unsigned int writeSeq;
+	unsigned int formatSeq;
+} SLICE_SPARE_TAG, *P_SLICE_SPARE_TAG;
+
+typedef struct _CHECKPOINT_HEADER {
+	unsigned int signature;
+	unsigned int checkpointSeq;
+	unsigned int sliceWriteSeq;		//writeSeq of the first slice mapped after the checkpoint
+	unsigned int formatSeq;
+	VIRTUAL_DIE_ENTRY die;
+} CHECKPOINT_HEADER, *P_CHECKPOINT_HEADER;
+
+//each die keeps its block map, its share of the logical slice map and a header in its own slot block
+typedef struct _CHECKPOINT_DIE_ENTRY {
+	unsigned int openedBlockCnt : 16;	//blocks taken from the free list since the last snapshot
+	unsigned int nextPage : 16;			//staged page queued next, CHECKPOINT_PAGES_PER_DIE when all are queued
+	unsigned short slotBlock[CHECKPOINT_SLOT_COUNT];	//physical blocks of the slots
+} CHECKPOINT_DIE_ENTRY, *P_CHECKPOINT_DIE_ENTRY;
+
+typedef struct _CHECKPOINT_MAP {
+	CHECKPOINT_DIE_ENTRY die[USER_DIES];
+	unsigned int checkpointSeq;		//of the last snapshot, it is written to slot checkpointSeq % CHECKPOINT_SLOT_COUNT
+	unsigned int sliceWriteSeq;		//writeSeq of the next mapped slice
+	unsigned int formatSeq;			//set by a format newer than any checkpoint on the NAND, unerased blocks may hold tags of older ones
+	unsigned int writing;			//pages of the last snapshot are still being queued
+	unsigned int fenceGen;			//checkpointGen of the fenced requests issued since the last snapshot
+	unsigned int fencedReqCnt[2];	//fenced requests in flight per checkpointGen, the header of the last snapshot waits for the older one
+	unsigned int pageReqCnt;		//staged pages queued and not yet programmed, the staging buffer is reused when there is none
+} CHECKPOINT_MAP, *P_CHECKPOINT_MAP;
+
+void InitCheckpoint();
+void SelectCheckpointSlotBlocks();
+unsigned int IsCheckpointSlotBlock(unsigned int dieNo, unsigned int phyBlockNo);
+unsigned int RecoverCheckpoint();
+void SaveCheckpoint();
+void CheckpointScheduler();
+void StampSliceSpareTag(unsigned int reqSlotTag);
+void TrackCheckpointReq(unsigned int reqSlotTag);
+void CheckpointReqDone(unsigned int reqSlotTag);
+
+extern P_CHECKPOINT_MAP checkpointMapPtr;
+
+#endif /* CHECKPOINT_H_ */
@@ -30,15 +30,34 @@
 // Module Name: Data Buffer Manager
 // File Name: data_buffer.c
 //
-// Version: v1.0.0
+// Version: v1.5.0
 //
 // Description:
 //   - manage data buffer used to transfer data between host system and NAND device
+//   - replace buffer entries by LRU or by ARC (DATA_BUF_POLICY_*), selected at runtime
 //////////////////////////////////////////////////////////////////////////////////
 
 //////////////////////////////////////////////////////////////////////////////////
 // Revision History:
 //
+// * v1.5.0
+//   - entries a sequential write is still filling get a second chance before replacement
+//
+// * v1.4.0
+//   - valid NVMe blocks of an entry are tracked, fill reads are merged by MergeDataBufEntry
+//
+// * v1.3.0
+//   - ARC replacement with ghost lists keyed by logicalSliceAddr (SetDataBufPolicy)
+//   - AllocateDataBuf takes the slice to be buffered
+//
+// * v1.2.0
+//   - chained hash lists are replaced by an open-addressing table with linear probing
+//
+// * v1.1.0
+//   - temporary buffer entries are allocated from a per-die pool
+//   - buffered copies of deallocated slices can be dropped (DropDataBuf)
+//   - dirty entries are counted (dirtyDataBufCnt)
+//
 // * v1.0.0
 //   - First draft
 //////////////////////////////////////////////////////////////////////////////////
@@ -46,20 +65,111 @@
 
 #include "xil_printf.h"
 #include <assert.h>
+#include <string.h>
 #include "memory_map.h"
 
 
 P_DATA_BUF_MAP dataBufMapPtr;
-DATA_BUF_LRU_LIST dataBufLruList;
+DATA_BUF_LRU_LIST dataBufLruList[DATA_BUF_LIST_COUNT];
+unsigned int dirtyDataBufCnt;
 P_DATA_BUF_HASH_TABLE dataBufHashTablePtr;
+P_DATA_BUF_GHOST_MAP dataBufGhostMapPtr;
 P_TEMPORARY_DATA_BUF_MAP tempDataBufMapPtr;
 
+const char* const dataBufPolicyName[DATA_BUF_POLICY_COUNT] = {"LRU", "ARC"};
+
+static unsigned int dataBufPolicy;
+
+static void InitHashTable(P_DATA_BUF_HASH_TABLE hashTable)
+{
+	unsigned int hashEntry;
+
+	for(hashEntry = 0; hashEntry < DATA_BUF_HASH_TABLE_SIZE; hashEntry++)
+	{
+		hashTable->dataBufHash[hashEntry].logicalSliceAddr = LSA_NONE;
+		hashTable->dataBufHash[hashEntry].bufEntry = DATA_BUF_NONE;
+	}
+}
+
+//slot holding the slice, or the empty slot ending its probe sequence
+static unsigned int ProbeHashTable(P_DATA_BUF_HASH_TABLE hashTable, unsigned int logicalSliceAddr)
+{
+	unsigned int hashEntry;
+
+	hashEntry = FindDataBufHashTableEntry(logicalSliceAddr);
+	while((hashTable->dataBufHash[hashEntry].logicalSliceAddr != LSA_NONE) && (hashTable->dataBufHash[hashEntry].logicalSliceAddr != logicalSliceAddr))
+		hashEntry = (hashEntry + 1) & DATA_BUF_HASH_TABLE_MASK;
+
+	return hashEntry;
+}
+
+static void InsertHashTable(P_DATA_BUF_HASH_TABLE hashTable, unsigned int logicalSliceAddr, unsigned int entry)
+{
+	unsigned int hashEntry;
+
+	hashEntry = ProbeHashTable(hashTable, logicalSliceAddr);
+	hashTable->dataBufHash[hashEntry].logicalSliceAddr = logicalSliceAddr;
+	hashTable->dataBufHash[hashEntry].bufEntry = entry;
+}
+
+//backward shift deletion, no tombstones are left behind to lengthen later probes
+static void RemoveHashTable(P_DATA_BUF_HASH_TABLE hashTable, unsigned int logicalSliceAddr)
+{
+	unsigned int holeEntry, hashEntry, homeEntry;
+
+	holeEntry = ProbeHashTable(hashTable, logicalSliceAddr);
+	if(hashTable->dataBufHash[holeEntry].logicalSliceAddr == LSA_NONE)
+		return;
+
+	hashEntry = (holeEntry + 1) & DATA_BUF_HASH_TABLE_MASK;
+	while(hashTable->dataBufHash[hashEntry].logicalSliceAddr != LSA_NONE)
+	{
+		//an entry may fill the hole only if the hole is not in front of its home slot
+		homeEntry = FindDataBufHashTableEntry(hashTable->dataBufHash[hashEntry].logicalSliceAddr);
+		if(((hashEntry - homeEntry) & DATA_BUF_HASH_TABLE_MASK) >= ((hashEntry - holeEntry) & DATA_BUF_HASH_TABLE_MASK))
+		{
+			hashTable->dataBufHash[holeEntry] = hashTable->dataBufHash[hashEntry];
+			holeEntry = hashEntry;
+		}
+
+		hashEntry = (hashEntry + 1) & DATA_BUF_HASH_TABLE_MASK;
+	}
+
+	hashTable->dataBufHash[holeEntry].logicalSliceAddr = LSA_NONE;
+	hashTable->dataBufHash[holeEntry].bufEntry = DATA_BUF_NONE;
+}
+
+static void InitDataBufGhost()
+{
+	unsigned int ghostEntry, listNo;
+
+	for(ghostEntry = 0; ghostEntry < AVAILABLE_DATA_BUFFER_ENTRY_COUNT; ghostEntry++)
+	{
+		dataBufGhostMapPtr->ghost[ghostEntry].logicalSliceAddr = LSA_NONE;
+		dataBufGhostMapPtr->ghost[ghostEntry].prevEntry = DATA_BUF_NONE;
+		dataBufGhostMapPtr->ghost[ghostEntry].nextEntry = ghostEntry + 1;
+	}
+	dataBufGhostMapPtr->ghost[AVAILABLE_DATA_BUFFER_ENTRY_COUNT - 1].nextEntry = DATA_BUF_NONE;
+	dataBufGhostMapPtr->freeEntry = 0;
+
+	for(listNo = 0; listNo < DATA_BUF_LIST_COUNT; listNo++)
+	{
+		dataBufGhostMapPtr->ghostList[listNo].headEntry = DATA_BUF_NONE;
+		dataBufGhostMapPtr->ghostList[listNo].tailEntry = DATA_BUF_NONE;
+		dataBufGhostMapPtr->ghostList[listNo].entryCnt = 0;
+	}
+
+	dataBufGhostMapPtr->recencyTarget = 0;
+	InitHashTable(&dataBufGhostMapPtr->ghostHash);
+}
+
 void InitDataBuf()
 {
 	int bufEntry;
 
 	dataBufMapPtr = (P_DATA_BUF_MAP) DATA_BUFFER_MAP_ADDR;
 	dataBufHashTablePtr = (P_DATA_BUF_HASH_TABLE)DATA_BUFFFER_HASH_TABLE_ADDR;
+	dataBufGhostMapPtr = (P_DATA_BUF_GHOST_MAP)DATA_BUFFER_GHOST_MAP_ADDR;
 	tempDataBufMapPtr = (P_TEMPORARY_DATA_BUF_MAP)TEMPORARY_DATA_BUFFER_MAP_ADDR;
 
 	for(bufEntry = 0; bufEntry < AVAILABLE_DATA_BUFFER_ENTRY_COUNT; bufEntry++)
@@ -68,110 +178,371 @@ void InitDataBuf()
 		dataBufMapPtr->dataBuf[bufEntry].prevEntry = bufEntry-1;
 		dataBufMapPtr->dataBuf[bufEntry].nextEntry = bufEntry+1;
 		dataBufMapPtr->dataBuf[bufEntry].dirty = DATA_BUF_CLEAN;
+		dataBufMapPtr->dataBuf[bufEntry].list = DATA_BUF_LIST_RECENCY;
+		dataBufMapPtr->dataBuf[bufEntry].blockValid = DATA_BUF_BLOCK_VALID_ALL;
+		dataBufMapPtr->dataBuf[bufEntry].seqFill = 0;
 		dataBufMapPtr->dataBuf[bufEntry].blockingReqTail =  REQ_SLOT_TAG_NONE;
-
-		dataBufHashTablePtr->dataBufHash[bufEntry].headEntry = DATA_BUF_NONE;
-		dataBufHashTablePtr->dataBufHash[bufEntry].tailEntry = DATA_BUF_NONE;
-		dataBufMapPtr->dataBuf[bufEntry].hashPrevEntry = DATA_BUF_NONE;
-		dataBufMapPtr->dataBuf[bufEntry].hashNextEntry = DATA_BUF_NONE;
 	}
 
+	InitHashTable(dataBufHashTablePtr);
+	InitDataBufGhost();
+
 	dataBufMapPtr->dataBuf[0].prevEntry = DATA_BUF_NONE;
 	dataBufMapPtr->dataBuf[AVAILABLE_DATA_BUFFER_ENTRY_COUNT - 1].nextEntry = DATA_BUF_NONE;
-	dataBufLruList.headEntry = 0 ;
-	dataBufLruList.tailEntry = AVAILABLE_DATA_BUFFER_ENTRY_COUNT - 1;
+	dataBufLruList[DATA_BUF_LIST_RECENCY].headEntry = 0 ;
+	dataBufLruList[DATA_BUF_LIST_RECENCY].tailEntry = AVAILABLE_DATA_BUFFER_ENTRY_COUNT - 1;
+	dataBufLruList[DATA_BUF_LIST_RECENCY].entryCnt = AVAILABLE_DATA_BUFFER_ENTRY_COUNT;
+	dataBufLruList[DATA_BUF_LIST_FREQUENCY].headEntry = DATA_BUF_NONE;
+	dataBufLruList[DATA_BUF_LIST_FREQUENCY].tailEntry = DATA_BUF_NONE;
+	dataBufLruList[DATA_BUF_LIST_FREQUENCY].entryCnt = 0;
+	dirtyDataBufCnt = 0;
+	dataBufPolicy = DATA_BUF_POLICY_DEFAULT;
 
 	for(bufEntry = 0; bufEntry < AVAILABLE_TEMPORARY_DATA_BUFFER_ENTRY_COUNT; bufEntry++)
 		tempDataBufMapPtr->tempDataBuf[bufEntry].blockingReqTail =  REQ_SLOT_TAG_NONE;
+
+	for(bufEntry = 0; bufEntry < USER_DIES; bufEntry++)
+		tempDataBufMapPtr->nextEntry[bufEntry] = 0;
+}
+
+static void UnlinkDataBufEntry(unsigned int bufEntry)
+{
+	P_DATA_BUF_LRU_LIST lruList;
+
+	lruList = &dataBufLruList[dataBufMapPtr->dataBuf[bufEntry].list];
+
+	if(dataBufMapPtr->dataBuf[bufEntry].prevEntry != DATA_BUF_NONE)
+		dataBufMapPtr->dataBuf[dataBufMapPtr->dataBuf[bufEntry].prevEntry].nextEntry = dataBufMapPtr->dataBuf[bufEntry].nextEntry;
+	else
+		lruList->headEntry = dataBufMapPtr->dataBuf[bufEntry].nextEntry;
+
+	if(dataBufMapPtr->dataBuf[bufEntry].nextEntry != DATA_BUF_NONE)
+		dataBufMapPtr->dataBuf[dataBufMapPtr->dataBuf[bufEntry].nextEntry].prevEntry = dataBufMapPtr->dataBuf[bufEntry].prevEntry;
+	else
+		lruList->tailEntry = dataBufMapPtr->dataBuf[bufEntry].prevEntry;
+
+	lruList->entryCnt--;
+}
+
+static void LinkDataBufEntryToHead(unsigned int bufEntry, unsigned int listNo)
+{
+	P_DATA_BUF_LRU_LIST lruList;
+
+	lruList = &dataBufLruList[listNo];
+
+	dataBufMapPtr->dataBuf[bufEntry].list = listNo;
+	dataBufMapPtr->dataBuf[bufEntry].prevEntry = DATA_BUF_NONE;
+	dataBufMapPtr->dataBuf[bufEntry].nextEntry = lruList->headEntry;
+	if(lruList->headEntry != DATA_BUF_NONE)
+		dataBufMapPtr->dataBuf[lruList->headEntry].prevEntry = bufEntry;
+	else
+		lruList->tailEntry = bufEntry;
+	lruList->headEntry = bufEntry;
+
+	lruList->entryCnt++;
+}
+
+static void LinkDataBufEntryToTail(unsigned int bufEntry, unsigned int listNo)
+{
+	P_DATA_BUF_LRU_LIST lruList;
+
+	lruList = &dataBufLruList[listNo];
+
+	dataBufMapPtr->dataBuf[bufEntry].list = listNo;
+	dataBufMapPtr->dataBuf[bufEntry].prevEntry = lruList->tailEntry;
+	dataBufMapPtr->dataBuf[bufEntry].nextEntry = DATA_BUF_NONE;
+	if(lruList->tailEntry != DATA_BUF_NONE)
+		dataBufMapPtr->dataBuf[lruList->tailEntry].nextEntry = bufEntry;
+	else
+		lruList->headEntry = bufEntry;
+	lruList->tailEntry = bufEntry;
+
+	lruList->entryCnt++;
+}
+
+static void RemoveDataBufGhost(unsigned int ghostEntry)
+{
+	P_DATA_BUF_LRU_LIST ghostList;
+
+	ghostList = &dataBufGhostMapPtr->ghostList[dataBufGhostMapPtr->ghost[ghostEntry].list];
+
+	if(dataBufGhostMapPtr->ghost[ghostEntry].prevEntry != DATA_BUF_NONE)
+		dataBufGhostMapPtr->ghost[dataBufGhostMapPtr->ghost[ghostEntry].prevEntry].nextEntry = dataBufGhostMapPtr->ghost[ghostEntry].nextEntry;
+	else
+		ghostList->headEntry = dataBufGhostMapPtr->ghost[ghostEntry].nextEntry;
+
+	if(dataBufGhostMapPtr->ghost[ghostEntry].nextEntry != DATA_BUF_NONE)
+		dataBufGhostMapPtr->ghost[dataBufGhostMapPtr->ghost[ghostEntry].nextEntry].prevEntry = dataBufGhostMapPtr->ghost[ghostEntry].prevEntry;
+	else
+		ghostList->tailEntry = dataBufGhostMapPtr->ghost[ghostEntry].prevEntry;
+
+	ghostList->entryCnt--;
+
+	RemoveHashTable(&dataBufGhostMapPtr->ghostHash, dataBufGhostMapPtr->ghost[ghostEntry].logicalSliceAddr);
+	dataBufGhostMapPtr->ghost[ghostEntry].logicalSliceAddr = LSA_NONE;
+	dataBufGhostMapPtr->ghost[ghostEntry].nextEntry = dataBufGhostMapPtr->freeEntry;
+	dataBufGhostMapPtr->freeEntry = ghostEntry;
+}
+
+static void AddDataBufGhost(unsigned int logicalSliceAddr, unsigned int listNo)
+{
+	P_DATA_BUF_LRU_LIST ghostList;
+	unsigned int ghostEntry;
+
+	if(logicalSliceAddr == LSA_NONE)
+		return;
+
+	//ARC keeps at most as many ghosts as entries, this only guards the directory bound
+	if(dataBufGhostMapPtr->freeEntry == DATA_BUF_NONE)
+	{
+		if(dataBufGhostMapPtr->ghostList[DATA_BUF_LIST_FREQUENCY].tailEntry != DATA_BUF_NONE)
+			RemoveDataBufGhost(dataBufGhostMapPtr->ghostList[DATA_BUF_LIST_FREQUENCY].tailEntry);
+		else
+			RemoveDataBufGhost(dataBufGhostMapPtr->ghostList[DATA_BUF_LIST_RECENCY].tailEntry);
+	}
+
+	ghostEntry = dataBufGhostMapPtr->freeEntry;
+	dataBufGhostMapPtr->freeEntry = dataBufGhostMapPtr->ghost[ghostEntry].nextEntry;
+
+	ghostList = &dataBufGhostMapPtr->ghostList[listNo];
+	dataBufGhostMapPtr->ghost[ghostEntry].logicalSliceAddr = logicalSliceAddr;
+	dataBufGhostMapPtr->ghost[ghostEntry].list = listNo;
+	dataBufGhostMapPtr->ghost[ghostEntry].prevEntry = DATA_BUF_NONE;
+	dataBufGhostMapPtr->ghost[ghostEntry].nextEntry = ghostList->headEntry;
+	if(ghostList->headEntry != DATA_BUF_NONE)
+		dataBufGhostMapPtr->ghost[ghostList->headEntry].prevEntry = ghostEntry;
+	else
+		ghostList->tailEntry = ghostEntry;
+	ghostList->headEntry = ghostEntry;
+	ghostList->entryCnt++;
+
+	InsertHashTable(&dataBufGhostMapPtr->ghostHash, logicalSliceAddr, ghostEntry);
+}
+
+//all entries are merged into the recency list, ghosts of the previous policy are forgotten
+unsigned int SetDataBufPolicy(unsigned int policyNo)
+{
+	unsigned int bufEntry;
+
+	if(policyNo >= DATA_BUF_POLICY_COUNT)
+		return 0;
+
+	while(dataBufLruList[DATA_BUF_LIST_FREQUENCY].tailEntry != DATA_BUF_NONE)
+	{
+		bufEntry = dataBufLruList[DATA_BUF_LIST_FREQUENCY].tailEntry;
+		UnlinkDataBufEntry(bufEntry);
+		LinkDataBufEntryToHead(bufEntry, DATA_BUF_LIST_RECENCY);
+	}
+	InitDataBufGhost();
+
+	dataBufPolicy = policyNo;
+	xil_printf("Data buffer policy: %s\r\n", dataBufPolicyName[dataBufPolicy]);
+
+	return 1;
+}
+
+unsigned int GetDataBufPolicy()
+{
+	return dataBufPolicy;
+}
+
+//list whose tail is replaced next when the slice to be buffered is not remembered by a ghost
+unsigned int GetDataBufVictimList()
+{
+	if(dataBufPolicy == DATA_BUF_POLICY_LRU)
+		return DATA_BUF_LIST_RECENCY;
+
+	if((dataBufLruList[DATA_BUF_LIST_RECENCY].entryCnt > dataBufGhostMapPtr->recencyTarget) || (dataBufLruList[DATA_BUF_LIST_FREQUENCY].entryCnt == 0))
+		return DATA_BUF_LIST_RECENCY;
+
+	return DATA_BUF_LIST_FREQUENCY;
+}
+
+unsigned int FindDataBufEntry(unsigned int logicalSliceAddr)
+{
+	return dataBufHashTablePtr->dataBufHash[ProbeHashTable(dataBufHashTablePtr, logicalSliceAddr)].bufEntry;
 }
 
 unsigned int CheckDataBufHit(unsigned int reqSlotTag)
 {
-	unsigned int bufEntry, logicalSliceAddr;
+	unsigned int bufEntry, listNo;
 
-	logicalSliceAddr = reqPoolPtr->reqPool[reqSlotTag].logicalSliceAddr;
-	bufEntry = dataBufHashTablePtr->dataBufHash[FindDataBufHashTableEntry(logicalSliceAddr)].headEntry;
+	bufEntry = FindDataBufEntry(reqPoolPtr->reqPool[reqSlotTag].logicalSliceAddr);
+	if(bufEntry == DATA_BUF_NONE)
+		return DATA_BUF_FAIL;
 
-	while(bufEntry != DATA_BUF_NONE)
+	//a slice referenced again becomes frequent under ARC
+	listNo = (dataBufPolicy == DATA_BUF_POLICY_ARC) ? DATA_BUF_LIST_FREQUENCY : DATA_BUF_LIST_RECENCY;
+	if(dataBufLruList[listNo].headEntry != bufEntry)
+	{
+		UnlinkDataBufEntry(bufEntry);
+		LinkDataBufEntryToHead(bufEntry, listNo);
+	}
+
+	return bufEntry;
+}
+
+//ARC of Megiddo and Modha on a buffer that is always full: entries without a slice wait at the tail of T1
+//and are used first, otherwise T1 or T2 gives up its tail depending on the adaptive target size of T1
+static unsigned int AllocateArcDataBuf(unsigned int logicalSliceAddr)
+{
+	P_DATA_BUF_LRU_LIST recencyList, recencyGhostList, frequencyGhostList;
+	unsigned int evictedEntry, ghostEntry, ghostListNo, victimListNo, targetListNo, delta, recordGhost;
+
+	recencyList = &dataBufLruList[DATA_BUF_LIST_RECENCY];
+	recencyGhostList = &dataBufGhostMapPtr->ghostList[DATA_BUF_LIST_RECENCY];
+	frequencyGhostList = &dataBufGhostMapPtr->ghostList[DATA_BUF_LIST_FREQUENCY];
+
+	ghostEntry = dataBufGhostMapPtr->ghostHash.dataBufHash[ProbeHashTable(&dataBufGhostMapPtr->ghostHash, logicalSliceAddr)].bufEntry;
+	ghostListNo = DATA_BUF_LIST_RECENCY;
+	targetListNo = DATA_BUF_LIST_RECENCY;
+	if(ghostEntry != DATA_BUF_NONE)
 	{
-		if(dataBufMapPtr->dataBuf[bufEntry].logicalSliceAddr == logicalSliceAddr)
+		//a ghost hit in B1 asks for a larger T1, a hit in B2 for a larger T2
+		ghostListNo = dataBufGhostMapPtr->ghost[ghostEntry].list;
+		if(ghostListNo == DATA_BUF_LIST_RECENCY)
 		{
-			if((dataBufMapPtr->dataBuf[bufEntry].nextEntry != DATA_BUF_NONE) && (dataBufMapPtr->dataBuf[bufEntry].prevEntry != DATA_BUF_NONE))
-			{
-				dataBufMapPtr->dataBuf[dataBufMapPtr->dataBuf[bufEntry].prevEntry].nextEntry = dataBufMapPtr->dataBuf[bufEntry].nextEntry;
-				dataBufMapPtr->dataBuf[dataBufMapPtr->dataBuf[bufEntry].nextEntry].prevEntry = dataBufMapPtr->dataBuf[bufEntry].prevEntry;
-			}
-			else if((dataBufMapPtr->dataBuf[bufEntry].nextEntry == DATA_BUF_NONE) && (dataBufMapPtr->dataBuf[bufEntry].prevEntry != DATA_BUF_NONE))
-			{
-				dataBufMapPtr->dataBuf[dataBufMapPtr->dataBuf[bufEntry].prevEntry].nextEntry = DATA_BUF_NONE;
-				dataBufLruList.tailEntry = dataBufMapPtr->dataBuf[bufEntry].prevEntry;
-			}
-			else if((dataBufMapPtr->dataBuf[bufEntry].nextEntry != DATA_BUF_NONE) && (dataBufMapPtr->dataBuf[bufEntry].prevEntry== DATA_BUF_NONE))
-			{
-				dataBufMapPtr->dataBuf[dataBufMapPtr->dataBuf[bufEntry].nextEntry].prevEntry  = DATA_BUF_NONE;
-				dataBufLruList.headEntry = dataBufMapPtr->dataBuf[bufEntry].nextEntry;
-			}
+			delta = (recencyGhostList->entryCnt >= frequencyGhostList->entryCnt) ? 1 : frequencyGhostList->entryCnt / recencyGhostList->entryCnt;
+			if(dataBufGhostMapPtr->recencyTarget + delta < AVAILABLE_DATA_BUFFER_ENTRY_COUNT)
+				dataBufGhostMapPtr->recencyTarget += delta;
 			else
-			{
-				dataBufLruList.tailEntry = DATA_BUF_NONE;
-				dataBufLruList.headEntry = DATA_BUF_NONE;
-			}
-
-			if(dataBufLruList.headEntry != DATA_BUF_NONE)
-			{
-				dataBufMapPtr->dataBuf[bufEntry].prevEntry = DATA_BUF_NONE;
-				dataBufMapPtr->dataBuf[bufEntry].nextEntry = dataBufLruList.headEntry;
-				dataBufMapPtr->dataBuf[dataBufLruList.headEntry].prevEntry = bufEntry;
-				dataBufLruList.headEntry = bufEntry;
-			}
+				dataBufGhostMapPtr->recencyTarget = AVAILABLE_DATA_BUFFER_ENTRY_COUNT;
+		}
+		else
+		{
+			delta = (frequencyGhostList->entryCnt >= recencyGhostList->entryCnt) ? 1 : recencyGhostList->entryCnt / frequencyGhostList->entryCnt;
+			if(dataBufGhostMapPtr->recencyTarget > delta)
+				dataBufGhostMapPtr->recencyTarget -= delta;
 			else
+				dataBufGhostMapPtr->recencyTarget = 0;
+		}
+
+		RemoveDataBufGhost(ghostEntry);
+		targetListNo = DATA_BUF_LIST_FREQUENCY;
+	}
+
+	evictedEntry = recencyList->tailEntry;
+	if((evictedEntry == DATA_BUF_NONE) || (dataBufMapPtr->dataBuf[evictedEntry].logicalSliceAddr != LSA_NONE))
+	{
+		recordGhost = 1;
+		victimListNo = GetDataBufVictimList();
+		if((ghostListNo == DATA_BUF_LIST_FREQUENCY) && (recencyList->entryCnt == dataBufGhostMapPtr->recencyTarget) && recencyList->entryCnt)
+			victimListNo = DATA_BUF_LIST_RECENCY;
+
+		//keep T1 + B1 within the entry count and all four lists within twice of it
+		if(ghostEntry == DATA_BUF_NONE)
+		{
+			if(recencyList->entryCnt + recencyGhostList->entryCnt >= AVAILABLE_DATA_BUFFER_ENTRY_COUNT)
 			{
-				dataBufMapPtr->dataBuf[bufEntry].prevEntry = DATA_BUF_NONE;
-				dataBufMapPtr->dataBuf[bufEntry].nextEntry = DATA_BUF_NONE;
-				dataBufLruList.headEntry = bufEntry;
-				dataBufLruList.tailEntry = bufEntry;
+				if(recencyGhostList->tailEntry != DATA_BUF_NONE)
+					RemoveDataBufGhost(recencyGhostList->tailEntry);
+				else
+				{
+					victimListNo = DATA_BUF_LIST_RECENCY;
+					recordGhost = 0;
+				}
 			}
-
-			return bufEntry;
+			else if((recencyGhostList->entryCnt + frequencyGhostList->entryCnt >= AVAILABLE_DATA_BUFFER_ENTRY_COUNT) && (frequencyGhostList->tailEntry != DATA_BUF_NONE))
+				RemoveDataBufGhost(frequencyGhostList->tailEntry);
 		}
-		else
-			bufEntry = dataBufMapPtr->dataBuf[bufEntry].hashNextEntry;
+
+		evictedEntry = dataBufLruList[victimListNo].tailEntry;
+		if(recordGhost)
+			AddDataBufGhost(dataBufMapPtr->dataBuf[evictedEntry].logicalSliceAddr, victimListNo);
 	}
 
-	return DATA_BUF_FAIL;
+	UnlinkDataBufEntry(evictedEntry);
+	LinkDataBufEntryToHead(evictedEntry, targetListNo);
+
+	return evictedEntry;
 }
 
-unsigned int AllocateDataBuf()
+//called before the valid blocks of a write are added, a write starting right behind valid data of this slice
+//or of the end of the previous slice continues a sequential write
+void UpdateDataBufSeqFill(unsigned int bufEntry, unsigned int nvmeBlockOffset)
 {
-	unsigned int evictedEntry = dataBufLruList.tailEntry;
+	unsigned int prevEntry;
+
+	if(nvmeBlockOffset)
+	{
+		dataBufMapPtr->dataBuf[bufEntry].seqFill = (dataBufMapPtr->dataBuf[bufEntry].blockValid >> (nvmeBlockOffset - 1)) & 1;
+		return;
+	}
+
+	dataBufMapPtr->dataBuf[bufEntry].seqFill = 0;
+	if(dataBufMapPtr->dataBuf[bufEntry].logicalSliceAddr == 0)
+		return;
 
-	if(evictedEntry == DATA_BUF_NONE)
-		assert(!"[WARNING] There is no valid buffer entry [WARNING]");
+	prevEntry = FindDataBufEntry(dataBufMapPtr->dataBuf[bufEntry].logicalSliceAddr - 1);
+	if(prevEntry != DATA_BUF_NONE)
+		dataBufMapPtr->dataBuf[bufEntry].seqFill = dataBufMapPtr->dataBuf[prevEntry].blockValid >> (NVME_BLOCKS_PER_SLICE - 1);
+}
+
+//an entry a sequential write is still filling is passed over once by the tail of the list,
+//so that the rest of the slice can arrive before it is programmed instead of costing a fill read now and a second program later
+static void DeferFillingDataBuf(unsigned int listNo)
+{
+	unsigned int bufEntry;
 
-	if(dataBufMapPtr->dataBuf[evictedEntry].prevEntry != DATA_BUF_NONE)
+	bufEntry = dataBufLruList[listNo].tailEntry;
+	while(bufEntry != DATA_BUF_NONE)
 	{
-		dataBufMapPtr->dataBuf[dataBufMapPtr->dataBuf[evictedEntry].prevEntry].nextEntry = DATA_BUF_NONE;
-		dataBufLruList.tailEntry = dataBufMapPtr->dataBuf[evictedEntry].prevEntry;
+		if((dataBufMapPtr->dataBuf[bufEntry].dirty != DATA_BUF_DIRTY) || (dataBufMapPtr->dataBuf[bufEntry].blockValid == DATA_BUF_BLOCK_VALID_ALL)
+				|| !dataBufMapPtr->dataBuf[bufEntry].seqFill || (dataBufLruList[listNo].headEntry == bufEntry))
+			return;
 
-		dataBufMapPtr->dataBuf[evictedEntry].prevEntry = DATA_BUF_NONE;
-		dataBufMapPtr->dataBuf[evictedEntry].nextEntry = dataBufLruList.headEntry;
-		dataBufMapPtr->dataBuf[dataBufLruList.headEntry].prevEntry = evictedEntry;
-		dataBufLruList.headEntry = evictedEntry;
+		dataBufMapPtr->dataBuf[bufEntry].seqFill = 0;
+		UnlinkDataBufEntry(bufEntry);
+		LinkDataBufEntryToHead(bufEntry, listNo);
 
+		bufEntry = dataBufLruList[listNo].tailEntry;
 	}
+}
+
+unsigned int AllocateDataBuf(unsigned int logicalSliceAddr)
+{
+	unsigned int evictedEntry, listNo;
+
+	for(listNo = 0; listNo < DATA_BUF_LIST_COUNT; listNo++)
+		DeferFillingDataBuf(listNo);
+
+	if(dataBufPolicy == DATA_BUF_POLICY_ARC)
+		evictedEntry = AllocateArcDataBuf(logicalSliceAddr);
 	else
 	{
-		dataBufMapPtr->dataBuf[evictedEntry].prevEntry = DATA_BUF_NONE;
-		dataBufMapPtr->dataBuf[evictedEntry].nextEntry = DATA_BUF_NONE;
-		dataBufLruList.headEntry = evictedEntry;
-		dataBufLruList.tailEntry = evictedEntry;
+		evictedEntry = dataBufLruList[DATA_BUF_LIST_RECENCY].tailEntry;
+		if(evictedEntry == DATA_BUF_NONE)
+			assert(!"[WARNING] There is no valid buffer entry [WARNING]");
+
+		UnlinkDataBufEntry(evictedEntry);
+		LinkDataBufEntryToHead(evictedEntry, DATA_BUF_LIST_RECENCY);
 	}
 
 	SelectiveGetFromDataBufHashList(evictedEntry);
+	dataBufMapPtr->dataBuf[evictedEntry].seqFill = 0;
 
 	return evictedEntry;
 }
 
+//forget the cached copy of a deallocated slice, the entry becomes the next one to be reused
+void DropDataBuf(unsigned int logicalSliceAddr)
+{
+	unsigned int bufEntry;
+
+	bufEntry = FindDataBufEntry(logicalSliceAddr);
+	if(bufEntry == DATA_BUF_NONE)
+		return;
+
+	SelectiveGetFromDataBufHashList(bufEntry);
+	dataBufMapPtr->dataBuf[bufEntry].logicalSliceAddr = LSA_NONE;
+	if(dataBufMapPtr->dataBuf[bufEntry].dirty == DATA_BUF_DIRTY)
+		dirtyDataBufCnt--;
+	dataBufMapPtr->dataBuf[bufEntry].dirty = DATA_BUF_CLEAN;
+
+	UnlinkDataBufEntry(bufEntry);
+	LinkDataBufEntryToTail(bufEntry, DATA_BUF_LIST_RECENCY);
+}
+
 
 void UpdateDataBufEntryInfoBlockingReq(unsigned int bufEntry, unsigned int reqSlotTag)
 {
@@ -184,10 +555,36 @@ void UpdateDataBufEntryInfoBlockingReq(unsigned int bufEntry, unsigned int reqSl
 	dataBufMapPtr->dataBuf[bufEntry].blockingReqTail = reqSlotTag;
 }
 
+//a fill read completed: the NAND copy in the fill buffer of its die supplies the blocks the host has not written
+void MergeDataBufEntry(unsigned int reqSlotTag)
+{
+	unsigned int bufEntry, dieNo, blockNo;
+
+	bufEntry = reqPoolPtr->reqPool[reqSlotTag].dataBufInfo.entry;
+	dieNo = Vsa2VdieTranslation(reqPoolPtr->reqPool[reqSlotTag].nandInfo.virtualSliceAddr);
+
+	for(blockNo = 0; blockNo < NVME_BLOCKS_PER_SLICE; blockNo++)
+		if(reqPoolPtr->reqPool[reqSlotTag].reqOpt.fillBlockMask & (1 << blockNo))
+			memcpy((void*)(DATA_BUFFER_BASE_ADDR + bufEntry * BYTES_PER_DATA_REGION_OF_SLICE + blockNo * BYTES_PER_NVME_BLOCK),
+					(void*)(FILL_DATA_BUFFER_BASE_ADDR + dieNo * BYTES_PER_DATA_REGION_OF_SLICE + blockNo * BYTES_PER_NVME_BLOCK), BYTES_PER_NVME_BLOCK);
+}
 
+
+//returns an idle entry of the die, DATA_BUF_NONE while all of them still have requests in flight
 unsigned int AllocateTempDataBuf(unsigned int dieNo)
 {
-	return dieNo;
+	unsigned int bufEntry, entryOffset;
+
+	for(entryOffset = 0; entryOffset < TEMPORARY_DATA_BUFFER_ENTRY_COUNT_PER_DIE; entryOffset++)
+	{
+		bufEntry = dieNo * TEMPORARY_DATA_BUFFER_ENTRY_COUNT_PER_DIE + tempDataBufMapPtr->nextEntry[dieNo];
+		tempDataBufMapPtr->nextEntry[dieNo] = (tempDataBufMapPtr->nextEntry[dieNo] + 1) % TEMPORARY_DATA_BUFFER_ENTRY_COUNT_PER_DIE;
+
+		if(tempDataBufMapPtr->tempDataBuf[bufEntry].blockingReqTail == REQ_SLOT_TAG_NONE)
+			return bufEntry;
+	}
+
+	return DATA_BUF_NONE;
 }
 
 
@@ -205,60 +602,14 @@ void UpdateTempDataBufEntryInfoBlockingReq(unsigned int bufEntry, unsigned int r
 
 void PutToDataBufHashList(unsigned int bufEntry)
 {
-	unsigned int hashEntry;
-
-	hashEntry = FindDataBufHashTableEntry(dataBufMapPtr->dataBuf[bufEntry].logicalSliceAddr);
-
-	if(dataBufHashTablePtr->dataBufHash[hashEntry].tailEntry != DATA_BUF_NONE)
-	{
-		dataBufMapPtr->dataBuf[bufEntry].hashPrevEntry = dataBufHashTablePtr->dataBufHash[hashEntry].tailEntry ;
-		dataBufMapPtr->dataBuf[bufEntry].hashNextEntry = REQ_SLOT_TAG_NONE;
-		dataBufMapPtr->dataBuf[dataBufHashTablePtr->dataBufHash[hashEntry].tailEntry].hashNextEntry = bufEntry;
-		dataBufHashTablePtr->dataBufHash[hashEntry].tailEntry = bufEntry;
-	}
-	else
-	{
-		dataBufMapPtr->dataBuf[bufEntry].hashPrevEntry = REQ_SLOT_TAG_NONE;
-		dataBufMapPtr->dataBuf[bufEntry].hashNextEntry = REQ_SLOT_TAG_NONE;
-		dataBufHashTablePtr->dataBufHash[hashEntry].headEntry = bufEntry;
-		dataBufHashTablePtr->dataBufHash[hashEntry].tailEntry = bufEntry;
-	}
+	InsertHashTable(dataBufHashTablePtr, dataBufMapPtr->dataBuf[bufEntry].logicalSliceAddr, bufEntry);
 }
 
 
 void SelectiveGetFromDataBufHashList(unsigned int bufEntry)
 {
-	if(dataBufMapPtr->dataBuf[bufEntry].logicalSliceAddr != LSA_NONE)
-	{
-		unsigned int prevBufEntry, nextBufEntry, hashEntry;
+	if(dataBufMapPtr->dataBuf[bufEntry].logicalSliceAddr == LSA_NONE)
+		return;
 
-		prevBufEntry =  dataBufMapPtr->dataBuf[bufEntry].hashPrevEntry;
-		nextBufEntry =  dataBufMapPtr->dataBuf[bufEntry].hashNextEntry;
-		hashEntry = FindDataBufHashTableEntry(dataBufMapPtr->dataBuf[bufEntry].logicalSliceAddr);
-
-		if((nextBufEntry != DATA_BUF_NONE) && (prevBufEntry != DATA_BUF_NONE))
-		{
-			dataBufMapPtr->dataBuf[prevBufEntry].hashNextEntry = nextBufEntry;
-			dataBufMapPtr->dataBuf[nextBufEntry].hashPrevEntry = prevBufEntry;
-		}
-		else if((nextBufEntry == DATA_BUF_NONE) && (prevBufEntry != DATA_BUF_NONE))
-		{
-			dataBufMapPtr->dataBuf[prevBufEntry].hashNextEntry = DATA_BUF_NONE;
-			dataBufHashTablePtr->dataBufHash[hashEntry].tailEntry = prevBufEntry;
-		}
-		else if((nextBufEntry != DATA_BUF_NONE) && (prevBufEntry == DATA_BUF_NONE))
-		{
-			dataBufMapPtr->dataBuf[nextBufEntry].hashPrevEntry = DATA_BUF_NONE;
-			dataBufHashTablePtr->dataBufHash[hashEntry].headEntry = nextBufEntry;
-		}
-		else
-		{
-			dataBufHashTablePtr->dataBufHash[hashEntry].headEntry = DATA_BUF_NONE;
-			dataBufHashTablePtr->dataBufHash[hashEntry].tailEntry = DATA_BUF_NONE;
-		}
-	}
+	RemoveHashTable(dataBufHashTablePtr, dataBufMapPtr->dataBuf[bufEntry].logicalSliceAddr);
 }
-
-
-
-
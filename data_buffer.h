@@ -30,7 +30,7 @@
 // Module Name: Data Buffer Manager
 // File Name: data_buffer.h
 //
-// Version: v1.0.0
+// Version: v1.5.0
 //
 // Description:
 //   - define parameters, data structure and functions of data buffer manager
@@ -39,6 +39,23 @@
 //////////////////////////////////////////////////////////////////////////////////
 // Revision History:
 //
+// * v1.5.0
+//   - entries a sequential write is filling are marked (seqFill) and replaced late
+//
+// * v1.4.0
+//   - NVMe blocks written by the host are tracked per entry, partial writes no longer read the slice first
+//
+// * v1.3.0
+//   - replacement policies are selected at runtime, ARC keeps recency and frequency lists with ghosts
+//
+// * v1.2.0
+//   - buffered slices are indexed by an open-addressing hash table kept apart from the LRU list
+//
+// * v1.1.0
+//   - each die owns TEMPORARY_DATA_BUFFER_ENTRY_COUNT_PER_DIE temporary buffer entries
+//   - DropDataBuf for deallocated slices
+//   - dirty entries are counted in dirtyDataBufCnt
+//
 // * v1.0.0
 //   - First draft
 //////////////////////////////////////////////////////////////////////////////////
@@ -50,14 +67,35 @@
 #include "ftl_config.h"
 
 #define AVAILABLE_DATA_BUFFER_ENTRY_COUNT				(16 * USER_DIES)
-#define AVAILABLE_TEMPORARY_DATA_BUFFER_ENTRY_COUNT		(USER_DIES)
+#define TEMPORARY_DATA_BUFFER_ENTRY_COUNT_PER_DIE		8	//GC copies in flight per die
+#define AVAILABLE_TEMPORARY_DATA_BUFFER_ENTRY_COUNT		(TEMPORARY_DATA_BUFFER_ENTRY_COUNT_PER_DIE * USER_DIES)
 
 #define DATA_BUF_NONE	0xffff
 #define DATA_BUF_FAIL	0xffff
 #define DATA_BUF_DIRTY	1
 #define DATA_BUF_CLEAN	0
 
-#define FindDataBufHashTableEntry(logicalSliceAddr) ((logicalSliceAddr) % AVAILABLE_DATA_BUFFER_ENTRY_COUNT)
+#define DATA_BUF_BLOCK_VALID_ALL	((1 << NVME_BLOCKS_PER_SLICE) - 1)
+
+#define DATA_BUF_POLICY_LRU			0	//least recently used entry is replaced
+#define DATA_BUF_POLICY_ARC			1	//Adaptive Replacement Cache, slices seen once cannot flush slices seen again
+#define DATA_BUF_POLICY_COUNT		2
+
+#define DATA_BUF_POLICY_DEFAULT		DATA_BUF_POLICY_LRU
+
+#define DATA_BUF_LIST_RECENCY		0	//the LRU list, or T1/B1 of ARC: slices referenced once
+#define DATA_BUF_LIST_FREQUENCY		1	//T2/B2 of ARC: slices referenced again while cached or remembered
+#define DATA_BUF_LIST_COUNT			2
+
+//power of two with at least four times as many slots as entries, linear probing stays short
+#define DATA_BUF_HASH_TABLE_BITS	((AVAILABLE_DATA_BUFFER_ENTRY_COUNT <= 64) ? 8 : (AVAILABLE_DATA_BUFFER_ENTRY_COUNT <= 128) ? 9 : \
+									(AVAILABLE_DATA_BUFFER_ENTRY_COUNT <= 256) ? 10 : (AVAILABLE_DATA_BUFFER_ENTRY_COUNT <= 512) ? 11 : \
+									(AVAILABLE_DATA_BUFFER_ENTRY_COUNT <= 1024) ? 12 : 13)
+#define DATA_BUF_HASH_TABLE_SIZE	(1 << DATA_BUF_HASH_TABLE_BITS)
+#define DATA_BUF_HASH_TABLE_MASK	(DATA_BUF_HASH_TABLE_SIZE - 1)
+#define DATA_BUF_HASH_MULTIPLIER	0x9E3779B1	//Fibonacci hashing, spreads consecutive slices
+
+#define FindDataBufHashTableEntry(logicalSliceAddr) ((unsigned int)((logicalSliceAddr) * DATA_BUF_HASH_MULTIPLIER) >> (32 - DATA_BUF_HASH_TABLE_BITS))
 
 
 typedef struct _DATA_BUF_ENTRY {
@@ -65,10 +103,11 @@ typedef struct _DATA_BUF_ENTRY {
 	unsigned int prevEntry : 16;
 	unsigned int nextEntry : 16;
 	unsigned int blockingReqTail : 16;
-	unsigned int hashPrevEntry : 16;
-	unsigned int hashNextEntry : 16;
 	unsigned int dirty : 1;
-	unsigned int reserved0 : 15;
+	unsigned int list : 1;
+	unsigned int blockValid : NVME_BLOCKS_PER_SLICE;	//NVMe blocks holding the data of the slice, the rest is read at write-back
+	unsigned int seqFill : 1;	//a sequential write is filling the slice, it is passed over once for replacement
+	unsigned int reserved0 : 13 - NVME_BLOCKS_PER_SLICE;
 } DATA_BUF_ENTRY, *P_DATA_BUF_ENTRY;
 
 typedef struct _DATA_BUF_MAP{
@@ -78,18 +117,39 @@ typedef struct _DATA_BUF_MAP{
 typedef struct _DATA_BUF_LRU_LIST {
 	unsigned int headEntry : 16;
 	unsigned int tailEntry : 16;
+	unsigned int entryCnt : 16;
+	unsigned int reserved0 : 16;
 } DATA_BUF_LRU_LIST, *P_DATA_BUF_LRU_LIST;
 
+//8-byte slots, eight of them share a cache line, a slot is empty when logicalSliceAddr is LSA_NONE
 typedef struct _DATA_BUF_HASH_ENTRY{
-	unsigned int headEntry : 16;
-	unsigned int tailEntry : 16;
+	unsigned int logicalSliceAddr;
+	unsigned int bufEntry : 16;
+	unsigned int reserved0 : 16;
 } DATA_BUF_HASH_ENTRY, *P_DATA_BUF_HASH_ENTRY;
 
 
 typedef struct _DATA_BUF_HASH_TABLE{
-	DATA_BUF_HASH_ENTRY dataBufHash[AVAILABLE_DATA_BUFFER_ENTRY_COUNT];
+	DATA_BUF_HASH_ENTRY dataBufHash[DATA_BUF_HASH_TABLE_SIZE];
 } DATA_BUF_HASH_TABLE, *P_DATA_BUF_HASH_TABLE;
 
+//slices recently replaced by ARC, remembered without data
+typedef struct _DATA_BUF_GHOST_ENTRY {
+	unsigned int logicalSliceAddr;
+	unsigned int prevEntry : 16;
+	unsigned int nextEntry : 16;
+	unsigned int list : 1;
+	unsigned int reserved0 : 31;
+} DATA_BUF_GHOST_ENTRY, *P_DATA_BUF_GHOST_ENTRY;
+
+typedef struct _DATA_BUF_GHOST_MAP {
+	DATA_BUF_GHOST_ENTRY ghost[AVAILABLE_DATA_BUFFER_ENTRY_COUNT];
+	DATA_BUF_HASH_TABLE ghostHash;						//ghost entries by logicalSliceAddr
+	DATA_BUF_LRU_LIST ghostList[DATA_BUF_LIST_COUNT];	//B1 and B2
+	unsigned int freeEntry : 16;						//unused ghost entries, linked by nextEntry
+	unsigned int recencyTarget : 16;					//adaptive target size of T1 (p of ARC)
+} DATA_BUF_GHOST_MAP, *P_DATA_BUF_GHOST_MAP;
+
 
 typedef struct _TEMPORARY_DATA_BUF_ENTRY {
 	unsigned int blockingReqTail : 16;
@@ -98,12 +158,17 @@ typedef struct _TEMPORARY_DATA_BUF_ENTRY {
 
 typedef struct _TEMPORARY_DATA_BUF_MAP{
 	TEMPORARY_DATA_BUF_ENTRY tempDataBuf[AVAILABLE_TEMPORARY_DATA_BUFFER_ENTRY_COUNT];
+	unsigned char nextEntry[USER_DIES];	//round-robin position in the entries of each die
 } TEMPORARY_DATA_BUF_MAP, *P_TEMPORARY_DATA_BUF_MAP;
 
 void InitDataBuf();
+unsigned int FindDataBufEntry(unsigned int logicalSliceAddr);
 unsigned int CheckDataBufHit(unsigned int reqSlotTag);
-unsigned int AllocateDataBuf();
+unsigned int AllocateDataBuf(unsigned int logicalSliceAddr);
+void DropDataBuf(unsigned int logicalSliceAddr);
 void UpdateDataBufEntryInfoBlockingReq(unsigned int bufEntry, unsigned int reqSlotTag);
+void MergeDataBufEntry(unsigned int reqSlotTag);
+void UpdateDataBufSeqFill(unsigned int bufEntry, unsigned int nvmeBlockOffset);
 
 unsigned int AllocateTempDataBuf(unsigned int dieNo);
 void UpdateTempDataBufEntryInfoBlockingReq(unsigned int bufEntry, unsigned int reqSlotTag);
@@ -111,9 +176,16 @@ void UpdateTempDataBufEntryInfoBlockingReq(unsigned int bufEntry, unsigned int r
 void PutToDataBufHashList(unsigned int bufEntry);
 void SelectiveGetFromDataBufHashList(unsigned int bufEntry);
 
+unsigned int SetDataBufPolicy(unsigned int policyNo);
+unsigned int GetDataBufPolicy();
+unsigned int GetDataBufVictimList();
+
 extern P_DATA_BUF_MAP dataBufMapPtr;
-extern DATA_BUF_LRU_LIST dataBufLruList;
-extern P_DATA_BUF_HASH_TABLE dataBufHashTable;
+extern DATA_BUF_LRU_LIST dataBufLruList[DATA_BUF_LIST_COUNT];
+extern unsigned int dirtyDataBufCnt;
+extern P_DATA_BUF_HASH_TABLE dataBufHashTablePtr;
+extern P_DATA_BUF_GHOST_MAP dataBufGhostMapPtr;
 extern P_TEMPORARY_DATA_BUF_MAP tempDataBufMapPtr;
+extern const char* const dataBufPolicyName[DATA_BUF_POLICY_COUNT];
 
 #endif /* DATA_BUFFER_H_ */
@@ -66,8 +66,12 @@ void InitFTL()
 	InitDependencyTable();
 	InitReqScheduler();
 	InitNandArray();
+	InitCheckpoint();
+	InitWearLeveling();
+	InitWriteTemperature();
 	InitAddressMap();
 	InitDataBuf();
+	InitWriteBack();
 	InitGcVictimMap();
 
 	storageCapacity_L = (MB_PER_SSD - (MB_PER_MIN_FREE_BLOCK_SPACE + mbPerbadBlockSpace + MB_PER_OVER_PROVISION_BLOCK_SPACE)) * ((1024*1024) / BYTES_PER_NVME_BLOCK);
@@ -198,9 +202,18 @@ void CheckConfigRestriction()
 		assert(!"[WARNING] Configuration Error: BLOCK [WARNING]");
 	if((BITS_PER_FLASH_CELL != SLC_MODE))
 		assert(!"[WARNING] Configuration Error: BIT_PER_FLASH_CELL [WARNING]");
+	if(PlsbPage2VpageTranslation(START_PAGE_NO_OF_CHECKPOINT_BLOCK) + CHECKPOINT_PAGES_PER_DIE > USER_PAGES_PER_BLOCK)
+		assert(!"[WARNING] Configuration Error: Checkpoint does not fit in a slot block [WARNING]");
+	if(NAND_SUSPEND_SCAN_DEPTH > NAND_OVERTAKE_SCAN_DEPTH)
+		assert(!"[WARNING] Configuration Error: Suspend scan is deeper than the overtake scan [WARNING]");
+	if(WRITE_TEMPERATURE_MAX > LSA_TEMPERATURE_MAX)
+		assert(!"[WARNING] Configuration Error: Write temperature is hotter than the hottest write stream [WARNING]");
 
 	if(RESERVED_DATA_BUFFER_BASE_ADDR + 0x00200000 > COMPLETE_FLAG_TABLE_ADDR)
 		assert(!"[WARNING] Configuration Error: Data buffer size is too large to be allocated to predefined range [WARNING]");
+	if(RESERVED_DATA_BUFFER_BASE_ADDR + USER_DIES * (USED_PAGES_FOR_BAD_BLOCK_TABLE_PER_DIE * (BYTES_PER_DATA_REGION_OF_PAGE + BYTES_PER_SPARE_REGION_OF_PAGE)
+			+ 2 * BAD_BLOCK_SCAN_DEPTH * BYTES_PER_NAND_ROW) > COMPLETE_FLAG_TABLE_ADDR)
+		assert(!"[WARNING] Configuration Error: Bad block scan buffers are too large to be allocated to predefined range [WARNING]");
 	if(TEMPORARY_PAY_LOAD_ADDR + 0x00001000 > DATA_BUFFER_MAP_ADDR)
 		assert(!"[WARNING] Configuration Error: Metadata for NAND request completion process is too large to be allocated to predefined range [WARNING]");
 	if(FTL_MANAGEMENT_END_ADDR > DRAM_END_ADDR)
@@ -148,6 +148,7 @@
 #define	MAIN_ROWS_PER_MLC_LUN		(ROWS_PER_MLC_BLOCK * MAIN_BLOCKS_PER_LUN)
 
 #define	LUNS_PER_DIE				1
+#define	PLANES_PER_DIE				2		//the plane of a block is its block address modulo the plane count
 
 #define	MAIN_BLOCKS_PER_DIE			(MAIN_BLOCKS_PER_LUN * LUNS_PER_DIE)
 #define TOTAL_BLOCKS_PER_DIE		(TOTAL_BLOCKS_PER_LUN * LUNS_PER_DIE)
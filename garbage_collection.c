@@ -30,11 +30,15 @@
 // Module Name: Garbage Collector
 // File Name: garbage_collection.c
 //
-// Version: v1.0.0
+// Version: v1.4.3
 //
 // Description:
 //   - GameGC & Cost-Benefit GC integrated version
-//   - select a victim block
+//   - ORIGINAL, GAME, CB and CBGAME policies are linked together and one of
+//     them is active at a time (SetGcPolicy, NVMe Set Features 0xC0)
+//   - select a victim block; victim lists are indexed by invalid slice count
+//     and erase-age epoch, so greedy and cost-benefit selection look at one
+//     candidate per age bucket
 //   - collect valid pages to a free block
 //   - erase a victim block to make a free block
 //////////////////////////////////////////////////////////////////////////////////
@@ -42,1087 +46,784 @@
 //////////////////////////////////////////////////////////////////////////////////
 // Revision History:
 //
+// * v1.4.3
+//   - a die down to GC_TRIGGER_URGENT has whole victims collected by incremental policies
+//   - foreground GC collects victims until a host block can be taken
+//
+// * v1.4.2
+//   - GC_POLICY drops the unused Collect entry, foreground GC of every policy collects a whole victim
+//
+// * v1.4.1
+//   - a victim is not erased while copies of it programmed to other dies are outstanding
+//
+// * v1.4.0
+//   - a block of cold data picked by the wear leveler is collected before the victim of the policy
+//
+// * v1.3.2
+//   - a GC copy takes the next write sequence of the map checkpoint
+//   - blocks with invalid slices restored from a checkpoint are listed as victims at initialization
+//
+// * v1.3.1
+//   - a die down to GC_TRIGGER_CRITICAL takes an incremental step on every GcScheduler call
+//
+// * v1.3.0
+//   - incremental GC copies are paced by a per-die token bucket: a host write earns the copies that keep
+//     free blocks level, scaled up as they fall towards GC_TRIGGER_CRITICAL, and a die without queued
+//     host requests collects at full speed
+//   - a blocking policy starts a victim only while the bucket of its die is not in debt
+//
+// * v1.2.1
+//   - a victim that is the open block of the other plane of a write stream is closed as well
+//
+// * v1.2.0
+//   - constant-time cost-benefit victim selection with age-bucketed lists
+//   - GC copies are pipelined over a per-die pool of temporary buffers
+//   - GC copies can be programmed to the least-loaded die (SetGcCopyTarget)
+//   - GC copies cool the LSA down and go to the matching write stream
+//
+// * v1.1.0
+//   - compile-time GC selection is replaced by the GC_POLICY table
+//   - GC copy requests set reqOpt and chain on the temporary buffer
+//
 // * v1.0.0
 //   - First draft
 //////////////////////////////////////////////////////////////////////////////////
 
-// #define ORIGINAL_GC // wdy: original GC 활성화
-// #define ORIGINAL_GC // wdy: GAME GC 활성화
-#define CB_GC // wdy: Cost_Benefit GC 활성화
-//#define CBGAME_GC // wdy: Cost_Benefit + GAME GC 활성화
-
-#if defined(ORIGINAL_GC)
 
 #include "xil_printf.h"
 #include <assert.h>
 #include "memory_map.h"
 
 P_GC_VICTIM_MAP gcVictimMapPtr;
+unsigned int gcTriggered;
+unsigned int copyCnt;
 
-static int gcActive[USER_DIES] = {0};
-static const unsigned int GC_LOW  = 512;
-static const unsigned int GC_HIGH = 612;
+static INCREMENTAL_GC_CONTEXT gcCtx[USER_DIES];
+static unsigned char gcActive[USER_DIES];
+static unsigned int gcSchedTick;
 
-// ===============================
-// ORIGINAL GC SCHEDULER
-// ===============================
-void CheckAndRunOriginalGc(void)
-{
-    for (int die = 0; die < USER_DIES; die++)
-    {
-        unsigned int freeCnt = virtualDieMapPtr->die[die].freeBlockCnt;
-
-        // GC 시작 조건
-        if (!gcActive[die] && freeCnt <= GC_LOW)
-        {
-            gcActive[die] = 1;
-            xil_printf("[ORIG_GC][ON ] Die %d GC ON  (free=%u)\r\n", die, freeCnt);
-        }
-
-        // GC 종료 조건
-        if (gcActive[die] && freeCnt >= GC_HIGH)
-        {
-            gcActive[die] = 0;
-            xil_printf("[ORIG_GC][OFF] Die %d GC OFF (free=%u)\r\n", die, freeCnt);
-        }
-
-        // GC 활성 구간에서 계속 수행
-        if (gcActive[die])
-            GarbageCollection(die);
-    }
-}
+//CB age is counted in invalidation events since the last erase of a block
+static unsigned int gcActivityTick;
+static unsigned int gcAgeEpoch;
+static unsigned int gcLastEraseTick[USER_DIES][USER_BLOCKS_PER_DIE];
+
+static const GC_POLICY* gcPolicy;
+static unsigned int gcCopyTarget;
+
+static unsigned int GreedySelectVictim(unsigned int dieNo);
+static unsigned int CostBenefitSelectVictim(unsigned int dieNo);
+static void RefillIdleGcCopyTokens(unsigned int dieNo);
+static void BlockingGcSchedule();
+static void IncrementalGcSchedule();
+static unsigned int StartVictim(unsigned int dieNo);
+static unsigned int CopyValidSlices(unsigned int dieNo, unsigned int* copyBudget);
+static void EraseVictimBlock(unsigned int dieNo);
+static unsigned int CollectVictimBlock(unsigned int dieNo);
+static void IncrementalGcStep(unsigned int dieNo);
+
+const GC_POLICY gcPolicyTable[GC_POLICY_COUNT] = {
+	{"ORIGINAL", GreedySelectVictim, BlockingGcSchedule},
+	{"GAME", GreedySelectVictim, IncrementalGcSchedule},
+	{"CB", CostBenefitSelectVictim, BlockingGcSchedule},
+	{"CBGAME", CostBenefitSelectVictim, IncrementalGcSchedule}
+};
 
-// ===============================
-// GC 초기화
-// ===============================
 void InitGcVictimMap()
 {
-    int dieNo, invalidSliceCnt;
-
-    gcVictimMapPtr = (P_GC_VICTIM_MAP) GC_VICTIM_MAP_ADDR;
-
-    for (dieNo = 0; dieNo < USER_DIES; dieNo++)
-    {
-        for (invalidSliceCnt = 0; invalidSliceCnt < SLICES_PER_BLOCK + 1; invalidSliceCnt++)
-        {
-            gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].headBlock = BLOCK_NONE;
-            gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].tailBlock = BLOCK_NONE;
-        }
-    }
-    xil_printf("[ORIG_GC] Init victim map completed\r\n");
+	int dieNo, invalidSliceCnt, blockNo, bucketNo, wordNo;
+
+	gcVictimMapPtr = (P_GC_VICTIM_MAP) GC_VICTIM_MAP_ADDR;
+
+	for(dieNo=0 ; dieNo<USER_DIES; dieNo++)
+	{
+		for(invalidSliceCnt=0 ; invalidSliceCnt<SLICES_PER_BLOCK+1; invalidSliceCnt++)
+			for(bucketNo=0 ; bucketNo<GC_AGE_BUCKETS; bucketNo++)
+			{
+				gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt][bucketNo].headBlock = BLOCK_NONE;
+				gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt][bucketNo].tailBlock = BLOCK_NONE;
+			}
+
+		for(bucketNo=0 ; bucketNo<GC_AGE_BUCKETS; bucketNo++)
+			for(wordNo=0 ; wordNo<GC_INVALID_BITMAP_WORDS; wordNo++)
+				gcVictimMapPtr->invalidBitmap[dieNo][bucketNo][wordNo] = 0;
+
+		gcCtx[dieNo].state = GC_STATE_IDLE;
+		gcCtx[dieNo].victimBlock = BLOCK_NONE;
+		gcCtx[dieNo].curPage = 0;
+		gcCtx[dieNo].copyTokens = 0;
+		gcCtx[dieNo].pendingCopyProgCnt = 0;
+		gcCtx[dieNo].active = 0;
+		gcActive[dieNo] = 0;
+
+		for(blockNo=0 ; blockNo<USER_BLOCKS_PER_DIE; blockNo++)
+			gcLastEraseTick[dieNo][blockNo] = 0;
+	}
+
+	gcActivityTick = 0;
+	gcAgeEpoch = 0;
+	gcSchedTick = 0;
+	gcPolicy = &gcPolicyTable[GC_POLICY_DEFAULT];
+	gcCopyTarget = GC_COPY_TARGET_VICTIM_DIE;
+
+	//blocks restored from a checkpoint
+	for(dieNo=0 ; dieNo<USER_DIES; dieNo++)
+		for(blockNo=0 ; blockNo<USER_BLOCKS_PER_DIE; blockNo++)
+			if(!virtualBlockMapPtr->block[dieNo][blockNo].bad && !virtualBlockMapPtr->block[dieNo][blockNo].free && virtualBlockMapPtr->block[dieNo][blockNo].invalidSliceCnt)
+				PutToGcVictimList(dieNo, blockNo, virtualBlockMapPtr->block[dieNo][blockNo].invalidSliceCnt);
 }
 
-// ===============================
-// ORIGINAL GC CORE
-// ===============================
-void GarbageCollection(unsigned int dieNo)
+//every policy works on the same victim lists and per-die context, so switching is safe at any point
+unsigned int SetGcPolicy(unsigned int policyNo)
 {
-    unsigned int victimBlockNo, pageNo, virtualSliceAddr, logicalSliceAddr, reqSlotTag;
-
-    victimBlockNo = GetFromGcVictimList(dieNo);
-
-    if (victimBlockNo == BLOCK_FAIL || victimBlockNo == BLOCK_NONE)
-    {
-        xil_printf("[ORIG_GC][WARN] Die %d No victim block available\n", dieNo);
-        return;
-    }
-
-    xil_printf("[ORIG_GC][VICTIM] Die %d Victim Block = %u (invalid=%u)\r\n",
-               dieNo,
-               victimBlockNo,
-               virtualBlockMapPtr->block[dieNo][victimBlockNo].invalidSliceCnt);
-
-    // -------------------------------
-    // Copy valid pages
-    // -------------------------------
-    if (virtualBlockMapPtr->block[dieNo][victimBlockNo].invalidSliceCnt != SLICES_PER_BLOCK)
-    {
-        for (pageNo = 0; pageNo < USER_PAGES_PER_BLOCK; pageNo++)
-        {
-            virtualSliceAddr = Vorg2VsaTranslation(dieNo, victimBlockNo, pageNo);
-            logicalSliceAddr = virtualSliceMapPtr->virtualSlice[virtualSliceAddr].logicalSliceAddr;
-
-            // valid page
-            if (logicalSliceAddr != LSA_NONE &&
-                logicalSliceMapPtr->logicalSlice[logicalSliceAddr].virtualSliceAddr == virtualSliceAddr)
-            {
-                xil_printf("[ORIG_GC][COPY] Die %d Page %u -> new location (LSA=%u)\r\n",
-                           dieNo, pageNo, logicalSliceAddr);
-
-                // READ
-                reqSlotTag = GetFromFreeReqQ();
-                reqPoolPtr->reqPool[reqSlotTag].reqType = REQ_TYPE_NAND;
-                reqPoolPtr->reqPool[reqSlotTag].reqCode = REQ_CODE_READ;
-                reqPoolPtr->reqPool[reqSlotTag].logicalSliceAddr = logicalSliceAddr;
-                reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufFormat = REQ_OPT_DATA_BUF_TEMP_ENTRY;
-                reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandAddr = REQ_OPT_NAND_ADDR_VSA;
-                reqPoolPtr->reqPool[reqSlotTag].dataBufInfo.entry = AllocateTempDataBuf(dieNo);
-                reqPoolPtr->reqPool[reqSlotTag].nandInfo.virtualSliceAddr = virtualSliceAddr;
-                SelectLowLevelReqQ(reqSlotTag);
-
-                // WRITE
-                reqSlotTag = GetFromFreeReqQ();
-                reqPoolPtr->reqPool[reqSlotTag].reqType = REQ_TYPE_NAND;
-                reqPoolPtr->reqPool[reqSlotTag].reqCode = REQ_CODE_WRITE;
-                reqPoolPtr->reqPool[reqSlotTag].logicalSliceAddr = logicalSliceAddr;
-                reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufFormat = REQ_OPT_DATA_BUF_TEMP_ENTRY;
-                reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandAddr = REQ_OPT_NAND_ADDR_VSA;
-                reqPoolPtr->reqPool[reqSlotTag].dataBufInfo.entry = AllocateTempDataBuf(dieNo);
-
-                unsigned int newVsa = FindFreeVirtualSliceForGc(dieNo, victimBlockNo);
-                reqPoolPtr->reqPool[reqSlotTag].nandInfo.virtualSliceAddr = newVsa;
-                SelectLowLevelReqQ(reqSlotTag);
-
-                // Update mapping
-                logicalSliceMapPtr->logicalSlice[logicalSliceAddr].virtualSliceAddr = newVsa;
-                virtualSliceMapPtr->virtualSlice[newVsa].logicalSliceAddr = logicalSliceAddr;
-            }
-        }
-    }
-
-    // -------------------------------
-    // ERASE VICTIM BLOCK
-    // -------------------------------
-    xil_printf("[ORIG_GC][ERASE] Die %d Block %u erased\r\n", dieNo, victimBlockNo);
-    EraseBlock(dieNo, victimBlockNo);
+	if(policyNo >= GC_POLICY_COUNT)
+		return 0;
+
+	gcPolicy = &gcPolicyTable[policyNo];
+	xil_printf("GC policy: %s\r\n", gcPolicy->name);
+
+	return 1;
 }
 
-// ===============================
-// Victim list functions
-// ===============================
-void PutToGcVictimList(unsigned int dieNo, unsigned int blockNo, unsigned int invalidSliceCnt)
+unsigned int GetGcPolicy()
 {
-    if (gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].tailBlock != BLOCK_NONE)
-    {
-        virtualBlockMapPtr->block[dieNo][blockNo].prevBlock =
-            gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].tailBlock;
-        virtualBlockMapPtr->block[dieNo][blockNo].nextBlock = BLOCK_NONE;
-        virtualBlockMapPtr->block[dieNo]
-            [gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].tailBlock].nextBlock = blockNo;
-        gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].tailBlock = blockNo;
-    }
-    else
-    {
-        virtualBlockMapPtr->block[dieNo][blockNo].prevBlock = BLOCK_NONE;
-        virtualBlockMapPtr->block[dieNo][blockNo].nextBlock = BLOCK_NONE;
-        gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].headBlock = blockNo;
-        gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].tailBlock = blockNo;
-    }
+	return (unsigned int)(gcPolicy - gcPolicyTable);
 }
 
-unsigned int GetFromGcVictimList(unsigned int dieNo)
+void SetGcCopyTarget(unsigned int copyTarget)
 {
-    unsigned int evictedBlockNo;
-    int invalidSliceCnt;
-
-    for (invalidSliceCnt = SLICES_PER_BLOCK; invalidSliceCnt > 0; invalidSliceCnt--)
-    {
-        if (gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].headBlock != BLOCK_NONE)
-        {
-            evictedBlockNo = gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].headBlock;
-
-            xil_printf("[ORIG_GC][SELECT] Die %d pick invalidCnt=%d block=%u\r\n",
-                       dieNo, invalidSliceCnt, evictedBlockNo);
-
-            // remove node
-            if (virtualBlockMapPtr->block[dieNo][evictedBlockNo].nextBlock != BLOCK_NONE)
-            {
-                virtualBlockMapPtr->block[dieNo]
-                    [virtualBlockMapPtr->block[dieNo][evictedBlockNo].nextBlock].prevBlock = BLOCK_NONE;
-
-                gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].headBlock =
-                    virtualBlockMapPtr->block[dieNo][evictedBlockNo].nextBlock;
-            }
-            else
-            {
-                gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].headBlock = BLOCK_NONE;
-                gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].tailBlock = BLOCK_NONE;
-            }
-            return evictedBlockNo;
-        }
-    }
-
-    xil_printf("[ORIG_GC][WARN] Die %d no block found in victim list\r\n", dieNo);
-    return BLOCK_FAIL;
+	gcCopyTarget = copyTarget ? GC_COPY_TARGET_LEAST_LOADED_DIE : GC_COPY_TARGET_VICTIM_DIE;
 }
 
-#elif defined(GAME_GC)
-
-#include "xil_printf.h"
-#include <assert.h>
-#include "memory_map.h"
-#include "garbage_collection.h"
-#include "address_translation.h"
-
-#define GC_SCHED_INTERVAL_TICK 100000
-#define GC_PAGE_LIMIT 8
-#define GC_TRIGGER_LOW   512     // GC 시작 임계값
-#define GC_TRIGGER_HIGH  612     // GC 종료 임계값
-
-P_GC_VICTIM_MAP gcVictimMapPtr;
-INCREMENTAL_GC_CONTEXT gcCtx[USER_DIES];
-
-int NeedGc(unsigned int dieNo)
+unsigned int GetGcCopyTarget()
 {
-    static unsigned int tick = 0;
-    static int gcActive[USER_DIES] = {0};
-
-    tick++;
-    if (tick % 100000 == 0)
-        xil_printf("[DBG] Die %d freeBlockCnt=%d\n",
-                   dieNo, virtualDieMapPtr->die[dieNo].freeBlockCnt);
-
-    unsigned int freeCnt = virtualDieMapPtr->die[dieNo].freeBlockCnt;
-
-    if (!gcActive[dieNo] && freeCnt <= GC_TRIGGER_LOW)
-        gcActive[dieNo] = 1;
-    else if (gcActive[dieNo] && freeCnt >= GC_TRIGGER_HIGH)
-        gcActive[dieNo] = 0;
-
-    return gcActive[dieNo];
+	return gcCopyTarget;
 }
 
 void GcScheduler()
 {
-    static unsigned int tick = 0;
-    static unsigned int logTick = 0;
-
-    tick++;
-    logTick++;
-
-    if (tick % 1000 == 0)
-    {
-        for (int dieNo = 0; dieNo < USER_DIES; dieNo++)
-        {
-            if (gcCtx[dieNo].active)
-                GarbageCollection(dieNo);
-            else if (NeedGc(dieNo))
-                GarbageCollection(dieNo);
-        }
-    }
-
-    if (logTick % 100000 == 0)
-    {
-        for (int dieNo = 0; dieNo < USER_DIES; dieNo++)
-        {
-            xil_printf("[DBG][LOG] Die %d freeBlockCnt=%d, GC state=%d\r\n",
-                       dieNo,
-                       virtualDieMapPtr->die[dieNo].freeBlockCnt,
-                       gcCtx[dieNo].state);
-        }
-    }
+	gcPolicy->Schedule();
 }
 
-void TriggerGc(unsigned int dieNo)
+//foreground GC when a die ran out of free blocks: reclaims whole victims until a host block can be taken,
+//a victim with few invalid slices nets less than a block once its copies are programmed
+void GarbageCollection(unsigned int dieNo)
 {
-    if (dieNo >= USER_DIES) return;
-
-    INCREMENTAL_GC_CONTEXT *ctx = &gcCtx[dieNo];
-    if (!ctx->active)
-    {
-        ctx->active = 1;
-        ctx->state = GC_STATE_SELECT_VICTIM;
-        xil_printf("[IGC] Triggered manually (Die %d)\r\n", dieNo);
-    }
+	while(virtualDieMapPtr->die[dieNo].freeBlockCnt <= RESERVED_FREE_BLOCK_COUNT)
+		if(!CollectVictimBlock(dieNo))
+			break;
 }
 
-void InitGcVictimMap()
+void TriggerGc(unsigned int dieNo)
 {
-    int dieNo, invalidSliceCnt;
-    gcVictimMapPtr = (P_GC_VICTIM_MAP) GC_VICTIM_MAP_ADDR;
-
-    for (dieNo = 0; dieNo < USER_DIES; dieNo++)
-    {
-        gcCtx[dieNo].state = GC_STATE_IDLE;
-        gcCtx[dieNo].victimBlock = BLOCK_NONE;
-        gcCtx[dieNo].curPage = 0;
-        gcCtx[dieNo].active = 0;
-
-        for (invalidSliceCnt = 0; invalidSliceCnt < SLICES_PER_BLOCK + 1; invalidSliceCnt++)
-        {
-            gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].headBlock = BLOCK_NONE;
-            gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].tailBlock = BLOCK_NONE;
-        }
-    }
+	if(dieNo >= USER_DIES)
+		return;
+
+	if(gcCtx[dieNo].state == GC_STATE_IDLE)
+	{
+		gcCtx[dieNo].state = GC_STATE_SELECT_VICTIM;
+		gcCtx[dieNo].active = 1;
+	}
 }
 
-void GarbageCollection(unsigned int dieNo)
+static unsigned int NeedGc(unsigned int dieNo)
 {
-    INCREMENTAL_GC_CONTEXT *ctx = &gcCtx[dieNo];
-    unsigned int pageNo, virtualSliceAddr, logicalSliceAddr;
-    unsigned int reqSlotTag;
-
-    switch (ctx->state)
-    {
-    case GC_STATE_IDLE:
-        ctx->state = GC_STATE_SELECT_VICTIM;
-        ctx->active = 1;
-        xil_printf("[IGC] -> SELECT_VICTIM (Die %d)\r\n", dieNo);
-        break;
-
-    case GC_STATE_SELECT_VICTIM:
-        ctx->victimBlock = GetFromGcVictimList(dieNo);
-        if (ctx->victimBlock == BLOCK_NONE)
-        {
-            ctx->state = GC_STATE_IDLE;
-            ctx->active = 0;
-            return;
-        }
-        ctx->curPage = 0;
-        ctx->state = GC_STATE_COPY_VALID_PAGES;
-        xil_printf("[IGC] Victim selected (Die %d, Block %d)\r\n", dieNo, ctx->victimBlock);
-        break;
-
-    case GC_STATE_COPY_VALID_PAGES:
-    {
-        int copied = 0;
-        while (copied < GC_PAGE_LIMIT && ctx->curPage < USER_PAGES_PER_BLOCK)
-        {
-            pageNo = ctx->curPage;
-            virtualSliceAddr = Vorg2VsaTranslation(dieNo, ctx->victimBlock, pageNo);
-            logicalSliceAddr = virtualSliceMapPtr->virtualSlice[virtualSliceAddr].logicalSliceAddr;
-
-            if (logicalSliceAddr != LSA_NONE &&
-                logicalSliceMapPtr->logicalSlice[logicalSliceAddr].virtualSliceAddr == virtualSliceAddr)
-            {
-                unsigned int newVsa = FindFreeVirtualSliceForGc(dieNo, ctx->victimBlock);
-                unsigned int tempBuf = AllocateTempDataBuf(dieNo);
-
-                reqSlotTag = GetFromFreeReqQ();
-                reqPoolPtr->reqPool[reqSlotTag].reqType = REQ_TYPE_NAND;
-                reqPoolPtr->reqPool[reqSlotTag].reqCode = REQ_CODE_READ;
-                reqPoolPtr->reqPool[reqSlotTag].nandInfo.virtualSliceAddr = virtualSliceAddr;
-                reqPoolPtr->reqPool[reqSlotTag].dataBufInfo.entry = tempBuf;
-                SelectLowLevelReqQ(reqSlotTag);
-
-                reqSlotTag = GetFromFreeReqQ();
-                reqPoolPtr->reqPool[reqSlotTag].reqType = REQ_TYPE_NAND;
-                reqPoolPtr->reqPool[reqSlotTag].reqCode = REQ_CODE_WRITE;
-                reqPoolPtr->reqPool[reqSlotTag].nandInfo.virtualSliceAddr = newVsa;
-                reqPoolPtr->reqPool[reqSlotTag].dataBufInfo.entry = tempBuf;
-                SelectLowLevelReqQ(reqSlotTag);
-
-                logicalSliceMapPtr->logicalSlice[logicalSliceAddr].virtualSliceAddr = newVsa;
-                virtualSliceMapPtr->virtualSlice[newVsa].logicalSliceAddr = logicalSliceAddr;
-            }
-
-            ctx->curPage++;
-            copied++;
-        }
-
-        if (ctx->curPage >= USER_PAGES_PER_BLOCK)
-            ctx->state = GC_STATE_ERASE_BLOCK;
-
-        break;
-    }
-
-    case GC_STATE_ERASE_BLOCK:
-        EraseBlock(dieNo, ctx->victimBlock);
-        xil_printf("[IGC] Erased block (Die %d, Block %d)\r\n", dieNo, ctx->victimBlock);
-        ctx->state = GC_STATE_IDLE;
-        ctx->victimBlock = BLOCK_NONE;
-        ctx->curPage = 0;
-        ctx->active = 0;
-        break;
-    }
+	unsigned int freeBlockCnt = virtualDieMapPtr->die[dieNo].freeBlockCnt;
+
+	if(!gcActive[dieNo] && (freeBlockCnt <= GC_TRIGGER_LOW))
+	{
+		gcActive[dieNo] = 1;
+		xil_printf("[GC] Die %d GC ON  (free=%u)\r\n", dieNo, freeBlockCnt);
+	}
+	else if(gcActive[dieNo] && (freeBlockCnt >= GC_TRIGGER_HIGH))
+	{
+		gcActive[dieNo] = 0;
+		xil_printf("[GC] Die %d GC OFF (free=%u)\r\n", dieNo, freeBlockCnt);
+	}
+
+	return gcActive[dieNo];
 }
 
-void PutToGcVictimList(unsigned int dieNo, unsigned int blockNo, unsigned int invalidSliceCnt)
+//one victim per die that needs GC, the copies of all dies are pipelined together
+//a blocking policy starts a victim on a die whose bucket is not in debt and charges the whole victim to it
+static void BlockingGcSchedule()
 {
-    if (gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].tailBlock != BLOCK_NONE)
-    {
-        virtualBlockMapPtr->block[dieNo][blockNo].prevBlock =
-            gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].tailBlock;
-        virtualBlockMapPtr->block[dieNo][blockNo].nextBlock = BLOCK_NONE;
-        virtualBlockMapPtr->block[dieNo]
-            [gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].tailBlock].nextBlock = blockNo;
-        gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].tailBlock = blockNo;
-    }
-    else
-    {
-        virtualBlockMapPtr->block[dieNo][blockNo].prevBlock = BLOCK_NONE;
-        virtualBlockMapPtr->block[dieNo][blockNo].nextBlock = BLOCK_NONE;
-        gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].headBlock = blockNo;
-        gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].tailBlock = blockNo;
-    }
+	unsigned int dieNo, remainingDieCnt, copyBudget;
+
+	remainingDieCnt = 0;
+	for(dieNo = 0; dieNo < USER_DIES; dieNo++)
+		if(NeedGc(dieNo) || gcCtx[dieNo].active)
+		{
+			if(gcCtx[dieNo].victimBlock != BLOCK_NONE)
+				remainingDieCnt++;
+			else if(((gcCtx[dieNo].copyTokens >= 0) || (virtualDieMapPtr->die[dieNo].freeBlockCnt <= GC_TRIGGER_CRITICAL)) && StartVictim(dieNo))
+				remainingDieCnt++;
+		}
+		else
+			gcCtx[dieNo].copyTokens = 0;
+
+	while(remainingDieCnt)
+	{
+		for(dieNo = 0; dieNo < USER_DIES; dieNo++)
+			if(gcCtx[dieNo].victimBlock != BLOCK_NONE)
+			{
+				copyBudget = GC_PAGE_LIMIT;
+				if(CopyValidSlices(dieNo, &copyBudget) && !gcCtx[dieNo].pendingCopyProgCnt)
+				{
+					EraseVictimBlock(dieNo);
+					remainingDieCnt--;
+				}
+				gcCtx[dieNo].copyTokens -= (int)(GC_PAGE_LIMIT - copyBudget) * GC_COPY_TOKEN_UNIT;
+			}
+
+		if(remainingDieCnt)
+		{
+			CheckDoneNvmeDmaReq();
+			SchedulingNandReq();
+		}
+	}
 }
 
-unsigned int GetFromGcVictimList(unsigned int dieNo)
+//freeing a victim takes its valid slices in copies for its invalid ones, so each host slice written to the die
+//earns valid / invalid copies of the current victim, times an urgency that grows as free blocks run out
+void EarnGcCopyTokens(unsigned int dieNo)
 {
-    unsigned int evictedBlockNo;
-    int invalidSliceCnt;
-
-    for (invalidSliceCnt = SLICES_PER_BLOCK; invalidSliceCnt > 0; invalidSliceCnt--)
-    {
-        if (gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].headBlock != BLOCK_NONE)
-        {
-            evictedBlockNo = gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].headBlock;
-
-            if (virtualBlockMapPtr->block[dieNo][evictedBlockNo].nextBlock != BLOCK_NONE)
-            {
-                virtualBlockMapPtr->block[dieNo][virtualBlockMapPtr->block[dieNo][evictedBlockNo].nextBlock].prevBlock = BLOCK_NONE;
-                gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].headBlock =
-                    virtualBlockMapPtr->block[dieNo][evictedBlockNo].nextBlock;
-            }
-            else
-            {
-                gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].headBlock = BLOCK_NONE;
-                gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].tailBlock = BLOCK_NONE;
-            }
-            return evictedBlockNo;
-        }
-    }
-
-    xil_printf("[IGC][WARN] No victim block available (Die %d, FreeBlocks=%d)\r\n",
-               dieNo, virtualDieMapPtr->die[dieNo].freeBlockCnt);
-    return BLOCK_NONE;
+	INCREMENTAL_GC_CONTEXT* ctx = &gcCtx[dieNo];
+	unsigned int freeBlockCnt, invalidSliceCnt, urgency;
+
+	if(!gcActive[dieNo] && !ctx->active)
+		return;
+
+	freeBlockCnt = virtualDieMapPtr->die[dieNo].freeBlockCnt;
+	if(freeBlockCnt >= GC_TRIGGER_HIGH)
+		urgency = GC_COPY_TOKEN_UNIT;
+	else if(freeBlockCnt > GC_TRIGGER_CRITICAL)
+		urgency = GC_COPY_TOKEN_UNIT + (GC_COPY_URGENCY_MAX - 1) * GC_COPY_TOKEN_UNIT * (GC_TRIGGER_HIGH - freeBlockCnt) / (GC_TRIGGER_HIGH - GC_TRIGGER_CRITICAL);
+	else
+		urgency = GC_COPY_BUCKET_DEPTH;
+
+	//a victim is not picked yet, one copy keeps the collection going
+	if(ctx->victimBlock == BLOCK_NONE)
+		ctx->copyTokens += (int)urgency;
+	else
+	{
+		invalidSliceCnt = virtualBlockMapPtr->block[dieNo][ctx->victimBlock].invalidSliceCnt;
+		if(!invalidSliceCnt)
+			invalidSliceCnt = 1;
+		ctx->copyTokens += (int)(urgency * (SLICES_PER_BLOCK - invalidSliceCnt) / invalidSliceCnt);
+	}
+
+	if(ctx->copyTokens > GC_COPY_BUCKET_DEPTH)
+		ctx->copyTokens = GC_COPY_BUCKET_DEPTH;
 }
 
-void SelectiveGetFromGcVictimList(unsigned int dieNo, unsigned int blockNo)
+//a die without queued host requests has its bucket filled, nothing is held up by its copies
+static void RefillIdleGcCopyTokens(unsigned int dieNo)
 {
-    unsigned int nextBlock, prevBlock, invalidSliceCnt;
-
-    nextBlock = virtualBlockMapPtr->block[dieNo][blockNo].nextBlock;
-    prevBlock = virtualBlockMapPtr->block[dieNo][blockNo].prevBlock;
-    invalidSliceCnt = virtualBlockMapPtr->block[dieNo][blockNo].invalidSliceCnt;
-
-    if ((nextBlock != BLOCK_NONE) && (prevBlock != BLOCK_NONE))
-    {
-        virtualBlockMapPtr->block[dieNo][prevBlock].nextBlock = nextBlock;
-        virtualBlockMapPtr->block[dieNo][nextBlock].prevBlock = prevBlock;
-    }
-    else if ((nextBlock == BLOCK_NONE) && (prevBlock != BLOCK_NONE))
-    {
-        virtualBlockMapPtr->block[dieNo][prevBlock].nextBlock = BLOCK_NONE;
-        gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].tailBlock = prevBlock;
-    }
-    else if ((nextBlock != BLOCK_NONE) && (prevBlock == BLOCK_NONE))
-    {
-        virtualBlockMapPtr->block[dieNo][nextBlock].prevBlock = BLOCK_NONE;
-        gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].headBlock = nextBlock;
-    }
-    else
-    {
-        gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].headBlock = BLOCK_NONE;
-        gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].tailBlock = BLOCK_NONE;
-    }
-}
+	P_NAND_REQUEST_QUEUE reqQ;
 
+	reqQ = &nandReqQ[Vdie2PchTranslation(dieNo)][Vdie2PwayTranslation(dieNo)];
+	if(!reqQ->classReqCnt[NAND_REQ_CLASS_HOST_READ] && !reqQ->classReqCnt[NAND_REQ_CLASS_HOST_WRITE])
+		gcCtx[dieNo].copyTokens = GC_COPY_BUCKET_DEPTH;
+}
 
+//a die down to GC_TRIGGER_CRITICAL steps on every call and one down to GC_TRIGGER_URGENT has a whole victim collected,
+//host slices skip a die only at HOST_FREE_BLOCK_FLOOR, so they keep going to a die stepping above it
+static void IncrementalGcSchedule()
+{
+	unsigned int dieNo, intervalTick;
+
+	intervalTick = !(++gcSchedTick % GC_SCHED_INTERVAL_TICK);
+
+	for(dieNo = 0; dieNo < USER_DIES; dieNo++)
+		if(!intervalTick && (virtualDieMapPtr->die[dieNo].freeBlockCnt > GC_TRIGGER_CRITICAL))
+			continue;
+		else if(virtualDieMapPtr->die[dieNo].freeBlockCnt <= GC_TRIGGER_URGENT)
+		{
+			NeedGc(dieNo);
+			CollectVictimBlock(dieNo);
+		}
+		else if(NeedGc(dieNo) || gcCtx[dieNo].active)
+		{
+			RefillIdleGcCopyTokens(dieNo);
+			IncrementalGcStep(dieNo);
+		}
+		else
+			gcCtx[dieNo].copyTokens = 0;
+}
 
-#elif defined(CB_GC) // Cost_Benefit GC (Updated to Original-style low/high threshold GC)
+static unsigned int StartVictim(unsigned int dieNo)
+{
+	INCREMENTAL_GC_CONTEXT* ctx = &gcCtx[dieNo];
+	unsigned int writeStream;
+
+	//a die close to running out of free blocks needs victims that free space, which cold data does not
+	ctx->victimBlock = BLOCK_NONE;
+	if(virtualDieMapPtr->die[dieNo].freeBlockCnt > GC_TRIGGER_CRITICAL)
+		ctx->victimBlock = SelectWearLevelingVictim(dieNo);
+	if(ctx->victimBlock == BLOCK_NONE)
+		ctx->victimBlock = gcPolicy->SelectVictim(dieNo);
+	if(ctx->victimBlock == BLOCK_NONE)
+	{
+		ctx->state = GC_STATE_IDLE;
+		ctx->active = 0;
+		return 0;
+	}
+
+	//copies may go to another die, so the victim stops taking writes now
+	for(writeStream = 0; writeStream < WRITE_STREAM_COUNT; writeStream++)
+	{
+		if(ctx->victimBlock == virtualDieMapPtr->die[dieNo].planeBlock[writeStream])
+			virtualDieMapPtr->die[dieNo].planeBlock[writeStream] = BLOCK_NONE;
+		if(ctx->victimBlock == virtualDieMapPtr->die[dieNo].currentBlock[writeStream])
+		{
+			virtualDieMapPtr->die[dieNo].currentBlock[writeStream] = GetFromFbList(dieNo, GET_FREE_BLOCK_GC);
+			if(virtualDieMapPtr->die[dieNo].currentBlock[writeStream] == BLOCK_FAIL)
+				assert(!"[WARNING] There is no available block [WARNING]");
+		}
+	}
+
+	ctx->curPage = 0;
+	ctx->state = GC_STATE_COPY_VALID_PAGES;
+	ctx->active = 1;
+	gcTriggered++;
+
+	return 1;
+}
 
-#include "xil_printf.h"
-#include <assert.h>
-#include "memory_map.h"
-#include <stdint.h>
+//the die with the shortest NAND queue among dies with at least as many free blocks as the victim's die, which wins ties
+static unsigned int SelectCopyTargetDie(unsigned int victimDieNo)
+{
+	unsigned int dieNo, targetDieNo, reqCnt, minReqCnt;
+
+	targetDieNo = victimDieNo;
+	if(gcCopyTarget == GC_COPY_TARGET_VICTIM_DIE)
+		return targetDieNo;
+
+	minReqCnt = nandReqQ[Vdie2PchTranslation(victimDieNo)][Vdie2PwayTranslation(victimDieNo)].reqCnt;
+	for(dieNo = 0; dieNo < USER_DIES; dieNo++)
+	{
+		if(dieNo == victimDieNo)
+			continue;
+		if(virtualDieMapPtr->die[dieNo].freeBlockCnt <= GC_COPY_TARGET_FREE_BLOCK_FLOOR)
+			continue;
+		if(virtualDieMapPtr->die[dieNo].freeBlockCnt < virtualDieMapPtr->die[victimDieNo].freeBlockCnt)
+			continue;
+
+		reqCnt = nandReqQ[Vdie2PchTranslation(dieNo)][Vdie2PwayTranslation(dieNo)].reqCnt;
+		if(reqCnt < minReqCnt)
+		{
+			minReqCnt = reqCnt;
+			targetDieNo = dieNo;
+		}
+	}
+
+	return targetDieNo;
+}
 
-#define CB_GC_LOW   512     // freeBlockCnt ≤ 512 → GC ON
-#define CB_GC_HIGH  612     // freeBlockCnt ≥ 612 → GC OFF
+//the read stays on the victim's die, the program goes to the die chosen by SelectCopyTargetDie
+static void CopyValidSlice(unsigned int dieNo, unsigned int victimBlockNo, unsigned int virtualSliceAddr, unsigned int logicalSliceAddr, unsigned int tempDataBufEntry)
+{
+	unsigned int reqSlotTag, targetDieNo;
+
+	reqSlotTag = GetFromFreeReqQ();
+	reqPoolPtr->reqPool[reqSlotTag].reqType = REQ_TYPE_NAND;
+	reqPoolPtr->reqPool[reqSlotTag].reqCode = REQ_CODE_READ;
+	reqPoolPtr->reqPool[reqSlotTag].logicalSliceAddr = logicalSliceAddr;
+	reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufFormat = REQ_OPT_DATA_BUF_TEMP_ENTRY;
+	reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandAddr = REQ_OPT_NAND_ADDR_VSA;
+	reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandEcc = REQ_OPT_NAND_ECC_ON;
+	reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandEccWarning = REQ_OPT_NAND_ECC_WARNING_OFF;
+	reqPoolPtr->reqPool[reqSlotTag].reqOpt.rowAddrDependencyCheck = REQ_OPT_ROW_ADDR_DEPENDENCY_CHECK;
+	reqPoolPtr->reqPool[reqSlotTag].reqOpt.blockSpace = REQ_OPT_BLOCK_SPACE_MAIN;
+	reqPoolPtr->reqPool[reqSlotTag].dataBufInfo.entry = tempDataBufEntry;
+	UpdateTempDataBufEntryInfoBlockingReq(tempDataBufEntry, reqSlotTag);
+	reqPoolPtr->reqPool[reqSlotTag].nandInfo.virtualSliceAddr = virtualSliceAddr;
+	SelectLowLevelReqQ(reqSlotTag);
+
+	reqSlotTag = GetFromFreeReqQ();
+	reqPoolPtr->reqPool[reqSlotTag].reqType = REQ_TYPE_NAND;
+	reqPoolPtr->reqPool[reqSlotTag].reqCode = REQ_CODE_WRITE;
+	reqPoolPtr->reqPool[reqSlotTag].logicalSliceAddr = logicalSliceAddr;
+	reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufFormat = REQ_OPT_DATA_BUF_TEMP_ENTRY;
+	reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandAddr = REQ_OPT_NAND_ADDR_VSA;
+	reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandEcc = REQ_OPT_NAND_ECC_ON;
+	reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandEccWarning = REQ_OPT_NAND_ECC_WARNING_OFF;
+	reqPoolPtr->reqPool[reqSlotTag].reqOpt.rowAddrDependencyCheck = REQ_OPT_ROW_ADDR_DEPENDENCY_CHECK;
+	reqPoolPtr->reqPool[reqSlotTag].reqOpt.blockSpace = REQ_OPT_BLOCK_SPACE_MAIN;
+	reqPoolPtr->reqPool[reqSlotTag].dataBufInfo.entry = tempDataBufEntry;
+	UpdateTempDataBufEntryInfoBlockingReq(tempDataBufEntry, reqSlotTag);
+	targetDieNo = SelectCopyTargetDie(dieNo);
+	reqPoolPtr->reqPool[reqSlotTag].nandInfo.virtualSliceAddr = FindFreeVirtualSliceForGc(targetDieNo, (targetDieNo == dieNo) ? victimBlockNo : BLOCK_NONE,
+			CoolDownLogicalSlice(logicalSliceAddr));
+	reqPoolPtr->reqPool[reqSlotTag].nandInfo.writeSeq = checkpointMapPtr->sliceWriteSeq++;
+	if(targetDieNo != dieNo)
+		gcCtx[dieNo].pendingCopyProgCnt++;
+
+	logicalSliceMapPtr->logicalSlice[logicalSliceAddr].virtualSliceAddr = reqPoolPtr->reqPool[reqSlotTag].nandInfo.virtualSliceAddr;
+	virtualSliceMapPtr->virtualSlice[reqPoolPtr->reqPool[reqSlotTag].nandInfo.virtualSliceAddr].logicalSliceAddr = logicalSliceAddr;
+
+	SelectLowLevelReqQ(reqSlotTag);
+	copyCnt++;
+}
 
-#define GC_DBG(...) xil_printf(__VA_ARGS__)
+//copy valid slices of the current victim while copyBudget lasts, each copy takes one from it,
+//returns 1 when the whole victim is scanned
+//a copy needs an idle temporary buffer of the die, so at most TEMPORARY_DATA_BUFFER_ENTRY_COUNT_PER_DIE are in flight
+static unsigned int CopyValidSlices(unsigned int dieNo, unsigned int* copyBudget)
+{
+	INCREMENTAL_GC_CONTEXT* ctx = &gcCtx[dieNo];
+	unsigned int virtualSliceAddr, logicalSliceAddr, tempDataBufEntry;
 
-P_GC_VICTIM_MAP gcVictimMapPtr;
+	if(virtualBlockMapPtr->block[dieNo][ctx->victimBlock].invalidSliceCnt == SLICES_PER_BLOCK)
+		ctx->curPage = USER_PAGES_PER_BLOCK;
 
-/* per-die GC active flag */
-static int gcActive[USER_DIES] = {0};
+	while((ctx->curPage < USER_PAGES_PER_BLOCK) && *copyBudget)
+	{
+		virtualSliceAddr = Vorg2VsaTranslation(dieNo, ctx->victimBlock, ctx->curPage);
+		logicalSliceAddr = virtualSliceMapPtr->virtualSlice[virtualSliceAddr].logicalSliceAddr;
 
-/* global victim block (Original-style semantics) */
-static unsigned int globalVictimBlock[USER_DIES];
+		if(logicalSliceAddr != LSA_NONE)
+			if(logicalSliceMapPtr->logicalSlice[logicalSliceAddr].virtualSliceAddr == virtualSliceAddr) //valid data
+			{
+				tempDataBufEntry = AllocateTempDataBuf(dieNo);
+				if(tempDataBufEntry == DATA_BUF_NONE)
+					break;
 
-/* CB GC age-tracking tick */
-static unsigned int gcActivityTick = 0;
+				CopyValidSlice(dieNo, ctx->victimBlock, virtualSliceAddr, logicalSliceAddr, tempDataBufEntry);
+				(*copyBudget)--;
+			}
 
-/* per-block last erase timestamp */
-static unsigned int gcLastEraseTick[USER_DIES][USER_BLOCKS_PER_DIE];
+		ctx->curPage++;
+	}
 
-/* GC debug counter */
-static unsigned int gcCount = 0;
+	return (ctx->curPage >= USER_PAGES_PER_BLOCK);
+}
 
-/* forward declarations */
-static inline uint32_t CalculateCostBenefitScore(unsigned int dieNo, unsigned int blockNo);
-static void ValidatePostErase(unsigned int dieNo, unsigned int blockNo);
+//a program of a copy is done, the temporary buffer it came through belongs to the victim's die
+//the queue of the victim's die orders its own copies before the erase, copies to other dies are counted
+void GcCopyProgramDone(unsigned int reqSlotTag)
+{
+	unsigned int dieNo;
 
+	dieNo = reqPoolPtr->reqPool[reqSlotTag].dataBufInfo.entry / TEMPORARY_DATA_BUFFER_ENTRY_COUNT_PER_DIE;
+	if(Vsa2VdieTranslation(reqPoolPtr->reqPool[reqSlotTag].nandInfo.virtualSliceAddr) == dieNo)
+		return;
 
-/* ============================
- *  ORIGINAL-STYLE GC SCHEDULER
- * ============================ */
-void CheckAndRunOriginalGc(void)
-{
-    for (int die = 0; die < USER_DIES; die++)
-    {
-        unsigned int freeCnt = virtualDieMapPtr->die[die].freeBlockCnt;
-
-        /* Turn ON GC */
-        if (!gcActive[die] && freeCnt <= CB_GC_LOW)
-        {
-            gcActive[die] = 1;
-            xil_printf("[CB_GC] Die %d GC ON (free=%u)\r\n", die, freeCnt);
-        }
-
-        /* Turn OFF GC */
-        if (gcActive[die] && freeCnt >= CB_GC_HIGH)
-        {
-            gcActive[die] = 0;
-            xil_printf("[CB_GC] Die %d GC OFF (free=%u)\r\n", die, freeCnt);
-        }
-
-        /* execute GC while active */
-        if (gcActive[die])
-            GarbageCollection(die);
-    }
+	if(!gcCtx[dieNo].pendingCopyProgCnt)
+		assert(!"[WARNING] a GC copy program is done without being counted [WARNING]");
+	gcCtx[dieNo].pendingCopyProgCnt--;
 }
 
-
-/* ============================
- *  INIT
- * ============================ */
-void InitGcVictimMap()
+static void EraseVictimBlock(unsigned int dieNo)
 {
-    int dieNo, invalidSliceCnt, blockNo;
-
-    gcActivityTick = 0;
-    gcVictimMapPtr = (P_GC_VICTIM_MAP)GC_VICTIM_MAP_ADDR;
+	INCREMENTAL_GC_CONTEXT* ctx = &gcCtx[dieNo];
+	unsigned int victimBlockNo = ctx->victimBlock;
 
-    for (dieNo = 0; dieNo < USER_DIES; dieNo++)
-    {
-        gcActive[dieNo] = 0;
-        globalVictimBlock[dieNo] = BLOCK_NONE;
+	if(ctx->pendingCopyProgCnt)
+		assert(!"[WARNING] a victim is erased before its copies are programmed [WARNING]");
 
-        for (invalidSliceCnt = 0; invalidSliceCnt < SLICES_PER_BLOCK + 1; invalidSliceCnt++)
-        {
-            gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].headBlock = BLOCK_NONE;
-            gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].tailBlock = BLOCK_NONE;
-        }
+	//the lists must not see the victim again once it is a free block
+	ctx->victimBlock = BLOCK_NONE;
+	ctx->curPage = 0;
+	ctx->state = GC_STATE_IDLE;
+	ctx->active = 0;
 
-        for (blockNo = 0; blockNo < USER_BLOCKS_PER_DIE; blockNo++)
-            gcLastEraseTick[dieNo][blockNo] = 0;
-    }
+	EraseBlock(dieNo, victimBlockNo);
+	gcLastEraseTick[dieNo][victimBlockNo] = gcActivityTick;
 }
 
-
-/* ============================
- *  GC MAIN ROUTINE
- * ============================ */
-void GarbageCollection(unsigned int dieNo)
+//reclaim a whole victim, finishing one that an incremental policy left half-copied,
+//returns 0 when the die has no victim
+static unsigned int CollectVictimBlock(unsigned int dieNo)
 {
-    unsigned int victimBlockNo;
-    unsigned int pageNo, virtualSliceAddr, logicalSliceAddr, reqSlotTag;
-    unsigned int movedPages = 0;
-    unsigned int movedLSA[USER_PAGES_PER_BLOCK];
-    unsigned int movedVSA[USER_PAGES_PER_BLOCK];
-
-    /* use global victim if preselected; else select new */
-    victimBlockNo = globalVictimBlock[dieNo];
-
-    if (victimBlockNo == BLOCK_NONE)
-        victimBlockNo = GetFromGcVictimList(dieNo);
-
-    if (victimBlockNo == BLOCK_FAIL || victimBlockNo == BLOCK_NONE)
-        return;
-
-    xil_printf("[CB_GC] Die %d victim=%d\r\n", dieNo, victimBlockNo);
-
-    /* migrate valid pages */
-    if (virtualBlockMapPtr->block[dieNo][victimBlockNo].invalidSliceCnt != SLICES_PER_BLOCK)
-    {
-        for (pageNo = 0; pageNo < USER_PAGES_PER_BLOCK; pageNo++)
-        {
-            virtualSliceAddr = Vorg2VsaTranslation(dieNo, victimBlockNo, pageNo);
-            logicalSliceAddr = virtualSliceMapPtr->virtualSlice[virtualSliceAddr].logicalSliceAddr;
-
-            if (logicalSliceAddr != LSA_NONE &&
-                logicalSliceMapPtr->logicalSlice[logicalSliceAddr].virtualSliceAddr == virtualSliceAddr)
-            {
-                unsigned int tempBuf = AllocateTempDataBuf(dieNo);
-
-                /* read */
-                reqSlotTag = GetFromFreeReqQ();
-                reqPoolPtr->reqPool[reqSlotTag].reqType = REQ_TYPE_NAND;
-                reqPoolPtr->reqPool[reqSlotTag].reqCode = REQ_CODE_READ;
-                reqPoolPtr->reqPool[reqSlotTag].nandInfo.virtualSliceAddr = virtualSliceAddr;
-                reqPoolPtr->reqPool[reqSlotTag].dataBufInfo.entry = tempBuf;
-                SelectLowLevelReqQ(reqSlotTag);
-
-                /* write */
-                reqSlotTag = GetFromFreeReqQ();
-                reqPoolPtr->reqPool[reqSlotTag].reqType = REQ_TYPE_NAND;
-                reqPoolPtr->reqPool[reqSlotTag].reqCode = REQ_CODE_WRITE;
-                reqPoolPtr->reqPool[reqSlotTag].dataBufInfo.entry = tempBuf;
-                reqPoolPtr->reqPool[reqSlotTag].nandInfo.virtualSliceAddr =
-                    FindFreeVirtualSliceForGc(dieNo, victimBlockNo);
-
-                /* update mapping */
-                unsigned int newVsa = reqPoolPtr->reqPool[reqSlotTag].nandInfo.virtualSliceAddr;
-                logicalSliceMapPtr->logicalSlice[logicalSliceAddr].virtualSliceAddr = newVsa;
-                virtualSliceMapPtr->virtualSlice[newVsa].logicalSliceAddr = logicalSliceAddr;
-
-                movedLSA[movedPages] = logicalSliceAddr;
-                movedVSA[movedPages] = newVsa;
-                movedPages++;
-
-                SelectLowLevelReqQ(reqSlotTag);
-            }
-        }
-    }
-
-    GC_DBG("[CB_GC] Moved %d pages die=%d block=%d\r\n",
-           movedPages, dieNo, victimBlockNo);
-
-    /* erase victim */
-    EraseBlock(dieNo, victimBlockNo);
-    gcLastEraseTick[dieNo][victimBlockNo] = gcActivityTick;
-
-    xil_printf("[CB_GC] Erased die=%d block=%d\r\n", dieNo, victimBlockNo);
-
-    globalVictimBlock[dieNo] = BLOCK_NONE;
-    gcCount++;
-
-    ValidatePostErase(dieNo, victimBlockNo);
-
-    xil_printf("[CB_GC] GC completed die=%d block=%d\r\n", dieNo, victimBlockNo);
+	INCREMENTAL_GC_CONTEXT* ctx = &gcCtx[dieNo];
+	unsigned int copyBudget;
+
+	if(ctx->victimBlock == BLOCK_NONE)
+		if(!StartVictim(dieNo))
+			return 0;
+
+	copyBudget = USER_PAGES_PER_BLOCK;
+	while(!CopyValidSlices(dieNo, &copyBudget) || ctx->pendingCopyProgCnt)
+	{
+		copyBudget = USER_PAGES_PER_BLOCK;
+		CheckDoneNvmeDmaReq();
+		SchedulingNandReq();
+	}
+	EraseVictimBlock(dieNo);
+
+	return 1;
 }
 
-
-/* ============================
- *  COST-BENEFIT SELECTOR
- * ============================ */
-unsigned int GetFromGcVictimList(unsigned int dieNo)
+static void IncrementalGcStep(unsigned int dieNo)
 {
-    unsigned int bestBlock = BLOCK_FAIL;
-    uint32_t bestScore = 0;
-
-    for (int isc = SLICES_PER_BLOCK; isc > 0; isc--)
-    {
-        unsigned int block = gcVictimMapPtr->gcVictimList[dieNo][isc].headBlock;
-        while (block != BLOCK_NONE)
-        {
-            unsigned int next = virtualBlockMapPtr->block[dieNo][block].nextBlock;
-            uint32_t score = CalculateCostBenefitScore(dieNo, block);
-
-            if (score > bestScore)
-            {
-                bestScore = score;
-                bestBlock = block;
-            }
-            block = next;
-        }
-    }
-
-    if (bestBlock != BLOCK_FAIL)
-    {
-        /* detach from list */
-        SelectiveGetFromGcVictimList(dieNo, bestBlock);
-
-        unsigned int invalid = virtualBlockMapPtr->block[dieNo][bestBlock].invalidSliceCnt;
-        unsigned int valid   = USER_PAGES_PER_BLOCK - invalid;
-        unsigned int age     = gcActivityTick - gcLastEraseTick[dieNo][bestBlock];
-
-        GC_DBG("[CB_GC] Victim die=%d block=%d score=%u invalid=%u valid=%u age=%u\r\n",
-               dieNo, bestBlock, bestScore, invalid, valid, age);
-    }
-    else
-    {
-        xil_printf("[CB_GC][WARN] No victim available die=%d\r\n", dieNo);
-    }
-
-    return bestBlock;
+	INCREMENTAL_GC_CONTEXT* ctx = &gcCtx[dieNo];
+	unsigned int copyBudget;
+
+	switch(ctx->state)
+	{
+	case GC_STATE_IDLE:
+		ctx->state = GC_STATE_SELECT_VICTIM;
+		ctx->active = 1;
+		break;
+
+	case GC_STATE_SELECT_VICTIM:
+		StartVictim(dieNo);
+		break;
+
+	case GC_STATE_COPY_VALID_PAGES:
+		copyBudget = (ctx->copyTokens > 0) ? (ctx->copyTokens / GC_COPY_TOKEN_UNIT) : 0;
+		ctx->copyTokens -= (int)copyBudget * GC_COPY_TOKEN_UNIT;
+		if(CopyValidSlices(dieNo, &copyBudget))
+			ctx->state = GC_STATE_ERASE_BLOCK;
+		ctx->copyTokens += (int)copyBudget * GC_COPY_TOKEN_UNIT;
+		break;
+
+	case GC_STATE_ERASE_BLOCK:
+		if(!ctx->pendingCopyProgCnt)
+			EraseVictimBlock(dieNo);
+		break;
+	}
 }
 
-
-/* ============================
- *  SCORING
- * ============================ */
-static inline uint32_t CalculateCostBenefitScore(unsigned int dieNo, unsigned int blockNo)
+static unsigned int HighestInvalidSliceCnt(unsigned int* bitmap)
 {
-    unsigned int invalid = virtualBlockMapPtr->block[dieNo][blockNo].invalidSliceCnt;
-    unsigned int valid   = USER_PAGES_PER_BLOCK - invalid;
-    unsigned int age     = gcActivityTick - gcLastEraseTick[dieNo][blockNo];
-
-    if (valid == 0) valid = 1;
+	int wordNo;
 
-    uint64_t benefit = (uint64_t)invalid * (uint64_t)(age + 1) * USER_PAGES_PER_BLOCK;
-    uint64_t cost    = (uint64_t)valid;
+	for(wordNo = GC_INVALID_BITMAP_WORDS - 1; wordNo >= 0; wordNo--)
+		if(bitmap[wordNo])
+			return wordNo * 32 + 31 - __builtin_clz(bitmap[wordNo]);
 
-    return (uint32_t)(benefit / cost);
+	return 0;
 }
 
-
-/* ============================
- *  POST-ERASE VALIDATION
- * ============================ */
-static void ValidatePostErase(unsigned int dieNo, unsigned int blockNo)
+//bucket of the erase-age epoch a block belongs to, epochs older than the ring share the oldest bucket
+static unsigned int AgeBucket(unsigned int dieNo, unsigned int blockNo)
 {
-    if (virtualBlockMapPtr->block[dieNo][blockNo].invalidSliceCnt != 0)
-        GC_DBG("[CB_GC][ERR] invalidSliceCnt not zero after erase die=%d block=%d\r\n",
-               dieNo, blockNo);
-}
+	unsigned int epoch = gcLastEraseTick[dieNo][blockNo] >> GC_AGE_EPOCH_SHIFT;
 
+	if(gcAgeEpoch - epoch >= GC_AGE_BUCKETS)
+		epoch = gcAgeEpoch - (GC_AGE_BUCKETS - 1);
 
-/* ============================
- *  LIST INSERTION
- * ============================ */
-void PutToGcVictimList(unsigned int dieNo, unsigned int blockNo, unsigned int invalidSliceCnt)
-{
-    if (invalidSliceCnt > 0)
-        gcActivityTick++;
-
-    if (gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].tailBlock != BLOCK_NONE)
-    {
-        unsigned int tail = gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].tailBlock;
-        virtualBlockMapPtr->block[dieNo][blockNo].prevBlock = tail;
-        virtualBlockMapPtr->block[dieNo][tail].nextBlock = blockNo;
-        virtualBlockMapPtr->block[dieNo][blockNo].nextBlock = BLOCK_NONE;
-        gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].tailBlock = blockNo;
-    }
-    else
-    {
-        virtualBlockMapPtr->block[dieNo][blockNo].prevBlock = BLOCK_NONE;
-        virtualBlockMapPtr->block[dieNo][blockNo].nextBlock = BLOCK_NONE;
-        gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].headBlock = blockNo;
-        gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].tailBlock = blockNo;
-    }
+	return epoch % GC_AGE_BUCKETS;
 }
 
-
-/* ============================
- *  LIST REMOVAL
- * ============================ */
-void SelectiveGetFromGcVictimList(unsigned int dieNo, unsigned int blockNo)
+//the bucket of the new epoch held the oldest epoch, which is folded into the next oldest one
+static void AdvanceAgeEpoch()
 {
-    unsigned int next = virtualBlockMapPtr->block[dieNo][blockNo].nextBlock;
-    unsigned int prev = virtualBlockMapPtr->block[dieNo][blockNo].prevBlock;
-    unsigned int isc  = virtualBlockMapPtr->block[dieNo][blockNo].invalidSliceCnt;
-
-    if (next != BLOCK_NONE && prev != BLOCK_NONE)
-    {
-        virtualBlockMapPtr->block[dieNo][prev].nextBlock = next;
-        virtualBlockMapPtr->block[dieNo][next].prevBlock = prev;
-    }
-    else if (next == BLOCK_NONE && prev != BLOCK_NONE)
-    {
-        virtualBlockMapPtr->block[dieNo][prev].nextBlock = BLOCK_NONE;
-        gcVictimMapPtr->gcVictimList[dieNo][isc].tailBlock = prev;
-    }
-    else if (next != BLOCK_NONE && prev == BLOCK_NONE)
-    {
-        virtualBlockMapPtr->block[dieNo][next].prevBlock = BLOCK_NONE;
-        gcVictimMapPtr->gcVictimList[dieNo][isc].headBlock = next;
-    }
-    else
-    {
-        gcVictimMapPtr->gcVictimList[dieNo][isc].headBlock = BLOCK_NONE;
-        gcVictimMapPtr->gcVictimList[dieNo][isc].tailBlock = BLOCK_NONE;
-    }
-
-    virtualBlockMapPtr->block[dieNo][blockNo].nextBlock = BLOCK_NONE;
-    virtualBlockMapPtr->block[dieNo][blockNo].prevBlock = BLOCK_NONE;
+	unsigned int dieNo, invalidSliceCnt, wordNo, reusedBucket, oldestBucket, headBlock, tailBlock;
+	P_GC_VICTIM_LIST_ENTRY reusedList, oldestList;
+
+	gcAgeEpoch++;
+	reusedBucket = gcAgeEpoch % GC_AGE_BUCKETS;
+	oldestBucket = (gcAgeEpoch + 1) % GC_AGE_BUCKETS;
+
+	for(dieNo = 0; dieNo < USER_DIES; dieNo++)
+	{
+		for(invalidSliceCnt = 1; invalidSliceCnt < SLICES_PER_BLOCK + 1; invalidSliceCnt++)
+		{
+			reusedList = &gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt][reusedBucket];
+			oldestList = &gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt][oldestBucket];
+			headBlock = reusedList->headBlock;
+			tailBlock = reusedList->tailBlock;
+
+			if(headBlock == BLOCK_NONE)
+				continue;
+
+			//older blocks go in front, so list heads stay the oldest blocks of a bucket
+			if(oldestList->headBlock != BLOCK_NONE)
+			{
+				virtualBlockMapPtr->block[dieNo][tailBlock].nextBlock = oldestList->headBlock;
+				virtualBlockMapPtr->block[dieNo][oldestList->headBlock].prevBlock = tailBlock;
+			}
+			else
+				oldestList->tailBlock = tailBlock;
+
+			oldestList->headBlock = headBlock;
+			reusedList->headBlock = BLOCK_NONE;
+			reusedList->tailBlock = BLOCK_NONE;
+		}
+
+		for(wordNo = 0; wordNo < GC_INVALID_BITMAP_WORDS; wordNo++)
+		{
+			gcVictimMapPtr->invalidBitmap[dieNo][oldestBucket][wordNo] |= gcVictimMapPtr->invalidBitmap[dieNo][reusedBucket][wordNo];
+			gcVictimMapPtr->invalidBitmap[dieNo][reusedBucket][wordNo] = 0;
+		}
+	}
 }
 
+static unsigned int GreedySelectVictim(unsigned int dieNo)
+{
+	unsigned int evictedBlockNo, invalidSliceCnt, bucketNo, bucketOffset, wordNo;
+	unsigned int dieBitmap[GC_INVALID_BITMAP_WORDS];
+
+	for(wordNo = 0; wordNo < GC_INVALID_BITMAP_WORDS; wordNo++)
+	{
+		dieBitmap[wordNo] = 0;
+		for(bucketNo = 0; bucketNo < GC_AGE_BUCKETS; bucketNo++)
+			dieBitmap[wordNo] |= gcVictimMapPtr->invalidBitmap[dieNo][bucketNo][wordNo];
+	}
+
+	invalidSliceCnt = HighestInvalidSliceCnt(dieBitmap);
+	if(invalidSliceCnt == 0)
+	{
+		xil_printf("[GC][WARN] Die %d no victim block (free=%u)\r\n", dieNo, virtualDieMapPtr->die[dieNo].freeBlockCnt);
+		return BLOCK_NONE;
+	}
+
+	//oldest bucket first, like the FIFO order of the original single list
+	for(bucketOffset = 1; bucketOffset <= GC_AGE_BUCKETS; bucketOffset++)
+	{
+		bucketNo = (gcAgeEpoch + bucketOffset) % GC_AGE_BUCKETS;
+		evictedBlockNo = gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt][bucketNo].headBlock;
+		if(evictedBlockNo != BLOCK_NONE)
+		{
+			SelectiveGetFromGcVictimList(dieNo, evictedBlockNo);
+			return evictedBlockNo;
+		}
+	}
+
+	assert(!"[WARNING] GC victim bitmap and lists are inconsistent [WARNING]");
+	return BLOCK_NONE;
+}
 
-#elif defined(CBGAME_GC)   // Cost-Benefit + Incremental GC (GameGC 방식)
-
-#include "xil_printf.h"
-#include <assert.h>
-#include "memory_map.h"
-#include <stdint.h>
-#include "address_translation.h"
-
-#define CB_GC_LOW   512     // GC ON threshold
-#define CB_GC_HIGH  612     // GC OFF threshold
-#define GC_PAGE_LIMIT 8     // incremental copy per cycle
-
-#define GC_DBG(...) xil_printf(__VA_ARGS__)
-
-P_GC_VICTIM_MAP gcVictimMapPtr;
-
-static unsigned int gcActivityTick;
-static unsigned int gcLastEraseTick[USER_DIES][USER_BLOCKS_PER_DIE];
-static unsigned int gcCount = 0;
-
-static int gcActive[USER_DIES];    // <-- threshold ON/OFF 플래그
-
-/* incremental state-machine */
-typedef struct {
-    unsigned int state;
-    unsigned int victimBlock;
-    unsigned int curPage;
-    unsigned char active;
-} CBGAME_GC_CTX;
-
-static CBGAME_GC_CTX cbCtx[USER_DIES];
-
-/*===========================================================================
- * Cost-Benefit score
- *===========================================================================*/
-static inline uint32_t CalculateCostBenefitScore(unsigned int dieNo, unsigned int blockNo)
+static unsigned int CalculateCostBenefitScore(unsigned int dieNo, unsigned int blockNo)
 {
-    unsigned int invalid = virtualBlockMapPtr->block[dieNo][blockNo].invalidSliceCnt;
-    unsigned int valid   = USER_PAGES_PER_BLOCK - invalid;
-    unsigned int age     = gcActivityTick - gcLastEraseTick[dieNo][blockNo];
+	unsigned int invalid = virtualBlockMapPtr->block[dieNo][blockNo].invalidSliceCnt;
+	unsigned int valid = USER_PAGES_PER_BLOCK - invalid;
+	unsigned int age = gcActivityTick - gcLastEraseTick[dieNo][blockNo];
+	unsigned long long benefit;
 
-    uint64_t benefit = (uint64_t)invalid * (uint64_t)(age + 1) * USER_PAGES_PER_BLOCK;
-    uint64_t cost    = (uint64_t)(valid + 1);
+	if(valid == 0)
+		valid = 1;
 
-    return (uint32_t)(benefit / cost);
-}
+	benefit = (unsigned long long)invalid * (unsigned long long)(age + 1) * USER_PAGES_PER_BLOCK;
 
-/*===========================================================================
- * Init
- *===========================================================================*/
-void InitGcVictimMap()
-{
-    int dieNo, invalidSliceCnt;
-    unsigned int blockNo;
-
-    gcActivityTick = 0;
-    gcVictimMapPtr = (P_GC_VICTIM_MAP)GC_VICTIM_MAP_ADDR;
-
-    for (dieNo = 0; dieNo < USER_DIES; dieNo++)
-    {
-        gcActive[dieNo] = 0;
-
-        cbCtx[dieNo].state = GC_STATE_IDLE;
-        cbCtx[dieNo].victimBlock = BLOCK_NONE;
-        cbCtx[dieNo].curPage = 0;
-        cbCtx[dieNo].active = 0;
-
-        for (invalidSliceCnt = 0; invalidSliceCnt < SLICES_PER_BLOCK + 1; invalidSliceCnt++)
-        {
-            gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].headBlock = BLOCK_NONE;
-            gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].tailBlock = BLOCK_NONE;
-        }
-
-        for (blockNo = 0; blockNo < USER_BLOCKS_PER_DIE; blockNo++)
-            gcLastEraseTick[dieNo][blockNo] = 0;
-    }
+	return (unsigned int)(benefit / valid);
 }
 
-/*===========================================================================
- * Victim selection (Cost-Benefit)
- *===========================================================================*/
-unsigned int GetFromGcVictimList(unsigned int dieNo)
+//within a bucket the score grows with the invalid slice count, so each bucket offers a single candidate
+static unsigned int CostBenefitSelectVictim(unsigned int dieNo)
 {
-    unsigned int best = BLOCK_FAIL;
-    uint32_t bestScore = 0;
-
-    for (int isc = SLICES_PER_BLOCK; isc > 0; isc--)
-    {
-        unsigned int blk = gcVictimMapPtr->gcVictimList[dieNo][isc].headBlock;
-
-        while (blk != BLOCK_NONE)
-        {
-            unsigned int next = virtualBlockMapPtr->block[dieNo][blk].nextBlock;
-            uint32_t score = CalculateCostBenefitScore(dieNo, blk);
-
-            if (score > bestScore)
-            {
-                bestScore = score;
-                best = blk;
-            }
-            blk = next;
-        }
-    }
-
-    if (best == BLOCK_FAIL)
-    {
-        xil_printf("[CBGAME_GC][WARN] No victim block on die %d\r\n", dieNo);
-        return BLOCK_FAIL;
-    }
-
-    SelectiveGetFromGcVictimList(dieNo, best);
-
-    xil_printf("[CBGAME_GC] Victim die=%d block=%d score=%u\r\n",
-               dieNo, best, bestScore);
-
-    return best;
+	unsigned int blockNo, bestBlock, score, bestScore, invalidSliceCnt, bucketNo;
+
+	bestBlock = BLOCK_NONE;
+	bestScore = 0;
+
+	for(bucketNo = 0; bucketNo < GC_AGE_BUCKETS; bucketNo++)
+	{
+		invalidSliceCnt = HighestInvalidSliceCnt(gcVictimMapPtr->invalidBitmap[dieNo][bucketNo]);
+		if(invalidSliceCnt == 0)
+			continue;
+
+		blockNo = gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt][bucketNo].headBlock;
+		score = CalculateCostBenefitScore(dieNo, blockNo);
+		if((bestBlock == BLOCK_NONE) || (score > bestScore))
+		{
+			bestScore = score;
+			bestBlock = blockNo;
+		}
+	}
+
+	if(bestBlock == BLOCK_NONE)
+	{
+		xil_printf("[GC][WARN] Die %d no victim block (free=%u)\r\n", dieNo, virtualDieMapPtr->die[dieNo].freeBlockCnt);
+		return BLOCK_NONE;
+	}
+
+	SelectiveGetFromGcVictimList(dieNo, bestBlock);
+
+	return bestBlock;
 }
 
-/*===========================================================================
- * PutToGcVictimList
- *===========================================================================*/
-void PutToGcVictimList(unsigned int dieNo, unsigned int blockNo, unsigned int invalidSliceCnt)
+unsigned int GetFromGcVictimList(unsigned int dieNo)
 {
-    if (invalidSliceCnt)
-        gcActivityTick++;
-
-    if (gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].tailBlock != BLOCK_NONE)
-    {
-        unsigned int tail = gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].tailBlock;
-
-        virtualBlockMapPtr->block[dieNo][blockNo].prevBlock = tail;
-        virtualBlockMapPtr->block[dieNo][tail].nextBlock = blockNo;
-        virtualBlockMapPtr->block[dieNo][blockNo].nextBlock = BLOCK_NONE;
-
-        gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].tailBlock = blockNo;
-    }
-    else
-    {
-        virtualBlockMapPtr->block[dieNo][blockNo].prevBlock = BLOCK_NONE;
-        virtualBlockMapPtr->block[dieNo][blockNo].nextBlock = BLOCK_NONE;
-
-        gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].headBlock = blockNo;
-        gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt].tailBlock = blockNo;
-    }
+	return gcPolicy->SelectVictim(dieNo);
 }
 
-/*===========================================================================
- * Threshold-based Incremental Scheduler (GameGC 스타일 유지)
- *===========================================================================*/
-void GcScheduler(void)
+//a victim under collection stays out of the lists while host writes invalidate its slices
+static unsigned int IsGcVictim(unsigned int dieNo, unsigned int blockNo)
 {
-    static unsigned int tick = 0;
-    tick++;
-
-    if (tick % 1000 == 0)
-    {
-        for (int die = 0; die < USER_DIES; die++)
-        {
-            unsigned int freeCnt = virtualDieMapPtr->die[die].freeBlockCnt;
-
-            /* ---- Threshold ON/OFF ---- */
-            if (!gcActive[die] && freeCnt <= CB_GC_LOW)
-            {
-                gcActive[die] = 1;
-                xil_printf("[CBGAME_GC] Die %d GC ON (free=%u)\r\n", die, freeCnt);
-            }
-            else if (gcActive[die] && freeCnt >= CB_GC_HIGH)
-            {
-                gcActive[die] = 0;
-                xil_printf("[CBGAME_GC] Die %d GC OFF (free=%u)\r\n", die, freeCnt);
-            }
-
-            /* ---- Incremental GC 실행 ---- */
-            if (gcActive[die])
-                GarbageCollection(die);
-        }
-    }
+	return (gcCtx[dieNo].victimBlock == blockNo);
 }
 
-/*===========================================================================
- * Incremental GC Body
- *===========================================================================*/
-void GarbageCollection(unsigned int dieNo)
+void PutToGcVictimList(unsigned int dieNo, unsigned int blockNo, unsigned int invalidSliceCnt)
 {
-    CBGAME_GC_CTX *ctx = &cbCtx[dieNo];
-    unsigned int pageNo, vsa, lsa;
-
-    switch (ctx->state)
-    {
-    case GC_STATE_IDLE:
-        ctx->active = 1;
-        ctx->state = GC_STATE_SELECT_VICTIM;
-        xil_printf("[CBGAME_GC] -> SELECT_VICTIM (die %d)\r\n", dieNo);
-        break;
-
-    case GC_STATE_SELECT_VICTIM:
-        ctx->victimBlock = GetFromGcVictimList(dieNo);
-
-        if (ctx->victimBlock == BLOCK_FAIL)
-        {
-            ctx->state = GC_STATE_IDLE;
-            ctx->active = 0;
-            return;
-        }
-
-        xil_printf("[CBGAME_GC] Start victim %d on die %d\r\n", ctx->victimBlock, dieNo);
-
-        ctx->curPage = 0;
-        ctx->state = GC_STATE_COPY_VALID_PAGES;
-        break;
-
-    case GC_STATE_COPY_VALID_PAGES:
-    {
-        int moved = 0;
-
-        while (moved < GC_PAGE_LIMIT && ctx->curPage < USER_PAGES_PER_BLOCK)
-        {
-            pageNo = ctx->curPage++;
-            vsa = Vorg2VsaTranslation(dieNo, ctx->victimBlock, pageNo);
-            lsa = virtualSliceMapPtr->virtualSlice[vsa].logicalSliceAddr;
-
-            if (lsa != LSA_NONE &&
-                logicalSliceMapPtr->logicalSlice[lsa].virtualSliceAddr == vsa)
-            {
-                unsigned int newVsa = FindFreeVirtualSliceForGc(dieNo, ctx->victimBlock);
-                unsigned int temp = AllocateTempDataBuf(dieNo);
-
-                unsigned int req = GetFromFreeReqQ();
-                reqPoolPtr->reqPool[req].reqType = REQ_TYPE_NAND;
-                reqPoolPtr->reqPool[req].reqCode = REQ_CODE_READ;
-                reqPoolPtr->reqPool[req].nandInfo.virtualSliceAddr = vsa;
-                reqPoolPtr->reqPool[req].dataBufInfo.entry = temp;
-                SelectLowLevelReqQ(req);
-
-                req = GetFromFreeReqQ();
-                reqPoolPtr->reqPool[req].reqType = REQ_TYPE_NAND;
-                reqPoolPtr->reqPool[req].reqCode = REQ_CODE_WRITE;
-                reqPoolPtr->reqPool[req].nandInfo.virtualSliceAddr = newVsa;
-                reqPoolPtr->reqPool[req].dataBufInfo.entry = temp;
-                SelectLowLevelReqQ(req);
-
-                logicalSliceMapPtr->logicalSlice[lsa].virtualSliceAddr = newVsa;
-                virtualSliceMapPtr->virtualSlice[newVsa].logicalSliceAddr = lsa;
-
-                moved++;
-            }
-        }
-
-        if (ctx->curPage >= USER_PAGES_PER_BLOCK)
-            ctx->state = GC_STATE_ERASE_BLOCK;
-
-        break;
-    }
-
-    case GC_STATE_ERASE_BLOCK:
-
-        EraseBlock(dieNo, ctx->victimBlock);
-        xil_printf("[CBGAME_GC] Erased die=%d block=%d\r\n",
-                   dieNo, ctx->victimBlock);
-
-        gcLastEraseTick[dieNo][ctx->victimBlock] = gcActivityTick;
-        gcCount++;
-
-        ctx->victimBlock = BLOCK_NONE;
-        ctx->curPage = 0;
-        ctx->state = GC_STATE_IDLE;
-        ctx->active = 0;
-
-        xil_printf("[CBGAME_GC] GC Complete (die=%d)\r\n", dieNo);
-
-        break;
-    }
+	P_GC_VICTIM_LIST_ENTRY victimList;
+	unsigned int bucketNo;
+
+	if(invalidSliceCnt)
+	{
+		gcActivityTick++;
+		if((gcActivityTick >> GC_AGE_EPOCH_SHIFT) != gcAgeEpoch)
+			AdvanceAgeEpoch();
+	}
+
+	if(IsGcVictim(dieNo, blockNo))
+		return;
+
+	bucketNo = AgeBucket(dieNo, blockNo);
+	victimList = &gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt][bucketNo];
+
+	if(victimList->tailBlock != BLOCK_NONE)
+	{
+		virtualBlockMapPtr->block[dieNo][blockNo].prevBlock = victimList->tailBlock;
+		virtualBlockMapPtr->block[dieNo][blockNo].nextBlock = BLOCK_NONE;
+		virtualBlockMapPtr->block[dieNo][victimList->tailBlock].nextBlock = blockNo;
+		victimList->tailBlock = blockNo;
+	}
+	else
+	{
+		virtualBlockMapPtr->block[dieNo][blockNo].prevBlock = BLOCK_NONE;
+		virtualBlockMapPtr->block[dieNo][blockNo].nextBlock = BLOCK_NONE;
+		victimList->headBlock = blockNo;
+		victimList->tailBlock = blockNo;
+	}
+
+	gcVictimMapPtr->invalidBitmap[dieNo][bucketNo][invalidSliceCnt / 32] |= (1u << (invalidSliceCnt % 32));
 }
 
-/*===========================================================================
- * Victim removal from list
- *===========================================================================*/
 void SelectiveGetFromGcVictimList(unsigned int dieNo, unsigned int blockNo)
 {
-    unsigned int next = virtualBlockMapPtr->block[dieNo][blockNo].nextBlock;
-    unsigned int prev = virtualBlockMapPtr->block[dieNo][blockNo].prevBlock;
-    unsigned int invalid = virtualBlockMapPtr->block[dieNo][blockNo].invalidSliceCnt;
-
-    if (next != BLOCK_NONE && prev != BLOCK_NONE)
-    {
-        virtualBlockMapPtr->block[dieNo][prev].nextBlock = next;
-        virtualBlockMapPtr->block[dieNo][next].prevBlock = prev;
-    }
-    else if (next == BLOCK_NONE && prev != BLOCK_NONE)
-    {
-        virtualBlockMapPtr->block[dieNo][prev].nextBlock = BLOCK_NONE;
-        gcVictimMapPtr->gcVictimList[dieNo][invalid].tailBlock = prev;
-    }
-    else if (next != BLOCK_NONE && prev == BLOCK_NONE)
-    {
-        virtualBlockMapPtr->block[dieNo][next].prevBlock = BLOCK_NONE;
-        gcVictimMapPtr->gcVictimList[dieNo][invalid].headBlock = next;
-    }
-    else
-    {
-        gcVictimMapPtr->gcVictimList[dieNo][invalid].headBlock = BLOCK_NONE;
-        gcVictimMapPtr->gcVictimList[dieNo][invalid].tailBlock = BLOCK_NONE;
-    }
+	P_GC_VICTIM_LIST_ENTRY victimList;
+	unsigned int nextBlock, prevBlock, invalidSliceCnt, bucketNo;
+
+	if(IsGcVictim(dieNo, blockNo))
+		return;
+
+	nextBlock = virtualBlockMapPtr->block[dieNo][blockNo].nextBlock;
+	prevBlock = virtualBlockMapPtr->block[dieNo][blockNo].prevBlock;
+	invalidSliceCnt = virtualBlockMapPtr->block[dieNo][blockNo].invalidSliceCnt;
+
+	//blocks without invalid slices are never listed
+	if(invalidSliceCnt == 0)
+		return;
+
+	bucketNo = AgeBucket(dieNo, blockNo);
+	victimList = &gcVictimMapPtr->gcVictimList[dieNo][invalidSliceCnt][bucketNo];
+
+	if((nextBlock != BLOCK_NONE) && (prevBlock != BLOCK_NONE))
+	{
+		virtualBlockMapPtr->block[dieNo][prevBlock].nextBlock = nextBlock;
+		virtualBlockMapPtr->block[dieNo][nextBlock].prevBlock = prevBlock;
+	}
+	else if((nextBlock == BLOCK_NONE) && (prevBlock != BLOCK_NONE))
+	{
+		virtualBlockMapPtr->block[dieNo][prevBlock].nextBlock = BLOCK_NONE;
+		victimList->tailBlock = prevBlock;
+	}
+	else if((nextBlock != BLOCK_NONE) && (prevBlock == BLOCK_NONE))
+	{
+		virtualBlockMapPtr->block[dieNo][nextBlock].prevBlock = BLOCK_NONE;
+		victimList->headBlock = nextBlock;
+	}
+	else
+	{
+		victimList->headBlock = BLOCK_NONE;
+		victimList->tailBlock = BLOCK_NONE;
+		gcVictimMapPtr->invalidBitmap[dieNo][bucketNo][invalidSliceCnt / 32] &= ~(1u << (invalidSliceCnt % 32));
+	}
+
+	virtualBlockMapPtr->block[dieNo][blockNo].nextBlock = BLOCK_NONE;
+	virtualBlockMapPtr->block[dieNo][blockNo].prevBlock = BLOCK_NONE;
 }
-
-#endif
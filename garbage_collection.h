@@ -30,7 +30,7 @@
 // Module Name: Garbage Collector
 // File Name: garbage_collection.h
 //
-// Version: v1.0.0
+// Version: v1.3.3
 //
 // Description:
 //   - define parameters, data structure and functions of garbage collector
@@ -39,6 +39,25 @@
 //////////////////////////////////////////////////////////////////////////////////
 // Revision History:
 //
+// * v1.3.3
+//   - GC_TRIGGER_URGENT, below it incremental policies collect whole victims
+//
+// * v1.3.2
+//   - GC_POLICY drops the unused Collect entry
+//
+// * v1.3.1
+//   - a victim is erased once its copies programmed to other dies are done
+//
+// * v1.3.0
+//   - GC copies are paced by a per-die token bucket that host writes fill
+//
+// * v1.2.0
+//   - victim lists are bucketed by erase age for constant-time CB selection
+//   - GC copies can be programmed to the least-loaded die
+//
+// * v1.1.0
+//   - GC policies are selected at runtime through GC_POLICY
+//
 // * v1.0.0
 //   - First draft
 //////////////////////////////////////////////////////////////////////////////////
@@ -49,76 +68,84 @@
 
 #include "ftl_config.h"
 
-// GC 모드는 garbage_collection.c에서 정의됩니다
-
-#define GAME_GC // wdy: GAME GC 활성화
-
-#if defined(ORIGINAL_GC)
-	typedef struct _GC_VICTIM_LIST_ENTRY {
-		unsigned int headBlock : 16;
-		unsigned int tailBlock : 16;
-	} GC_VICTIM_LIST_ENTRY, *P_GC_VICTIM_LIST_ENTRY;
-
-	typedef struct _GC_VICTIM_MAP {
-		GC_VICTIM_LIST_ENTRY gcVictimList[USER_DIES][SLICES_PER_BLOCK + 1];
-	} GC_VICTIM_MAP, *P_GC_VICTIM_MAP;
-
-	void InitGcVictimMap();
-	void GarbageCollection(unsigned int dieNo);
-
-	void PutToGcVictimList(unsigned int dieNo, unsigned int blockNo, unsigned int invalidSliceCnt);
-	unsigned int GetFromGcVictimList(unsigned int dieNo);
-	void SelectiveGetFromGcVictimList(unsigned int dieNo, unsigned int blockNo);
-
-	extern P_GC_VICTIM_MAP gcVictimMapPtr;
-	extern unsigned int gcTriggered;
-	extern unsigned int copyCnt;
-
-#elif defined(GAME_GC) // Greedy And Multi-Generational GC
-
-	#include "ftl_config.h"
-
-		typedef struct _GC_VICTIM_LIST_ENTRY {
-			unsigned int headBlock : 16;
-			unsigned int tailBlock : 16;
-		} GC_VICTIM_LIST_ENTRY, *P_GC_VICTIM_LIST_ENTRY;
-
-		typedef struct _GC_VICTIM_MAP {
-			GC_VICTIM_LIST_ENTRY gcVictimList[USER_DIES][SLICES_PER_BLOCK + 1];
-		} GC_VICTIM_MAP, *P_GC_VICTIM_MAP;
-
-		void InitGcVictimMap();
-		void GarbageCollection(unsigned int dieNo);
-
-		void PutToGcVictimList(unsigned int dieNo, unsigned int blockNo, unsigned int invalidSliceCnt);
-		unsigned int GetFromGcVictimList(unsigned int dieNo);
-		void SelectiveGetFromGcVictimList(unsigned int dieNo, unsigned int blockNo);
-
-		extern P_GC_VICTIM_MAP gcVictimMapPtr;
-		extern unsigned int gcTriggered;
-		extern unsigned int copyCnt;
-
-		typedef enum {
-			GC_STATE_IDLE = 0,
-			GC_STATE_SELECT_VICTIM,
-			GC_STATE_COPY_VALID_PAGES,
-			GC_STATE_ERASE_BLOCK
-		} GC_STATE;
-
-		typedef struct {
-			GC_STATE state;
-			unsigned int victimBlock;
-			unsigned int curPage;
-			unsigned char active;
-		} INCREMENTAL_GC_CONTEXT;
-
-
-		void GcScheduler(void);
-		void TriggerGc(unsigned int dieNo);
-		void RevalidateBlock(unsigned int dieNo, unsigned int blockNo);
-
-		extern P_GC_VICTIM_MAP gcVictimMapPtr;
-
-	#endif /* GARBAGE_COLLECTION_H_ */
+#define GC_POLICY_ORIGINAL		0	//greedy victim, whole victim per call
+#define GC_POLICY_GAME			1	//greedy victim, incremental copy (Greedy And Multi-Generational)
+#define GC_POLICY_CB			2	//cost-benefit victim, whole victim per call
+#define GC_POLICY_CBGAME		3	//cost-benefit victim, incremental copy
+#define GC_POLICY_COUNT			4
+
+#define GC_POLICY_DEFAULT		GC_POLICY_CB
+
+#define GC_TRIGGER_LOW			512		//freeBlockCnt <= LOW -> GC on
+#define GC_TRIGGER_HIGH			612		//freeBlockCnt >= HIGH -> GC off
+#define GC_TRIGGER_CRITICAL		(GC_TRIGGER_LOW / 4)	//freeBlockCnt <= CRITICAL -> copies are not paced
+#define GC_TRIGGER_URGENT		(HOST_FREE_BLOCK_FLOOR + WRITE_STREAM_COUNT)	//freeBlockCnt <= URGENT -> whole victims, room for the GC blocks of one
+#define GC_PAGE_LIMIT			8		//valid pages copied per pipelined step of a blocking policy
+#define GC_SCHED_INTERVAL_TICK	1000	//GcScheduler calls per incremental step
+
+#define GC_COPY_TOKEN_UNIT		16		//tokens per copy, a host write earns a fraction of a copy
+#define GC_COPY_URGENCY_MAX		4		//copies earned per copy needed to keep up with host writes, at GC_TRIGGER_CRITICAL
+#define GC_COPY_BUCKET_DEPTH	(16 * GC_COPY_TOKEN_UNIT)	//tokens a die may save up while its temporary buffers are busy
+
+#define GC_COPY_TARGET_VICTIM_DIE		0	//valid slices are programmed back to the victim's die
+#define GC_COPY_TARGET_LEAST_LOADED_DIE	1	//programmed to the die with the shortest NAND queue
+#define GC_COPY_TARGET_FREE_BLOCK_FLOOR	16	//dies at or below it only take their own copies
+
+#define GC_AGE_BUCKETS			8		//erase-age epochs kept apart, older blocks share the oldest bucket
+#define GC_AGE_EPOCH_SHIFT		18		//2^18 invalidations per age epoch
+#define GC_INVALID_BITMAP_WORDS	((SLICES_PER_BLOCK + 1 + 31) / 32)
+
+typedef struct _GC_VICTIM_LIST_ENTRY {
+	unsigned int headBlock : 16;
+	unsigned int tailBlock : 16;
+} GC_VICTIM_LIST_ENTRY, *P_GC_VICTIM_LIST_ENTRY;
+
+typedef struct _GC_VICTIM_MAP {
+	GC_VICTIM_LIST_ENTRY gcVictimList[USER_DIES][SLICES_PER_BLOCK + 1][GC_AGE_BUCKETS];
+	unsigned int invalidBitmap[USER_DIES][GC_AGE_BUCKETS][GC_INVALID_BITMAP_WORDS];	//non-empty lists of each bucket
+} GC_VICTIM_MAP, *P_GC_VICTIM_MAP;
+
+typedef enum {
+	GC_STATE_IDLE = 0,
+	GC_STATE_SELECT_VICTIM,
+	GC_STATE_COPY_VALID_PAGES,
+	GC_STATE_ERASE_BLOCK
+} GC_STATE;
+
+typedef struct {
+	GC_STATE state;
+	unsigned int victimBlock;
+	unsigned int curPage;
+	int copyTokens;	//GC_COPY_TOKEN_UNIT per copy the die may issue, below zero while a blocking victim is paid off
+	unsigned int pendingCopyProgCnt;	//copies of the victim programmed to other dies and not done yet
+	unsigned char active;
+} INCREMENTAL_GC_CONTEXT;
+
+typedef struct _GC_POLICY {
+	const char* name;
+	unsigned int (*SelectVictim)(unsigned int dieNo);	//detach and return a victim block, BLOCK_NONE if none
+	void (*Schedule)();									//background GC, called from the main loop
+} GC_POLICY, *P_GC_POLICY;
+
+void InitGcVictimMap();
+void GcScheduler();
+void GarbageCollection(unsigned int dieNo);
+void TriggerGc(unsigned int dieNo);
+void EarnGcCopyTokens(unsigned int dieNo);
+void GcCopyProgramDone(unsigned int reqSlotTag);
+
+void PutToGcVictimList(unsigned int dieNo, unsigned int blockNo, unsigned int invalidSliceCnt);
+unsigned int GetFromGcVictimList(unsigned int dieNo);
+void SelectiveGetFromGcVictimList(unsigned int dieNo, unsigned int blockNo);
+
+unsigned int SetGcPolicy(unsigned int policyNo);
+unsigned int GetGcPolicy();
+void SetGcCopyTarget(unsigned int copyTarget);
+unsigned int GetGcCopyTarget();
+
+extern P_GC_VICTIM_MAP gcVictimMapPtr;
+extern unsigned int gcTriggered;
+extern unsigned int copyCnt;
+extern const GC_POLICY gcPolicyTable[GC_POLICY_COUNT];
 
 #endif /* GARBAGE_COLLECTION_H_ */
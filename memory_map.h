@@ -53,6 +53,10 @@
 #include "request_schedule.h"
 #include "request_transform.h"
 #include "garbage_collection.h"
+#include "write_back.h"
+#include "checkpoint.h"
+#include "wear_leveling.h"
+#include "write_temperature.h"
 
 #define DRAM_START_ADDR					0x00100000
 
@@ -67,12 +71,17 @@
 
 #define FTL_MANAGEMENT_START_ADDR		0x10000000
 // Uncached & Unbuffered
-//for data buffer
+//for data buffer, temporary buffers hold TEMPORARY_DATA_BUFFER_ENTRY_COUNT_PER_DIE GC copies per die
+//a die reads one slice at a time, so one fill buffer per die receives the NAND copy merged into a partially valid entry
+//checkpoint buffers stage a snapshot of the maps, page by page with room for the spare region
 #define DATA_BUFFER_BASE_ADDR 					0x10000000
 #define TEMPORARY_DATA_BUFFER_BASE_ADDR			(DATA_BUFFER_BASE_ADDR + AVAILABLE_DATA_BUFFER_ENTRY_COUNT * BYTES_PER_DATA_REGION_OF_SLICE)
 #define SPARE_DATA_BUFFER_BASE_ADDR				(TEMPORARY_DATA_BUFFER_BASE_ADDR + AVAILABLE_TEMPORARY_DATA_BUFFER_ENTRY_COUNT * BYTES_PER_DATA_REGION_OF_SLICE)
 #define TEMPORARY_SPARE_DATA_BUFFER_BASE_ADDR	(SPARE_DATA_BUFFER_BASE_ADDR + AVAILABLE_DATA_BUFFER_ENTRY_COUNT * BYTES_PER_SPARE_REGION_OF_SLICE)
-#define RESERVED_DATA_BUFFER_BASE_ADDR 			(TEMPORARY_SPARE_DATA_BUFFER_BASE_ADDR + AVAILABLE_TEMPORARY_DATA_BUFFER_ENTRY_COUNT * BYTES_PER_SPARE_REGION_OF_SLICE)
+#define FILL_DATA_BUFFER_BASE_ADDR				(TEMPORARY_SPARE_DATA_BUFFER_BASE_ADDR + AVAILABLE_TEMPORARY_DATA_BUFFER_ENTRY_COUNT * BYTES_PER_SPARE_REGION_OF_SLICE)
+#define FILL_SPARE_DATA_BUFFER_BASE_ADDR		(FILL_DATA_BUFFER_BASE_ADDR + USER_DIES * BYTES_PER_DATA_REGION_OF_SLICE)
+#define CHECKPOINT_DATA_BUFFER_BASE_ADDR		(FILL_SPARE_DATA_BUFFER_BASE_ADDR + USER_DIES * BYTES_PER_SPARE_REGION_OF_SLICE)
+#define RESERVED_DATA_BUFFER_BASE_ADDR 			(CHECKPOINT_DATA_BUFFER_BASE_ADDR + CHECKPOINT_BUFFER_ENTRY_COUNT * BYTES_PER_CHECKPOINT_BUFFER_ENTRY)
 //for nand request completion
 #define COMPLETE_FLAG_TABLE_ADDR			0x17000000
 #define STATUS_REPORT_TABLE_ADDR			(COMPLETE_FLAG_TABLE_ADDR + sizeof(COMPLETE_FLAG_TABLE))
@@ -82,9 +91,11 @@
 // for buffers
 #define DATA_BUFFER_MAP_ADDR		 		0x18000000
 #define DATA_BUFFFER_HASH_TABLE_ADDR		(DATA_BUFFER_MAP_ADDR + sizeof(DATA_BUF_MAP))
-#define TEMPORARY_DATA_BUFFER_MAP_ADDR 		(DATA_BUFFFER_HASH_TABLE_ADDR + sizeof(DATA_BUF_HASH_TABLE))
+#define DATA_BUFFER_GHOST_MAP_ADDR			(DATA_BUFFFER_HASH_TABLE_ADDR + sizeof(DATA_BUF_HASH_TABLE))
+#define TEMPORARY_DATA_BUFFER_MAP_ADDR 		(DATA_BUFFER_GHOST_MAP_ADDR + sizeof(DATA_BUF_GHOST_MAP))
+#define WRITE_BACK_MAP_ADDR					(TEMPORARY_DATA_BUFFER_MAP_ADDR + sizeof(TEMPORARY_DATA_BUF_MAP))
 // for map tables
-#define LOGICAL_SLICE_MAP_ADDR				(TEMPORARY_DATA_BUFFER_MAP_ADDR + sizeof(TEMPORARY_DATA_BUF_MAP))
+#define LOGICAL_SLICE_MAP_ADDR				(WRITE_BACK_MAP_ADDR + sizeof(WRITE_BACK_MAP))
 #define VIRTUAL_SLICE_MAP_ADDR				(LOGICAL_SLICE_MAP_ADDR + sizeof(LOGICAL_SLICE_MAP))
 #define VIRTUAL_BLOCK_MAP_ADDR				(VIRTUAL_SLICE_MAP_ADDR + sizeof(VIRTUAL_SLICE_MAP))
 #define PHY_BLOCK_MAP_ADDR					(VIRTUAL_BLOCK_MAP_ADDR + sizeof(VIRTUAL_BLOCK_MAP))
@@ -92,16 +103,24 @@
 #define VIRTUAL_DIE_MAP_ADDR				(BAD_BLOCK_TABLE_INFO_MAP_ADDR + sizeof(BAD_BLOCK_TABLE_INFO_MAP))
 // for GC victim selection
 #define GC_VICTIM_MAP_ADDR					(VIRTUAL_DIE_MAP_ADDR + sizeof(VIRTUAL_DIE_MAP))
+// for wear leveling
+#define WEAR_LEVELING_MAP_ADDR				(GC_VICTIM_MAP_ADDR + sizeof(GC_VICTIM_MAP))
+// for write temperature tracking
+#define WRITE_TEMPERATURE_MAP_ADDR			(WEAR_LEVELING_MAP_ADDR + sizeof(WEAR_LEVELING_MAP))
 // for request pool
-#define REQ_POOL_ADDR						(GC_VICTIM_MAP_ADDR + sizeof(GC_VICTIM_MAP))
+#define REQ_POOL_ADDR						(WRITE_TEMPERATURE_MAP_ADDR + sizeof(WRITE_TEMPERATURE_MAP))
 // for dependency table
 #define ROW_ADDR_DEPENDENCY_TABLE_ADDR		(REQ_POOL_ADDR + sizeof(REQ_POOL))
 // for request scheduler
 #define DIE_STATE_TABLE_ADDR				(ROW_ADDR_DEPENDENCY_TABLE_ADDR + sizeof(ROW_ADDR_DEPENDENCY_TABLE))
 #define RETRY_LIMIT_TABLE_ADDR				(DIE_STATE_TABLE_ADDR + sizeof(DIE_STATE_TABLE))
 #define WAY_PRIORITY_TABLE_ADDR 			(RETRY_LIMIT_TABLE_ADDR + sizeof(RETRY_LIMIT_TABLE))
+#define SUSPEND_STAT_TABLE_ADDR				(WAY_PRIORITY_TABLE_ADDR + sizeof(WAY_PRIORITY_TABLE))
+#define OVERTAKE_STAT_TABLE_ADDR			(SUSPEND_STAT_TABLE_ADDR + sizeof(SUSPEND_STAT_TABLE))
+// for map checkpoints
+#define CHECKPOINT_MAP_ADDR					(OVERTAKE_STAT_TABLE_ADDR + sizeof(OVERTAKE_STAT_TABLE))
 
-#define FTL_MANAGEMENT_END_ADDR				((WAY_PRIORITY_TABLE_ADDR + sizeof(WAY_PRIORITY_TABLE))- 1)
+#define FTL_MANAGEMENT_END_ADDR				((CHECKPOINT_MAP_ADDR + sizeof(CHECKPOINT_MAP))- 1)
 
 #define RESERVED1_START_ADDR				(FTL_MANAGEMENT_END_ADDR + 1)
 #define RESERVED1_END_ADDR					0x3FFFFFFF
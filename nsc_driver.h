@@ -31,7 +31,7 @@
 // Module Name: NAND Storage Controller Driver
 // File Name: nsc_driver.h
 //
-// Version: v1.2.0
+// Version: v1.5.0
 //
 // Description:
 //   - define parameters, data structure and functions of NAND storage controller driver
@@ -40,6 +40,15 @@
 //////////////////////////////////////////////////////////////////////////////////
 // Revision History:
 //
+// * v1.5.0
+//   - program/erase suspend and resume entry points (SUPPORT_SUSPEND)
+//
+// * v1.4.0
+//   - cache program and cache read entry points (SUPPORT_CACHE_OPERATION)
+//
+// * v1.3.0
+//   - multi-plane read trigger, program and erase entry points (SUPPORT_MULTI_PLANE)
+//
 // * v1.2.0
 //   - Completion flag checker is added
 //   - Way ready checker is added
@@ -94,6 +103,22 @@
 #define T4NSC_CMD_FSP_PAGES (T4NSC_CMD_END_OF_COMMON+960)
 #define T4NSC_CMD_END_OF_PLAINOPS (T4NSC_CMD_END_OF_COMMON+1308)
 
+//the microcode of this release has no multi-plane command, a build with one sets SUPPORT_MULTI_PLANE
+//and provides the V2F*MultiPlaneAsync functions
+#ifndef SUPPORT_MULTI_PLANE
+#define SUPPORT_MULTI_PLANE 0
+#endif
+
+//neither has it cache program (80h-15h) and cache read (31h) sequences, see SUPPORT_MULTI_PLANE
+#ifndef SUPPORT_CACHE_OPERATION
+#define SUPPORT_CACHE_OPERATION 0
+#endif
+
+//nor program/erase suspend and resume
+#ifndef SUPPORT_SUSPEND
+#define SUPPORT_SUSPEND 0
+#endif
+
 #define V2FFillRegisters(t4regs, cmdtype, cmdpayload) (*((volatile cmdtype*)((t4regs)->t4regSP)) = (cmdpayload))
 #define V2FIssueCommand(t4regs) (((t4regs)->t4regCC)->issueCmd = 1)
 
@@ -445,5 +470,24 @@ void V2FReadIdAsync(T4REGS* t4regs, int way, unsigned int* statusReport, unsigne
 void V2FReadIdSync(T4REGS* t4regs, int way, unsigned int* statusReport);
 unsigned int V2FReadyBusyAsync(T4REGS* t4regs);
 
+#if SUPPORT_MULTI_PLANE
+void V2FReadPageTriggerMultiPlaneAsync(T4REGS* t4regs, int way, unsigned int rowAddress0, unsigned int rowAddress1);
+void V2FProgramPageMultiPlaneAsync(T4REGS* t4regs, int way, unsigned int rowAddress0, void* pageDataBuffer0, void* spareDataBuffer0, unsigned int rowAddress1, void* pageDataBuffer1, void* spareDataBuffer1);
+void V2FEraseBlockMultiPlaneAsync(T4REGS* t4regs, int way, unsigned int rowAddress0, unsigned int rowAddress1);
+#endif
+
+#if SUPPORT_CACHE_OPERATION
+//the way reports ready as soon as the cache register takes the next page, the array may still be programming
+void V2FProgramPageCacheAsync(T4REGS* t4regs, int way, unsigned int rowAddress, void* pageDataBuffer, void* spareDataBuffer);
+//the array senses nextRowAddress while the page of rowAddress is transferred out of the cache register
+void V2FReadPageTransferCacheAsync(T4REGS* t4regs, int way, void* pageDataBuffer, void* spareDataBuffer, unsigned int* errorInformation, unsigned int* completion, unsigned int rowAddress, unsigned int nextRowAddress);
+#endif
+
+#if SUPPORT_SUSPEND
+//the way reports ready when the running program or erase is suspended, both are ignored by an idle way
+void V2FSuspendAsync(T4REGS* t4regs, int way);
+void V2FResumeAsync(T4REGS* t4regs, int way);
+#endif
+
 
 #endif /* FMC_DRIVER_H_ */
@@ -31,7 +31,7 @@
 // Module Name: NVMe header
 // File Name: nvme.h
 //
-// Version: v1.0.1
+// Version: v1.0.2
 //
 // Description:
 //   - defines parameters and data structures of the NVMe controller
@@ -40,6 +40,9 @@
 //////////////////////////////////////////////////////////////////////////////////
 // Revision History:
 //
+// * v1.0.2
+//   - Dataset Management command dwords can be accessed as a whole
+//
 // * v1.0.1
 //   - Status code types are added
 //	 - Status codes are added
@@ -55,6 +58,7 @@
 #define MAX_NUM_OF_IO_CQ	8
 
 #define ADMIN_CMD_DRAM_DATA_BUFFER		0x00200000
+#define IO_CMD_DRAM_DATA_BUFFER			0x00201000	//Dataset Management range list
 
 #define STORAGE_CAPACITY_L				0x00000000	// not used
 #define STORAGE_CAPACITY_H				0x00000000
@@ -190,6 +194,15 @@
 #define Timestamp											0x0E
 #define SOFTWARE_PROGRESS_MARKER							0x80
 
+/* Set/Get Features - Vendor Specific Features Identifiers */
+
+#define VENDOR_FEATURE_GC_POLICY							0xC0	//dword11[7:0]: GC_POLICY_*, dword11[8]: GC_COPY_TARGET_* of garbage_collection.h
+#define VENDOR_FEATURE_BUF_POLICY							0xC1	//dword11[7:0]: DATA_BUF_POLICY_* of data_buffer.h
+
+/* Get Log Page - Vendor Specific Log Page Identifiers */
+
+#define VENDOR_LOG_WRITE_TEMPERATURE						0xC0	//WRITE_TEMPERATURE_LOG of write_temperature.h
+
 
 #define NVME_TASK_IDLE										0x0
 #define NVME_TASK_WAIT_CC_EN								0x1
@@ -765,17 +778,27 @@ typedef struct _IO_READ_COMMAND_DW15
 /* IO Dataset Management Command */
 typedef struct _IO_DATASET_MANAGEMENT_COMMAND_DW10
 {
-	unsigned int NR							:8;
-	unsigned int reserved0					:24;
-} _IO_DATASET_MANAGEMENT_COMMAND_DW10;
+	union {
+		unsigned int dword;
+		struct {
+			unsigned int NR						:8;
+			unsigned int reserved0				:24;
+		};
+	};
+} IO_DATASET_MANAGEMENT_COMMAND_DW10;
 
 typedef struct _IO_DATASET_MANAGEMENT_COMMAND_DW11
 {
-	unsigned int IDR						:1;
-	unsigned int IDW						:1;
-	unsigned int AD							:1;
-	unsigned int reserved0					:29;
-} _IO_DATASET_MANAGEMENT_COMMAND_DW11;
+	union {
+		unsigned int dword;
+		struct {
+			unsigned int IDR					:1;
+			unsigned int IDW					:1;
+			unsigned int AD						:1;
+			unsigned int reserved0				:29;
+		};
+	};
+} IO_DATASET_MANAGEMENT_COMMAND_DW11;
 
 typedef struct _DATASET_MANAGEMENT_CONTEXT_ATTRIBUTES
 {
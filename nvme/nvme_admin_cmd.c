@@ -54,6 +54,9 @@
 #include "host_lld.h"
 #include "nvme_identify.h"
 #include "nvme_admin_cmd.h"
+#include "../garbage_collection.h"
+#include "../data_buffer.h"
+#include "../write_temperature.h"
 
 extern NVME_CONTEXT g_nvmeTask;
 
@@ -92,6 +95,7 @@ unsigned int get_num_of_queue(unsigned int dword11)
 void handle_set_features(NVME_ADMIN_COMMAND *nvmeAdminCmd, NVME_COMPLETION *nvmeCPL)
 {
 	ADMIN_SET_FEATURES_DW10 features;
+	NVME_COMPLETION cpl;
 
 	features.dword = nvmeAdminCmd->dword10;
 
@@ -141,6 +145,26 @@ void handle_set_features(NVME_ADMIN_COMMAND *nvmeAdminCmd, NVME_COMPLETION *nvme
 			nvmeCPL->specific = 0x0;
 			break;
 		}
+		case VENDOR_FEATURE_GC_POLICY:
+		{
+			cpl.dword[0] = 0x0;
+			if(SetGcPolicy(nvmeAdminCmd->dword11 & 0xFF))
+				SetGcCopyTarget((nvmeAdminCmd->dword11 >> 8) & 0x1);
+			else
+				cpl.statusField.SC = SC_INVALID_FIELD_IN_COMMAND;
+			nvmeCPL->dword[0] = cpl.dword[0];
+			nvmeCPL->specific = GetGcPolicy() | (GetGcCopyTarget() << 8);
+			break;
+		}
+		case VENDOR_FEATURE_BUF_POLICY:
+		{
+			cpl.dword[0] = 0x0;
+			if(!SetDataBufPolicy(nvmeAdminCmd->dword11 & 0xFF))
+				cpl.statusField.SC = SC_INVALID_FIELD_IN_COMMAND;
+			nvmeCPL->dword[0] = cpl.dword[0];
+			nvmeCPL->specific = GetDataBufPolicy();
+			break;
+		}
 		default:
 		{
 			xil_printf("Not Support FID (Set): %X\r\n", features.FID);
@@ -202,6 +226,18 @@ void handle_get_features(NVME_ADMIN_COMMAND *nvmeAdminCmd, NVME_COMPLETION *nvme
 			nvmeCPL->specific = 0x0;
 			break;
 		}
+		case VENDOR_FEATURE_GC_POLICY:
+		{
+			nvmeCPL->dword[0] = 0x0;
+			nvmeCPL->specific = GetGcPolicy() | (GetGcCopyTarget() << 8);
+			break;
+		}
+		case VENDOR_FEATURE_BUF_POLICY:
+		{
+			nvmeCPL->dword[0] = 0x0;
+			nvmeCPL->specific = GetDataBufPolicy();
+			break;
+		}
 		default:
 		{
 			xil_printf("Not Support FID (Get): %X\r\n", features.FID);
@@ -381,33 +417,52 @@ void handle_identify(NVME_ADMIN_COMMAND *nvmeAdminCmd, NVME_COMPLETION *nvmeCPL)
 
 void handle_get_log_page(NVME_ADMIN_COMMAND *nvmeAdminCmd, NVME_COMPLETION *nvmeCPL)
 {
-	//ADMIN_GET_LOG_PAGE_DW10 getLogPageInfo;
+	ADMIN_GET_LOG_PAGE_DW10 getLogPageInfo;
+	unsigned int pLogData = ADMIN_CMD_DRAM_DATA_BUFFER;
+	unsigned int prp[2];
+	unsigned int prpLen, logLen;
 
-	//unsigned int prp1[2];
-	//unsigned int prp2[2];
-	//unsigned int prpLen;
+	getLogPageInfo.dword = nvmeAdminCmd->dword10;
 
-	//getLogPageInfo.dword = nvmeAdminCmd->dword10;
+	//LID
+	//Mandatory//1-Error information, 2-SMART/Health information, 3-Firmware Slot information
+	//Optional//4-ChangedNamespaceList, 5-Command Effects Log
+	if(getLogPageInfo.LID != VENDOR_LOG_WRITE_TEMPERATURE)
+	{
+		nvmeCPL->dword[0] = 0;
+		nvmeCPL->specific = 0x9;//invalid log page
+		return;
+	}
 
-	//prp1[0] = nvmeAdminCmd->PRP1[0];
-	//prp1[1] = nvmeAdminCmd->PRP1[1];
-	//prpLen = 0x1000 - (prp1[0] & 0xFFF);
+	memset((void*)pLogData, 0, 0x1000);
+	GetWriteTemperatureLog((P_WRITE_TEMPERATURE_LOG)pLogData);
 
-	//prp2[0] = nvmeAdminCmd->PRP2[0];
-	//prp2[1] = nvmeAdminCmd->PRP2[1];
+	//the log page is zero padded to the dwords requested, up to a memory page
+	logLen = (getLogPageInfo.NUMD + 1) * 4;
+	if(logLen > 0x1000)
+		logLen = 0x1000;
 
-	//xil_printf("ADMIN GET LOG PAGE\n");
+	prp[0] = nvmeAdminCmd->PRP1[0];
+	prp[1] = nvmeAdminCmd->PRP1[1];
 
-	//LID
-	//Mandatory//1-Error information, 2-SMART/Health information, 3-Firmware Slot information
-	//Optional//4-ChangedNamespaceList, 5-Command Effects Log
-	//xil_printf("LID: 0x%X, NUMD: 0x%X \r\n", getLogPageInfo.LID, getLogPageInfo.NUMD);
+	prpLen = 0x1000 - (prp[0] & 0xFFF);
+	if(prpLen > logLen)
+		prpLen = logLen;
+	set_direct_tx_dma(pLogData, prp[1], prp[0], prpLen);
+	if(prpLen != logLen)
+	{
+		pLogData = pLogData + prpLen;
+		prpLen = logLen - prpLen;
+		prp[0] = nvmeAdminCmd->PRP2[0];
+		prp[1] = nvmeAdminCmd->PRP2[1];
 
-	//xil_printf("PRP1[63:32] = 0x%X, PRP1[31:0] = 0x%X", prp1[1], prp1[0]);
-	//xil_printf("PRP2[63:32] = 0x%X, PRP2[31:0] = 0x%X", prp2[1], prp2[0]);
+		set_direct_tx_dma(pLogData, prp[1], prp[0], prpLen);
+	}
+
+	check_direct_tx_dma_done();
 
 	nvmeCPL->dword[0] = 0;
-	nvmeCPL->specific = 0x9;//invalid log page
+	nvmeCPL->specific = 0x0;
 }
 
 void handle_nvme_admin_cmd(NVME_COMMAND *nvmeCmd)
@@ -32,7 +32,7 @@
 // Module Name: NVMe Identifier
 // File Name: nvme_identify.c
 //
-// Version: v1.0.1
+// Version: v1.0.2
 //
 // Description:
 //   - generates data buffers that describes information about NVMe controller or namespace
@@ -41,6 +41,9 @@
 //////////////////////////////////////////////////////////////////////////////////
 // Revision History:
 //
+// * v1.0.2
+//   - Dataset Management is reported in ONCS
+//
 // * v1.0.1
 //   - Storage size (storageCapacity_L) is determined by FTL
 //
@@ -114,7 +117,7 @@ void identify_controller(unsigned int pBuffer)
 
 	identifyCNTL->ONCS.supportsCompare = 0x0;
 	identifyCNTL->ONCS.supportsWriteUncorrectable = 0x0;
-	identifyCNTL->ONCS.supportsDataSetManagement = 0x0;
+	identifyCNTL->ONCS.supportsDataSetManagement = 0x1;
 
 	identifyCNTL->FUSES.supportsCompareWrite = 0x0;
 
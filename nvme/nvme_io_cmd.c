@@ -33,7 +33,7 @@
 // Module Name: NVMe IO Command Handler
 // File Name: nvme_io_cmd.c
 //
-// Version: v1.0.1
+// Version: v1.0.3
 //
 // Description:
 //   - handles NVMe IO command
@@ -42,6 +42,12 @@
 //////////////////////////////////////////////////////////////////////////////////
 // Revision History:
 //
+// * v1.0.3
+//   - flush completes when dirty buffer entries are programmed, FUA writes are written through
+//
+// * v1.0.2
+//   - Dataset Management deallocates the slices covered by its ranges
+//
 // * v1.0.1
 //   - header file for buffer is changed from "ia_lru_buffer.h" to "lru_buffer.h"
 //
@@ -60,6 +66,8 @@
 
 #include "../ftl_config.h"
 #include "../request_transform.h"
+#include "../address_translation.h"
+#include "../write_back.h"
 
 void handle_nvme_io_read(unsigned int cmdSlotTag, NVME_IO_COMMAND *nvmeIOCmd)
 {
@@ -98,13 +106,13 @@ void handle_nvme_io_write(unsigned int cmdSlotTag, NVME_IO_COMMAND *nvmeIOCmd)
 	//writeInfo13.dword = nvmeIOCmd->dword[13];
 	//writeInfo15.dword = nvmeIOCmd->dword[15];
 
-	//if(writeInfo12.FUA == 1)
-	//	xil_printf("write FUA\r\n");
-
 	startLba[0] = nvmeIOCmd->dword[10];
 	startLba[1] = nvmeIOCmd->dword[11];
 	nlb = writeInfo12.NLB;
 
+	if(writeInfo12.FUA == 1)
+		StartFuaWrite(cmdSlotTag, startLba[0], nlb);
+
 	ASSERT(startLba[0] < storageCapacity_L && (startLba[1] < STORAGE_CAPACITY_H || startLba[1] == 0));
 	//ASSERT(nlb < MAX_NUM_OF_NLB);
 	ASSERT((nvmeIOCmd->PRP1[0] & 0xF) == 0 && (nvmeIOCmd->PRP2[0] & 0xF) == 0);
@@ -113,10 +121,54 @@ void handle_nvme_io_write(unsigned int cmdSlotTag, NVME_IO_COMMAND *nvmeIOCmd)
 	ReqTransNvmeToSlice(cmdSlotTag, startLba[0], nlb, IO_NVM_WRITE);
 }
 
+//only slices covered as a whole are deallocated, partial slices keep their data
+void handle_nvme_io_dataset_management(unsigned int cmdSlotTag, NVME_IO_COMMAND *nvmeIOCmd)
+{
+	IO_DATASET_MANAGEMENT_COMMAND_DW10 dsmInfo10;
+	IO_DATASET_MANAGEMENT_COMMAND_DW11 dsmInfo11;
+	DATASET_MANAGEMENT_RANGE* dsmRange;
+	unsigned int prp[2];
+	unsigned int prpLen, rangeLen, rangeNo, startLba, endLba, logicalSliceAddr;
+
+	dsmInfo10.dword = nvmeIOCmd->dword[10];
+	dsmInfo11.dword = nvmeIOCmd->dword[11];
+
+	if(dsmInfo11.AD)
+	{
+		rangeLen = (dsmInfo10.NR + 1) * sizeof(DATASET_MANAGEMENT_RANGE);
+		prp[0] = nvmeIOCmd->PRP1[0];
+		prp[1] = nvmeIOCmd->PRP1[1];
+
+		prpLen = 0x1000 - (prp[0] & 0xFFF);
+		if(prpLen > rangeLen)
+			prpLen = rangeLen;
+		set_direct_rx_dma(IO_CMD_DRAM_DATA_BUFFER, prp[1], prp[0], prpLen);
+		if(prpLen != rangeLen)
+			set_direct_rx_dma(IO_CMD_DRAM_DATA_BUFFER + prpLen, nvmeIOCmd->PRP2[1], nvmeIOCmd->PRP2[0], rangeLen - prpLen);
+		check_direct_rx_dma_done();
+
+		dsmRange = (DATASET_MANAGEMENT_RANGE*)IO_CMD_DRAM_DATA_BUFFER;
+		for(rangeNo = 0; rangeNo <= dsmInfo10.NR; rangeNo++)
+		{
+			if(dsmRange[rangeNo].startingLBA[1] || (dsmRange[rangeNo].startingLBA[0] >= storageCapacity_L))
+				continue;
+
+			startLba = dsmRange[rangeNo].startingLBA[0];
+			endLba = startLba + dsmRange[rangeNo].lengthInLogicalBlocks;
+			if((endLba > storageCapacity_L) || (endLba < startLba))
+				endLba = storageCapacity_L;
+
+			for(logicalSliceAddr = (startLba + NVME_BLOCKS_PER_SLICE - 1) / NVME_BLOCKS_PER_SLICE; logicalSliceAddr < endLba / NVME_BLOCKS_PER_SLICE; logicalSliceAddr++)
+				AddrTransTrim(logicalSliceAddr);
+		}
+	}
+
+	set_auto_nvme_cpl(cmdSlotTag, 0, 0);
+}
+
 void handle_nvme_io_cmd(NVME_COMMAND *nvmeCmd)
 {
 	NVME_IO_COMMAND *nvmeIOCmd;
-	NVME_COMPLETION nvmeCPL;
 	unsigned int opc;
 	nvmeIOCmd = (NVME_IO_COMMAND*)nvmeCmd->cmdDword;
 	/*		xil_printf("OPC = 0x%X\r\n", nvmeIOCmd->OPC);
@@ -134,9 +186,7 @@ void handle_nvme_io_cmd(NVME_COMMAND *nvmeCmd)
 		case IO_NVM_FLUSH:
 		{
 		//	xil_printf("IO Flush Command\r\n");
-			nvmeCPL.dword[0] = 0;
-			nvmeCPL.specific = 0x0;
-			set_auto_nvme_cpl(nvmeCmd->cmdSlotTag, nvmeCPL.specific, nvmeCPL.statusFieldWord);
+			FlushDataBuf(nvmeCmd->cmdSlotTag);
 			break;
 		}
 		case IO_NVM_WRITE:
@@ -151,6 +201,11 @@ void handle_nvme_io_cmd(NVME_COMMAND *nvmeCmd)
 			handle_nvme_io_read(nvmeCmd->cmdSlotTag, nvmeIOCmd);
 			break;
 		}
+		case IO_NVM_DATASET_MANAGEMENT:
+		{
+			handle_nvme_io_dataset_management(nvmeCmd->cmdSlotTag, nvmeIOCmd);
+			break;
+		}
 		default:
 		{
 			xil_printf("Not Support IO Command OPC: %X\r\n", opc);
@@ -35,7 +35,7 @@
 // Module Name: NVMe Main
 // File Name: nvme_main.c
 //
-// Version: v1.2.0
+// Version: v1.6.1
 //
 // Description:
 //   - initializes FTL and NAND
@@ -45,6 +45,21 @@
 //////////////////////////////////////////////////////////////////////////////////
 // Revision History:
 //
+// * v1.6.1
+//   - shutdown is reported complete after the buffered data, the maps and the bad block table are saved
+//
+// * v1.6.0
+//   - free blocks left unerased by a format are erased in the idle loop
+//
+// * v1.5.0
+//   - the maps are checkpointed in the idle loop and at shutdown
+//
+// * v1.4.0
+//   - dirty data buffer entries are written back in the idle loop
+//
+// * v1.3.0
+//   - the GC policy selected by SetGcPolicy runs through GcScheduler
+//
 // * v1.2.0
 //   - header file for buffer is changed from "ia_lru_buffer.h" to "lru_buffer.h"
 //   - Low level scheduler execution is allowed when there is no i/o command
@@ -135,12 +150,17 @@ void nvme_main()
 
 				set_nvme_admin_queue(0, 0, 0);
 				g_nvmeTask.cacheEn = 0;
-				set_nvme_csts_shst(2);
-				g_nvmeTask.status = NVME_TASK_WAIT_RESET;
+
+				//write back buffered data and save the maps, the host may cut the power once shutdown is reported complete
+				WriteBackAllDataBuf();
+				SaveCheckpoint();
 
 				//flush grown bad block info
 				UpdateBadBlockTableForGrownBadBlock(RESERVED_DATA_BUFFER_BASE_ADDR);
 
+				set_nvme_csts_shst(2);
+				g_nvmeTask.status = NVME_TASK_WAIT_RESET;
+
 				xil_printf("\r\nNVMe shutdown!!!\r\n");
 			}
 		}
@@ -191,8 +211,14 @@ void nvme_main()
 
 		}
 
-		//GcScheduler();
-		CheckAndRunOriginalGc();
+		if(exeLlr)
+		{
+			WriteBackScheduler();
+			CheckpointScheduler();
+			LazyEraseScheduler();
+		}
+
+		GcScheduler();
 	}
 }
 
@@ -30,7 +30,7 @@
 // Module Name: Request Allocator
 // File Name: request_allocation.c
 //
-// Version: v1.0.0
+// Version: v1.0.6
 //
 // Description:
 //   - allocate requests to each request queue
@@ -39,6 +39,24 @@
 //////////////////////////////////////////////////////////////////////////////////
 // Revision History:
 //
+// * v1.0.6
+//   - completed GC copy programs are reported to the garbage collector
+//
+// * v1.0.5
+//   - completed NAND requests are reported to the checkpoint
+//
+// * v1.0.4
+//   - NAND request queues count their requests per class (NandReqClass)
+//
+// * v1.0.3
+//   - MoveToNandReqQHead lets a read overtake a suspended program or erase
+//
+// * v1.0.2
+//   - fill reads are merged into their data buffer entry before dependent requests are released
+//
+// * v1.0.1
+//   - finished programs of data buffer entries are reported to the write-back engine
+//
 // * v1.0.0
 //   - First draft
 //////////////////////////////////////////////////////////////////////////////////
@@ -60,7 +78,7 @@ unsigned int blockedReqCnt;
 
 void InitReqPool()
 {
-	int chNo, wayNo, reqSlotTag;
+	int chNo, wayNo, reqSlotTag, reqClass;
 
 	reqPoolPtr = (P_REQ_POOL) REQ_POOL_ADDR; //revise address
 
@@ -89,6 +107,8 @@ void InitReqPool()
 			nandReqQ[chNo][wayNo].headReq = REQ_SLOT_TAG_NONE;
 			nandReqQ[chNo][wayNo].tailReq = REQ_SLOT_TAG_NONE;
 			nandReqQ[chNo][wayNo].reqCnt = 0;
+			for(reqClass = 0; reqClass < NAND_REQ_CLASS_COUNT; reqClass++)
+				nandReqQ[chNo][wayNo].classReqCnt[reqClass] = 0;
 		}
 
 	for(reqSlotTag = 0; reqSlotTag < AVAILABLE_OUNTSTANDING_REQ_COUNT; reqSlotTag++)
@@ -395,9 +415,58 @@ void PutToNandReqQ(unsigned int reqSlotTag, unsigned chNo, unsigned wayNo)
 
 	reqPoolPtr->reqPool[reqSlotTag].reqQueueType = REQ_QUEUE_TYPE_NAND;
 	nandReqQ[chNo][wayNo].reqCnt++;
+	nandReqQ[chNo][wayNo].classReqCnt[NandReqClass(reqSlotTag)]++;
 	notCompletedNandReqCnt++;
 }
 
+void MoveToNandReqQHead(unsigned int reqSlotTag, unsigned int chNo, unsigned int wayNo)
+{
+	if(nandReqQ[chNo][wayNo].headReq == reqSlotTag)
+		return;
+
+	reqPoolPtr->reqPool[reqPoolPtr->reqPool[reqSlotTag].prevReq].nextReq = reqPoolPtr->reqPool[reqSlotTag].nextReq;
+	if(reqPoolPtr->reqPool[reqSlotTag].nextReq != REQ_SLOT_TAG_NONE)
+		reqPoolPtr->reqPool[reqPoolPtr->reqPool[reqSlotTag].nextReq].prevReq = reqPoolPtr->reqPool[reqSlotTag].prevReq;
+	else
+		nandReqQ[chNo][wayNo].tailReq = reqPoolPtr->reqPool[reqSlotTag].prevReq;
+
+	reqPoolPtr->reqPool[reqSlotTag].prevReq = REQ_SLOT_TAG_NONE;
+	reqPoolPtr->reqPool[reqSlotTag].nextReq = nandReqQ[chNo][wayNo].headReq;
+	reqPoolPtr->reqPool[nandReqQ[chNo][wayNo].headReq].prevReq = reqSlotTag;
+	nandReqQ[chNo][wayNo].headReq = reqSlotTag;
+}
+
+//host requests use data buffer entries and GC copies use temporary entries, the class does not change
+//while the code of a request moves through its read, multi-plane and cache variants
+unsigned int NandReqClass(unsigned int reqSlotTag)
+{
+	unsigned int reqCode, dataBufFormat;
+
+	if(reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandAddr != REQ_OPT_NAND_ADDR_VSA)
+		return NAND_REQ_CLASS_OTHER;
+
+	reqCode = reqPoolPtr->reqPool[reqSlotTag].reqCode;
+	dataBufFormat = reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufFormat;
+	if((reqCode == REQ_CODE_ERASE) || (reqCode == REQ_CODE_MULTI_PLANE_ERASE))
+		return NAND_REQ_CLASS_ERASE;
+	if((reqCode == REQ_CODE_READ) || (reqCode == REQ_CODE_READ_TRANSFER) || (reqCode == REQ_CODE_MULTI_PLANE_READ))
+	{
+		if(dataBufFormat == REQ_OPT_DATA_BUF_ENTRY)
+			return NAND_REQ_CLASS_HOST_READ;
+		if(dataBufFormat == REQ_OPT_DATA_BUF_TEMP_ENTRY)
+			return NAND_REQ_CLASS_GC_READ;
+	}
+	else if((reqCode == REQ_CODE_WRITE) || (reqCode == REQ_CODE_MULTI_PLANE_WRITE) || (reqCode == REQ_CODE_CACHE_WRITE))
+	{
+		if(dataBufFormat == REQ_OPT_DATA_BUF_ENTRY)
+			return NAND_REQ_CLASS_HOST_WRITE;
+		if(dataBufFormat == REQ_OPT_DATA_BUF_TEMP_ENTRY)
+			return NAND_REQ_CLASS_GC_WRITE;
+	}
+
+	return NAND_REQ_CLASS_OTHER;
+}
+
 void GetFromNandReqQ(unsigned int chNo, unsigned int wayNo, unsigned int reqStatus, unsigned int reqCode)
 {
 	unsigned int reqSlotTag;
@@ -419,8 +488,17 @@ void GetFromNandReqQ(unsigned int chNo, unsigned int wayNo, unsigned int reqStat
 
 	reqPoolPtr->reqPool[reqSlotTag].reqQueueType = REQ_QUEUE_TYPE_NONE;
 	nandReqQ[chNo][wayNo].reqCnt--;
+	nandReqQ[chNo][wayNo].classReqCnt[NandReqClass(reqSlotTag)]--;
 	notCompletedNandReqCnt--;
 
+	CheckpointReqDone(reqSlotTag);
+	if(NandReqClass(reqSlotTag) == NAND_REQ_CLASS_GC_WRITE)
+		GcCopyProgramDone(reqSlotTag);
+	if((reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_WRITE) && (reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufFormat == REQ_OPT_DATA_BUF_ENTRY))
+		WriteBackDone(reqSlotTag);
+	else if((reqPoolPtr->reqPool[reqSlotTag].reqCode != REQ_CODE_WRITE) && (reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufFormat == REQ_OPT_DATA_BUF_ENTRY) && reqPoolPtr->reqPool[reqSlotTag].reqOpt.fillBlockMask)
+		MergeDataBufEntry(reqSlotTag);
+
 	PutToFreeReqQ(reqSlotTag);
 	ReleaseBlockedByBufDepReq(reqSlotTag);
 }
@@ -30,7 +30,7 @@
 // Module Name: Request Allocator
 // File Name: request_allocation.h
 //
-// Version: v1.0.0
+// Version: v1.0.2
 //
 // Description:
 //   - define parameters, data structure and functions of request allocator
@@ -39,6 +39,12 @@
 //////////////////////////////////////////////////////////////////////////////////
 // Revision History:
 //
+// * v1.0.2
+//   - NAND requests are classified for the die scheduler
+//
+// * v1.0.1
+//   - a NAND request can be moved to the head of its die queue
+//
 // * v1.0.0
 //   - First draft
 //////////////////////////////////////////////////////////////////////////////////
@@ -79,6 +85,8 @@ void SelectiveGetFromNvmeDmaReqQ(unsigned int regSlotTag);
 
 void PutToNandReqQ(unsigned int reqSlotTag, unsigned chNo, unsigned wayNo);
 void GetFromNandReqQ(unsigned int chNo, unsigned int wayNo, unsigned int reqStatus, unsigned int reqCode);
+void MoveToNandReqQHead(unsigned int reqSlotTag, unsigned int chNo, unsigned int wayNo);
+unsigned int NandReqClass(unsigned int reqSlotTag);
 
 extern P_REQ_POOL reqPoolPtr;
 extern FREE_REQUEST_QUEUE freeReqQ;
@@ -30,7 +30,7 @@
 // Module Name: Request Allocator
 // File Name: request_format.h
 //
-// Version: v1.0.0
+// Version: v1.0.6
 //
 // Description:
 //   - define parameters, data structure of request
@@ -39,6 +39,24 @@
 //////////////////////////////////////////////////////////////////////////////////
 // Revision History:
 //
+// * v1.0.6
+//   - requests a checkpoint waits for before its header is programmed (checkpointReq, checkpointGen)
+//
+// * v1.0.5
+//   - write sequence of a program of a mapped slice (writeSeq)
+//
+// * v1.0.4
+//   - cache program request code
+//
+// * v1.0.3
+//   - multi-plane request codes
+//
+// * v1.0.2
+//   - fill reads of partially valid data buffer entries (fillBlockMask)
+//
+// * v1.0.1
+//   - FUA and write-back generation options for programs of data buffer entries
+//
 // * v1.0.0
 //   - First draft
 //////////////////////////////////////////////////////////////////////////////////
@@ -64,6 +82,10 @@
 #define REQ_CODE_READ				0x08
 #define REQ_CODE_READ_TRANSFER		0x09
 #define REQ_CODE_ERASE				0x0C
+#define REQ_CODE_MULTI_PLANE_WRITE	0x01	//a head NAND request executing together with the request behind it
+#define REQ_CODE_MULTI_PLANE_READ	0x0A
+#define REQ_CODE_MULTI_PLANE_ERASE	0x0B
+#define REQ_CODE_CACHE_WRITE		0x02	//a program whose page may still be in the array when it reports ready
 #define REQ_CODE_RESET				0x0D
 #define REQ_CODE_SET_FEATURE		0x0E
 #define REQ_CODE_FLUSH				0x0F
@@ -99,6 +121,13 @@
 #define REQ_OPT_BLOCK_SPACE_MAIN	0
 #define REQ_OPT_BLOCK_SPACE_TOTAL 	1
 
+#define REQ_OPT_FORCE_UNIT_ACCESS_OFF	0
+#define REQ_OPT_FORCE_UNIT_ACCESS_ON	1
+
+#define REQ_OPT_CHECKPOINT_REQ_NONE		0
+#define REQ_OPT_CHECKPOINT_REQ_FENCED	1	//a program or erase of a user block, a staged map may refer to its result
+#define REQ_OPT_CHECKPOINT_REQ_PAGE		2	//a program of a staged checkpoint page
+
 #define LOGICAL_SLICE_ADDR_NONE 	0xffffffff
 
 typedef struct _DATA_BUF_INFO{
@@ -131,6 +160,7 @@ typedef struct _NAND_INFO{
 	};
 	union {
 		unsigned int programmedPageCnt;
+		unsigned int writeSeq;		//stamped into the spare tag of a VSA program
 		struct {
 			unsigned int physicalPage : 16;
 			unsigned int phyReserved1 : 16;
@@ -146,7 +176,12 @@ typedef struct _REQ_OPTION{
 	unsigned int nandEccWarning : 1;
 	unsigned int rowAddrDependencyCheck : 1;
 	unsigned int blockSpace : 1;
-	unsigned int reserved0 : 24;
+	unsigned int forceUnitAccess : 1;
+	unsigned int writeBackGen : 3;
+	unsigned int fillBlockMask : 8;	//NVMe blocks of the data buffer entry taken from a NAND read, 0 reads the whole slice into it
+	unsigned int checkpointReq : 2;
+	unsigned int checkpointGen : 1;
+	unsigned int reserved0 : 9;
 } REQ_OPTION, *P_REQ_OPTION;
 
 
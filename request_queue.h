@@ -30,7 +30,7 @@
 // Module Name: Request Allocator
 // File Name: request_queue.h
 //
-// Version: v1.0.0
+// Version: v1.1.0
 //
 // Description:
 //   - define data structure of request queue
@@ -39,12 +39,22 @@
 //////////////////////////////////////////////////////////////////////////////////
 // Revision History:
 //
+// * v1.1.0
+//   - NAND request queues count their requests per class
+//
 // * v1.0.0
 //   - First draft
 //////////////////////////////////////////////////////////////////////////////////
 #ifndef REQUEST_QUEUE_H_
 #define REQUEST_QUEUE_H_
 
+#define NAND_REQ_CLASS_HOST_READ	0
+#define NAND_REQ_CLASS_HOST_WRITE	1
+#define NAND_REQ_CLASS_GC_READ		2
+#define NAND_REQ_CLASS_GC_WRITE		3
+#define NAND_REQ_CLASS_ERASE		4
+#define NAND_REQ_CLASS_OTHER		5	//physical addressing, reset and set feature, never reordered
+#define NAND_REQ_CLASS_COUNT		6
 
 typedef struct _FREE_REQUEST_QUEUE
 {
@@ -92,6 +102,7 @@ typedef struct _NAND_REQUEST_QUEUE
 	unsigned int tailReq : 16;
 	unsigned int reqCnt : 16;
 	unsigned int reserved0 : 16;
+	unsigned short classReqCnt[NAND_REQ_CLASS_COUNT];
 } NAND_REQUEST_QUEUE, *P_NAND_REQUEST_QUEUE;
 
 
@@ -31,7 +31,7 @@
 // Module Name: Request Scheduler
 // File Name: request_schedule.c
 //
-// Version: v1.0.0
+// Version: v1.5.2
 //
 // Description:
 //	 - decide request execution sequence
@@ -42,6 +42,33 @@
 //////////////////////////////////////////////////////////////////////////////////
 // Revision History:
 //
+// * v1.5.2
+//   - the host read search generates the row address of each scanned request once
+//
+// * v1.5.1
+//   - erases in the physical address space run as multi-plane operations as well
+//
+// * v1.5.0
+//   - a program of a mapped slice carries its logical slice and write sequence in the spare region
+//
+// * v1.4.0
+//   - a host read is moved in front of queued programs, GC reads and erases of an idle die
+//     that use other blocks, until the deadline of the overtaken class is reached
+//
+// * v1.3.0
+//   - a busy program or erase is suspended for host reads behind it (SUPPORT_SUSPEND)
+//
+// * v1.2.0
+//   - a program or a read transfer overlaps the array operation of the request behind it
+//     with cache program and cache read sequences (SUPPORT_CACHE_OPERATION)
+//
+// * v1.1.0
+//   - the head request of a die runs as one multi-plane operation with the request behind it
+//     when both access the same page of blocks in different planes (SUPPORT_MULTI_PLANE)
+//
+// * v1.0.1
+//   - fill reads of partially valid data buffer entries land in the fill buffer of the die
+//
 // * v1.0.0
 //   - First draft
 //////////////////////////////////////////////////////////////////////////////////
@@ -58,6 +85,18 @@ P_RETRY_LIMIT_TABLE retryLimitTablePtr;
 
 P_DIE_STATE_TABLE dieStateTablePtr;
 P_WAY_PRIORITY_TABLE wayPriorityTablePtr;
+P_SUSPEND_STAT_TABLE suspendStatTablePtr;
+P_OVERTAKE_STAT_TABLE overtakeStatTablePtr;
+
+//host reads that may be moved in front of a queued request of each class
+static const unsigned char nandReqClassDeadline[NAND_REQ_CLASS_COUNT] = {
+	0, NAND_HOST_WRITE_DEADLINE, NAND_GC_READ_DEADLINE, NAND_GC_WRITE_DEADLINE, NAND_ERASE_DEADLINE, 0
+};
+
+static void OvertakeNandReq(unsigned int chNo, unsigned int wayNo);
+#if SUPPORT_SUSPEND
+static unsigned int SuspendNandReq(unsigned int chNo, unsigned int wayNo);
+#endif
 
 void InitReqScheduler()
 {
@@ -70,6 +109,8 @@ void InitReqScheduler()
 
 	dieStateTablePtr = (P_DIE_STATE_TABLE) DIE_STATE_TABLE_ADDR;
 	wayPriorityTablePtr = (P_WAY_PRIORITY_TABLE) WAY_PRIORITY_TABLE_ADDR;
+	suspendStatTablePtr = (P_SUSPEND_STAT_TABLE) SUSPEND_STAT_TABLE_ADDR;
+	overtakeStatTablePtr = (P_OVERTAKE_STAT_TABLE) OVERTAKE_STAT_TABLE_ADDR;
 
 	for(chNo=0; chNo<USER_CHANNELS; ++chNo)
 	{
@@ -92,9 +133,19 @@ void InitReqScheduler()
 		{
 			dieStateTablePtr->dieState[chNo][wayNo].dieState = DIE_STATE_IDLE;
 			dieStateTablePtr->dieState[chNo][wayNo].reqStatusCheckOpt = REQ_STATUS_CHECK_OPT_NONE;
+			dieStateTablePtr->dieState[chNo][wayNo].cacheOp = DIE_CACHE_OP_NONE;
+			dieStateTablePtr->dieState[chNo][wayNo].suspendOp = DIE_SUSPEND_NONE;
+			dieStateTablePtr->dieState[chNo][wayNo].suspendCnt = 0;
+			dieStateTablePtr->dieState[chNo][wayNo].overtakeCnt = 0;
 			dieStateTablePtr->dieState[chNo][wayNo].prevWay = wayNo - 1;
 			dieStateTablePtr->dieState[chNo][wayNo].nextWay = wayNo + 1;
 
+			suspendStatTablePtr->suspendStat[chNo][wayNo].suspendCnt = 0;
+			suspendStatTablePtr->suspendStat[chNo][wayNo].readCnt = 0;
+			suspendStatTablePtr->suspendStat[chNo][wayNo].limitCnt = 0;
+			overtakeStatTablePtr->overtakeStat[chNo][wayNo].overtakeCnt = 0;
+			overtakeStatTablePtr->overtakeStat[chNo][wayNo].deadlineCnt = 0;
+
 			completeFlagTablePtr->completeFlag[chNo][wayNo] = 0;
 			statusReportTablePtr->statusReport[chNo][wayNo] = 0;
 			retryLimitTablePtr->retryLimit[chNo][wayNo] = RETRY_LIMIT;
@@ -160,6 +211,7 @@ void SchedulingNandReqPerCh(unsigned int chNo)
 				nextWay = dieStateTablePtr->dieState[chNo][wayNo].nextWay;
 
 				SelectivGetFromNandIdleList(chNo, wayNo);
+				OvertakeNandReq(chNo, wayNo);
 				PutToNandWayPriorityTable(nandReqQ[chNo][wayNo].headReq, chNo, wayNo);
 				wayNo = nextWay;
 			}
@@ -192,7 +244,10 @@ void SchedulingNandReqPerCh(unsigned int chNo)
 						ReleaseBlockedByRowAddrDepReq(chNo, wayNo);
 
 					if(nandReqQ[chNo][wayNo].headReq != REQ_SLOT_TAG_NONE)
+					{
+						OvertakeNandReq(chNo, wayNo);
 						PutToNandWayPriorityTable(nandReqQ[chNo][wayNo].headReq, chNo, wayNo);
+					}
 					else
 					{
 						PutToNandIdleList(chNo, wayNo);
@@ -242,6 +297,13 @@ void SchedulingNandReqPerCh(unsigned int chNo)
 						if(V2FIsControllerBusy(&chCtlReg[chNo]))
 							return;
 					}
+#if SUPPORT_SUSPEND
+					else if(SuspendNandReq(chNo, wayNo))
+					{
+						if(V2FIsControllerBusy(&chCtlReg[chNo]))
+							return;
+					}
+#endif
 
 					wayNo = dieStateTablePtr->dieState[chNo][wayNo].nextWay;
 				}
@@ -639,6 +701,254 @@ void SelectiveGetFromNandStatusCheckList(unsigned int chNo, unsigned int wayNo)
 
 }
 
+#if SUPPORT_MULTI_PLANE
+//the request behind the head of a die queue joins it when it does the same operation on the same page of a block
+//in the other plane, both were released to the die queue so neither has to wait for anything else,
+//erases pair in any address space so that formatting the total block space runs on both planes
+static unsigned int FindPlaneReq(unsigned int reqSlotTag, unsigned int rowAddr)
+{
+	unsigned int planeReqSlotTag, planeRowAddr, reqCode;
+
+	reqCode = reqPoolPtr->reqPool[reqSlotTag].reqCode;
+	planeReqSlotTag = reqPoolPtr->reqPool[reqSlotTag].nextReq;
+	if((planeReqSlotTag == REQ_SLOT_TAG_NONE) || (reqPoolPtr->reqPool[planeReqSlotTag].reqCode != reqCode))
+		return REQ_SLOT_TAG_NONE;
+	if((reqCode != REQ_CODE_READ) && (reqCode != REQ_CODE_WRITE) && (reqCode != REQ_CODE_ERASE))
+		return REQ_SLOT_TAG_NONE;
+	if((reqCode != REQ_CODE_ERASE) &&
+			((reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandAddr != REQ_OPT_NAND_ADDR_VSA) || (reqPoolPtr->reqPool[planeReqSlotTag].reqOpt.nandAddr != REQ_OPT_NAND_ADDR_VSA)))
+		return REQ_SLOT_TAG_NONE;
+
+	planeRowAddr = GenerateNandRowAddr(planeReqSlotTag);
+	if((rowAddr / LUN_1_BASE_ADDR) != (planeRowAddr / LUN_1_BASE_ADDR))
+		return REQ_SLOT_TAG_NONE;
+	if(Pblock2PplaneTranslation(rowAddr / PAGES_PER_MLC_BLOCK) == Pblock2PplaneTranslation(planeRowAddr / PAGES_PER_MLC_BLOCK))
+		return REQ_SLOT_TAG_NONE;
+	if((reqCode != REQ_CODE_ERASE) && ((rowAddr % PAGES_PER_MLC_BLOCK) != (planeRowAddr % PAGES_PER_MLC_BLOCK)))
+		return REQ_SLOT_TAG_NONE;
+
+	return planeReqSlotTag;
+}
+
+//only the head carries the multi-plane code, the request behind it keeps its own
+static void IssueMultiPlaneNandReq(unsigned int chNo, unsigned int wayNo, unsigned int reqSlotTag, unsigned int planeReqSlotTag, unsigned int rowAddr)
+{
+	unsigned int planeRowAddr;
+
+	planeRowAddr = GenerateNandRowAddr(planeReqSlotTag);
+	dieStateTablePtr->dieState[chNo][wayNo].reqStatusCheckOpt = REQ_STATUS_CHECK_OPT_CHECK;
+
+	if(reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_READ)
+	{
+		reqPoolPtr->reqPool[reqSlotTag].reqCode = REQ_CODE_MULTI_PLANE_READ;
+		V2FReadPageTriggerMultiPlaneAsync(&chCtlReg[chNo], wayNo, rowAddr, planeRowAddr);
+	}
+	else if(reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_WRITE)
+	{
+		StampSliceSpareTag(planeReqSlotTag);
+
+		//buffer addresses of a program depend on its code
+		V2FProgramPageMultiPlaneAsync(&chCtlReg[chNo], wayNo, rowAddr, (void*)GenerateDataBufAddr(reqSlotTag), (void*)GenerateSpareDataBufAddr(reqSlotTag),
+				planeRowAddr, (void*)GenerateDataBufAddr(planeReqSlotTag), (void*)GenerateSpareDataBufAddr(planeReqSlotTag));
+		reqPoolPtr->reqPool[reqSlotTag].reqCode = REQ_CODE_MULTI_PLANE_WRITE;
+	}
+	else
+	{
+		reqPoolPtr->reqPool[reqSlotTag].reqCode = REQ_CODE_MULTI_PLANE_ERASE;
+		V2FEraseBlockMultiPlaneAsync(&chCtlReg[chNo], wayNo, rowAddr, planeRowAddr);
+	}
+}
+
+//gives the head its single-plane code back and returns the request that ran with it
+static unsigned int SplitMultiPlaneNandReq(unsigned int reqSlotTag)
+{
+	if(reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_MULTI_PLANE_READ)
+		reqPoolPtr->reqPool[reqSlotTag].reqCode = REQ_CODE_READ;
+	else if(reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_MULTI_PLANE_WRITE)
+		reqPoolPtr->reqPool[reqSlotTag].reqCode = REQ_CODE_WRITE;
+	else if(reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_MULTI_PLANE_ERASE)
+		reqPoolPtr->reqPool[reqSlotTag].reqCode = REQ_CODE_ERASE;
+	else
+		return REQ_SLOT_TAG_NONE;
+
+	return reqPoolPtr->reqPool[reqSlotTag].nextReq;
+}
+#endif
+
+#if SUPPORT_CACHE_OPERATION
+//the request behind a program or a read transfer that can use the cache register of the same LUN
+static unsigned int FindCacheReq(unsigned int reqSlotTag, unsigned int rowAddr, unsigned int cacheReqCode)
+{
+	unsigned int cacheReqSlotTag;
+
+	cacheReqSlotTag = reqPoolPtr->reqPool[reqSlotTag].nextReq;
+	if((cacheReqSlotTag == REQ_SLOT_TAG_NONE) || (reqPoolPtr->reqPool[cacheReqSlotTag].reqCode != cacheReqCode))
+		return REQ_SLOT_TAG_NONE;
+	if((reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandAddr != REQ_OPT_NAND_ADDR_VSA) || (reqPoolPtr->reqPool[cacheReqSlotTag].reqOpt.nandAddr != REQ_OPT_NAND_ADDR_VSA))
+		return REQ_SLOT_TAG_NONE;
+	if((rowAddr / LUN_1_BASE_ADDR) != (GenerateNandRowAddr(cacheReqSlotTag) / LUN_1_BASE_ADDR))
+		return REQ_SLOT_TAG_NONE;
+
+	return cacheReqSlotTag;
+}
+
+//the program behind a cache program moved into the page register, so the program before it has finished
+static void CompleteCacheProgram(unsigned int chNo, unsigned int wayNo, unsigned int reqStatus)
+{
+	unsigned int reqSlotTag;
+
+	if(dieStateTablePtr->dieState[chNo][wayNo].cacheOp == DIE_CACHE_OP_PROGRAM)
+		GetFromNandReqQ(chNo, wayNo, reqStatus, REQ_CODE_WRITE);
+
+	reqSlotTag = nandReqQ[chNo][wayNo].headReq;
+	if(reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_CACHE_WRITE)
+	{
+		reqPoolPtr->reqPool[reqSlotTag].reqCode = REQ_CODE_WRITE;
+		dieStateTablePtr->dieState[chNo][wayNo].cacheOp = DIE_CACHE_OP_PROGRAM;
+	}
+	else
+	{
+		dieStateTablePtr->dieState[chNo][wayNo].cacheOp = DIE_CACHE_OP_NONE;
+		GetFromNandReqQ(chNo, wayNo, reqStatus, REQ_CODE_WRITE);
+	}
+	retryLimitTablePtr->retryLimit[chNo][wayNo] = RETRY_LIMIT;
+}
+#endif
+
+//a host read behind the given queue head that reads no block used by a request in front of it,
+//so it depends on none of them: the page it reads was programmed and its block is not erased before it,
+//the blocks of the requests in front are gathered while scanning so each row address is generated once
+static unsigned int FindHostReadReq(unsigned int headReqSlotTag, unsigned int scanDepth)
+{
+	unsigned int aheadBlockNo[NAND_OVERTAKE_SCAN_DEPTH + 1];
+	unsigned int readReqSlotTag, blockNo, aheadCnt, aheadNo, scanCnt;
+
+	aheadBlockNo[0] = GenerateNandRowAddr(headReqSlotTag) / PAGES_PER_MLC_BLOCK;
+	aheadCnt = 1;
+
+	readReqSlotTag = reqPoolPtr->reqPool[headReqSlotTag].nextReq;
+	for(scanCnt = 0; (scanCnt < scanDepth) && (readReqSlotTag != REQ_SLOT_TAG_NONE); scanCnt++)
+	{
+		if(NandReqClass(readReqSlotTag) == NAND_REQ_CLASS_OTHER)
+			return REQ_SLOT_TAG_NONE;
+
+		blockNo = GenerateNandRowAddr(readReqSlotTag) / PAGES_PER_MLC_BLOCK;
+		if((reqPoolPtr->reqPool[readReqSlotTag].reqCode == REQ_CODE_READ) && (NandReqClass(readReqSlotTag) == NAND_REQ_CLASS_HOST_READ))
+		{
+			for(aheadNo = 0; (aheadNo < aheadCnt) && (aheadBlockNo[aheadNo] != blockNo); aheadNo++)
+				;
+
+			if(aheadNo == aheadCnt)
+				return readReqSlotTag;
+		}
+
+		aheadBlockNo[aheadCnt++] = blockNo;
+		readReqSlotTag = reqPoolPtr->reqPool[readReqSlotTag].nextReq;
+	}
+
+	return REQ_SLOT_TAG_NONE;
+}
+
+//called before an idle die is listed by the code of its head, so the head is not issued yet and
+//no multi-plane or cache partner is bound to it
+static void OvertakeNandReq(unsigned int chNo, unsigned int wayNo)
+{
+	unsigned int headReqSlotTag, reqSlotTag, reqCode, deadline;
+
+	if((dieStateTablePtr->dieState[chNo][wayNo].dieState != DIE_STATE_IDLE) || (dieStateTablePtr->dieState[chNo][wayNo].cacheOp != DIE_CACHE_OP_NONE)
+			|| (dieStateTablePtr->dieState[chNo][wayNo].suspendOp != DIE_SUSPEND_NONE))
+		return;
+	if(!nandReqQ[chNo][wayNo].classReqCnt[NAND_REQ_CLASS_HOST_READ])
+		return;
+
+	//a read transfer holds its page in the register
+	headReqSlotTag = nandReqQ[chNo][wayNo].headReq;
+	reqCode = reqPoolPtr->reqPool[headReqSlotTag].reqCode;
+	if((reqCode != REQ_CODE_READ) && (reqCode != REQ_CODE_WRITE) && (reqCode != REQ_CODE_ERASE))
+		return;
+	deadline = nandReqClassDeadline[NandReqClass(headReqSlotTag)];
+	if(!deadline || (dieStateTablePtr->dieState[chNo][wayNo].overtakeCnt > deadline))
+		return;
+
+	reqSlotTag = FindHostReadReq(headReqSlotTag, NAND_OVERTAKE_SCAN_DEPTH);
+	if(reqSlotTag == REQ_SLOT_TAG_NONE)
+		return;
+
+	//counted once per overtaken request
+	if(dieStateTablePtr->dieState[chNo][wayNo].overtakeCnt == deadline)
+		overtakeStatTablePtr->overtakeStat[chNo][wayNo].deadlineCnt++;
+	else
+	{
+		MoveToNandReqQHead(reqSlotTag, chNo, wayNo);
+		overtakeStatTablePtr->overtakeStat[chNo][wayNo].overtakeCnt++;
+	}
+	dieStateTablePtr->dieState[chNo][wayNo].overtakeCnt++;
+}
+
+#if SUPPORT_SUSPEND
+//a host read that may go before the program or erase at the head
+static unsigned int FindSuspendReadReq(unsigned int chNo, unsigned int wayNo)
+{
+	unsigned int headReqSlotTag, reqSlotTag, suspendLimit;
+
+	headReqSlotTag = nandReqQ[chNo][wayNo].headReq;
+	if(reqPoolPtr->reqPool[headReqSlotTag].reqCode == REQ_CODE_ERASE)
+		suspendLimit = NAND_ERASE_SUSPEND_LIMIT;
+	else if(reqPoolPtr->reqPool[headReqSlotTag].reqCode == REQ_CODE_WRITE)
+		suspendLimit = NAND_PROGRAM_SUSPEND_LIMIT;
+	else
+		return REQ_SLOT_TAG_NONE;
+	if((dieStateTablePtr->dieState[chNo][wayNo].cacheOp != DIE_CACHE_OP_NONE) || (dieStateTablePtr->dieState[chNo][wayNo].suspendCnt > suspendLimit))
+		return REQ_SLOT_TAG_NONE;
+
+	reqSlotTag = FindHostReadReq(headReqSlotTag, NAND_SUSPEND_SCAN_DEPTH);
+	if((reqSlotTag == REQ_SLOT_TAG_NONE) || (dieStateTablePtr->dieState[chNo][wayNo].suspendCnt < suspendLimit))
+		return reqSlotTag;
+
+	//counted once per program or erase
+	if(dieStateTablePtr->dieState[chNo][wayNo].suspendCnt == suspendLimit)
+	{
+		dieStateTablePtr->dieState[chNo][wayNo].suspendCnt++;
+		suspendStatTablePtr->suspendStat[chNo][wayNo].limitCnt++;
+	}
+
+	return REQ_SLOT_TAG_NONE;
+}
+
+//called for a busy die, the suspension completes through the status check of the program or erase
+static unsigned int SuspendNandReq(unsigned int chNo, unsigned int wayNo)
+{
+	if((dieStateTablePtr->dieState[chNo][wayNo].dieState != DIE_STATE_EXE) || (dieStateTablePtr->dieState[chNo][wayNo].suspendOp != DIE_SUSPEND_NONE))
+		return 0;
+	if(dieStateTablePtr->dieState[chNo][wayNo].reqStatusCheckOpt != REQ_STATUS_CHECK_OPT_CHECK)
+		return 0;
+	if(FindSuspendReadReq(chNo, wayNo) == REQ_SLOT_TAG_NONE)
+		return 0;
+
+	V2FSuspendAsync(&chCtlReg[chNo], wayNo);
+	dieStateTablePtr->dieState[chNo][wayNo].suspendOp = DIE_SUSPEND_REQUESTED;
+	suspendStatTablePtr->suspendStat[chNo][wayNo].suspendCnt++;
+
+	return 1;
+}
+
+//moves the next host read in front of the suspended program or erase, REQ_SLOT_TAG_NONE once there is none
+static unsigned int OvertakeSuspendedNandReq(unsigned int chNo, unsigned int wayNo)
+{
+	unsigned int reqSlotTag;
+
+	reqSlotTag = FindSuspendReadReq(chNo, wayNo);
+	if(reqSlotTag != REQ_SLOT_TAG_NONE)
+	{
+		MoveToNandReqQHead(reqSlotTag, chNo, wayNo);
+		dieStateTablePtr->dieState[chNo][wayNo].suspendCnt++;
+		suspendStatTablePtr->suspendStat[chNo][wayNo].readCnt++;
+	}
+
+	return reqSlotTag;
+}
+#endif
+
 void IssueNandReq(unsigned int chNo, unsigned int wayNo)
 {
 	unsigned int reqSlotTag, rowAddr;
@@ -646,11 +956,63 @@ void IssueNandReq(unsigned int chNo, unsigned int wayNo)
 	void* spareDataBufAddr;
 	unsigned int* errorInfo;
 	unsigned int* completion;
+#if SUPPORT_MULTI_PLANE
+	unsigned int planeReqSlotTag;
+#endif
+#if SUPPORT_CACHE_OPERATION
+	unsigned int cacheReqSlotTag;
+#endif
 
 	reqSlotTag  = nandReqQ[chNo][wayNo].headReq;
+
+#if SUPPORT_CACHE_OPERATION
+	if(dieStateTablePtr->dieState[chNo][wayNo].cacheOp == DIE_CACHE_OP_READ)
+	{
+		//a cache read already senses the head, only the ready status is waited for
+		dieStateTablePtr->dieState[chNo][wayNo].cacheOp = DIE_CACHE_OP_NONE;
+		dieStateTablePtr->dieState[chNo][wayNo].reqStatusCheckOpt = REQ_STATUS_CHECK_OPT_CHECK;
+		return;
+	}
+	if(dieStateTablePtr->dieState[chNo][wayNo].cacheOp == DIE_CACHE_OP_PROGRAM)
+		reqSlotTag = reqPoolPtr->reqPool[reqSlotTag].nextReq;
+#endif
+#if SUPPORT_SUSPEND
+	//the suspended program or erase is at the head again, it resumes when no other host read can go first
+	if((dieStateTablePtr->dieState[chNo][wayNo].suspendOp == DIE_SUSPEND_ON) &&
+			((reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_WRITE) || (reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_ERASE)))
+	{
+		reqSlotTag = OvertakeSuspendedNandReq(chNo, wayNo);
+		if(reqSlotTag == REQ_SLOT_TAG_NONE)
+		{
+			V2FResumeAsync(&chCtlReg[chNo], wayNo);
+			dieStateTablePtr->dieState[chNo][wayNo].suspendOp = DIE_SUSPEND_NONE;
+			dieStateTablePtr->dieState[chNo][wayNo].reqStatusCheckOpt = REQ_STATUS_CHECK_OPT_CHECK;
+			return;
+		}
+	}
+	else if(dieStateTablePtr->dieState[chNo][wayNo].suspendOp == DIE_SUSPEND_NONE)
+		dieStateTablePtr->dieState[chNo][wayNo].suspendCnt = 0;
+#endif
+	if(NandReqClass(reqSlotTag) != NAND_REQ_CLASS_HOST_READ)
+		dieStateTablePtr->dieState[chNo][wayNo].overtakeCnt = 0;
+
 	rowAddr = GenerateNandRowAddr(reqSlotTag);
 	dataBufAddr = (void*)GenerateDataBufAddr(reqSlotTag);
 	spareDataBufAddr = (void*)GenerateSpareDataBufAddr(reqSlotTag);
+	if(reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_WRITE)
+		StampSliceSpareTag(reqSlotTag);
+
+#if SUPPORT_MULTI_PLANE
+	if(dieStateTablePtr->dieState[chNo][wayNo].cacheOp == DIE_CACHE_OP_NONE)
+	{
+		planeReqSlotTag = FindPlaneReq(reqSlotTag, rowAddr);
+		if(planeReqSlotTag != REQ_SLOT_TAG_NONE)
+		{
+			IssueMultiPlaneNandReq(chNo, wayNo, reqSlotTag, planeReqSlotTag, rowAddr);
+			return;
+		}
+	}
+#endif
 
 	if(reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_READ)
 	{
@@ -666,7 +1028,18 @@ void IssueNandReq(unsigned int chNo, unsigned int wayNo)
 		completion = (unsigned int*)(&completeFlagTablePtr->completeFlag[chNo][wayNo]);
 
 		if(reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandEcc == REQ_OPT_NAND_ECC_ON)
+		{
+#if SUPPORT_CACHE_OPERATION
+			cacheReqSlotTag = FindCacheReq(reqSlotTag, rowAddr, REQ_CODE_READ);
+			if(cacheReqSlotTag != REQ_SLOT_TAG_NONE)
+			{
+				V2FReadPageTransferCacheAsync(&chCtlReg[chNo], wayNo, dataBufAddr, spareDataBufAddr, errorInfo, completion, rowAddr, GenerateNandRowAddr(cacheReqSlotTag));
+				dieStateTablePtr->dieState[chNo][wayNo].cacheOp = DIE_CACHE_OP_READ;
+			}
+			else
+#endif
 			V2FReadPageTransferAsync(&chCtlReg[chNo], wayNo, dataBufAddr, spareDataBufAddr, errorInfo, completion, rowAddr);
+		}
 		else
 			V2FReadPageTransferRawAsync(&chCtlReg[chNo], wayNo, dataBufAddr, completion);
 	}
@@ -674,6 +1047,21 @@ void IssueNandReq(unsigned int chNo, unsigned int wayNo)
 	{
 		dieStateTablePtr->dieState[chNo][wayNo].reqStatusCheckOpt = REQ_STATUS_CHECK_OPT_CHECK;
 
+#if SUPPORT_CACHE_OPERATION
+		//the last program of a run waits for the array, so a completed run is on the NAND
+		cacheReqSlotTag = FindCacheReq(reqSlotTag, rowAddr, REQ_CODE_WRITE);
+#if SUPPORT_MULTI_PLANE
+		//a run ends before a multi-plane pair, which gains more than the overlap
+		if((cacheReqSlotTag != REQ_SLOT_TAG_NONE) && (FindPlaneReq(cacheReqSlotTag, GenerateNandRowAddr(cacheReqSlotTag)) != REQ_SLOT_TAG_NONE))
+			cacheReqSlotTag = REQ_SLOT_TAG_NONE;
+#endif
+		if(cacheReqSlotTag != REQ_SLOT_TAG_NONE)
+		{
+			V2FProgramPageCacheAsync(&chCtlReg[chNo], wayNo, rowAddr, dataBufAddr, spareDataBufAddr);
+			reqPoolPtr->reqPool[reqSlotTag].reqCode = REQ_CODE_CACHE_WRITE;
+		}
+		else
+#endif
 		V2FProgramPageAsync(&chCtlReg[chNo], wayNo, rowAddr, dataBufAddr, spareDataBufAddr);
 	}
 	else if(reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_ERASE)
@@ -750,7 +1138,9 @@ unsigned int GenerateDataBufAddr(unsigned int reqSlotTag)
 {
 	if(reqPoolPtr->reqPool[reqSlotTag].reqType == REQ_TYPE_NAND)
 	{
-		if(reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufFormat == REQ_OPT_DATA_BUF_ENTRY)
+		if((reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufFormat == REQ_OPT_DATA_BUF_ENTRY) && (reqPoolPtr->reqPool[reqSlotTag].reqCode != REQ_CODE_WRITE) && reqPoolPtr->reqPool[reqSlotTag].reqOpt.fillBlockMask)
+			return (FILL_DATA_BUFFER_BASE_ADDR + Vsa2VdieTranslation(reqPoolPtr->reqPool[reqSlotTag].nandInfo.virtualSliceAddr) * BYTES_PER_DATA_REGION_OF_SLICE);
+		else if(reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufFormat == REQ_OPT_DATA_BUF_ENTRY)
 			return (DATA_BUFFER_BASE_ADDR + reqPoolPtr->reqPool[reqSlotTag].dataBufInfo.entry * BYTES_PER_DATA_REGION_OF_SLICE);
 		else if(reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufFormat == REQ_OPT_DATA_BUF_TEMP_ENTRY)
 			return (TEMPORARY_DATA_BUFFER_BASE_ADDR + reqPoolPtr->reqPool[reqSlotTag].dataBufInfo.entry * BYTES_PER_DATA_REGION_OF_SLICE);
@@ -775,7 +1165,9 @@ unsigned int GenerateSpareDataBufAddr(unsigned int reqSlotTag)
 {
 	if(reqPoolPtr->reqPool[reqSlotTag].reqType == REQ_TYPE_NAND)
 	{
-		if(reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufFormat == REQ_OPT_DATA_BUF_ENTRY)
+		if((reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufFormat == REQ_OPT_DATA_BUF_ENTRY) && (reqPoolPtr->reqPool[reqSlotTag].reqCode != REQ_CODE_WRITE) && reqPoolPtr->reqPool[reqSlotTag].reqOpt.fillBlockMask)
+			return (FILL_SPARE_DATA_BUFFER_BASE_ADDR + Vsa2VdieTranslation(reqPoolPtr->reqPool[reqSlotTag].nandInfo.virtualSliceAddr) * BYTES_PER_SPARE_REGION_OF_SLICE);
+		else if(reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufFormat == REQ_OPT_DATA_BUF_ENTRY)
 			return (SPARE_DATA_BUFFER_BASE_ADDR + reqPoolPtr->reqPool[reqSlotTag].dataBufInfo.entry * BYTES_PER_SPARE_REGION_OF_SLICE);
 		else if(reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufFormat == REQ_OPT_DATA_BUF_TEMP_ENTRY)
 			return (TEMPORARY_SPARE_DATA_BUFFER_BASE_ADDR + reqPoolPtr->reqPool[reqSlotTag].dataBufInfo.entry * BYTES_PER_SPARE_REGION_OF_SLICE);
@@ -885,7 +1277,7 @@ unsigned int CheckEccErrorInfo(unsigned int chNo, unsigned int wayNo)
 
 void ExecuteNandReq(unsigned int chNo, unsigned int wayNo, unsigned int reqStatus)
 {
-	unsigned int reqSlotTag, rowAddr, phyBlockNo;
+	unsigned int reqSlotTag, rowAddr, phyBlockNo, pairReqSlotTag;
 	unsigned char* badCheck ;
 
 	reqSlotTag = nandReqQ[chNo][wayNo].headReq;
@@ -897,10 +1289,45 @@ void ExecuteNandReq(unsigned int chNo, unsigned int wayNo, unsigned int reqStatu
 			dieStateTablePtr->dieState[chNo][wayNo].dieState = DIE_STATE_EXE;
 			break;
 		case DIE_STATE_EXE:
+#if SUPPORT_SUSPEND
+			//a failure is the one of the finished program or erase, which ignored the suspend command
+			if(dieStateTablePtr->dieState[chNo][wayNo].suspendOp == DIE_SUSPEND_REQUESTED)
+			{
+				if(reqStatus == REQ_STATUS_DONE)
+				{
+					dieStateTablePtr->dieState[chNo][wayNo].suspendOp = DIE_SUSPEND_ON;
+					OvertakeSuspendedNandReq(chNo, wayNo);
+					dieStateTablePtr->dieState[chNo][wayNo].dieState = DIE_STATE_IDLE;
+					break;
+				}
+				else if(reqStatus != REQ_STATUS_RUNNING)
+					dieStateTablePtr->dieState[chNo][wayNo].suspendOp = DIE_SUSPEND_NONE;
+			}
+#endif
 			if(reqStatus == REQ_STATUS_DONE)
 			{
 				if(reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_READ)
 					reqPoolPtr->reqPool[reqSlotTag].reqCode = REQ_CODE_READ_TRANSFER;
+#if SUPPORT_CACHE_OPERATION
+				else if((dieStateTablePtr->dieState[chNo][wayNo].cacheOp == DIE_CACHE_OP_PROGRAM) || (reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_CACHE_WRITE))
+					CompleteCacheProgram(chNo, wayNo, reqStatus);
+#endif
+#if SUPPORT_MULTI_PLANE
+				else if(reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_MULTI_PLANE_READ)
+				{
+					//both pages wait in the registers of their planes, the request behind the head is transferred next
+					pairReqSlotTag = SplitMultiPlaneNandReq(reqSlotTag);
+					reqPoolPtr->reqPool[reqSlotTag].reqCode = REQ_CODE_READ_TRANSFER;
+					reqPoolPtr->reqPool[pairReqSlotTag].reqCode = REQ_CODE_READ_TRANSFER;
+				}
+				else if((reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_MULTI_PLANE_WRITE) || (reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_MULTI_PLANE_ERASE))
+				{
+					pairReqSlotTag = SplitMultiPlaneNandReq(reqSlotTag);
+					retryLimitTablePtr->retryLimit[chNo][wayNo] = RETRY_LIMIT;
+					GetFromNandReqQ(chNo, wayNo, reqStatus, reqPoolPtr->reqPool[reqSlotTag].reqCode);
+					GetFromNandReqQ(chNo, wayNo, reqStatus, reqPoolPtr->reqPool[pairReqSlotTag].reqCode);
+				}
+#endif
 				else
 				{
 					retryLimitTablePtr->retryLimit[chNo][wayNo] = RETRY_LIMIT;
@@ -911,6 +1338,25 @@ void ExecuteNandReq(unsigned int chNo, unsigned int wayNo, unsigned int reqStatu
 			}
 			else if(reqStatus == REQ_STATUS_FAIL)
 			{
+				//the status of a multi-plane operation does not tell the failing plane, a read is retried as usual
+				//and both blocks of a program or an erase are taken as failing
+				pairReqSlotTag = REQ_SLOT_TAG_NONE;
+#if SUPPORT_MULTI_PLANE
+				pairReqSlotTag = SplitMultiPlaneNandReq(reqSlotTag);
+				if(reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_READ)
+					pairReqSlotTag = REQ_SLOT_TAG_NONE;
+#endif
+#if SUPPORT_CACHE_OPERATION
+				//so are the blocks of a program still in the array and of the program behind it,
+				//a read sensed behind a failed transfer is triggered again
+				if(dieStateTablePtr->dieState[chNo][wayNo].cacheOp == DIE_CACHE_OP_PROGRAM)
+					pairReqSlotTag = reqPoolPtr->reqPool[reqSlotTag].nextReq;
+				if(reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_CACHE_WRITE)
+					reqPoolPtr->reqPool[reqSlotTag].reqCode = REQ_CODE_WRITE;
+				if((pairReqSlotTag != REQ_SLOT_TAG_NONE) && (reqPoolPtr->reqPool[pairReqSlotTag].reqCode == REQ_CODE_CACHE_WRITE))
+					reqPoolPtr->reqPool[pairReqSlotTag].reqCode = REQ_CODE_WRITE;
+				dieStateTablePtr->dieState[chNo][wayNo].cacheOp = DIE_CACHE_OP_NONE;
+#endif
 				if((reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_READ) || (reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_READ_TRANSFER))
 					if(retryLimitTablePtr->retryLimit[chNo][wayNo] > 0)
 					{
@@ -949,6 +1395,14 @@ void ExecuteNandReq(unsigned int chNo, unsigned int wayNo, unsigned int reqStatu
 
 				retryLimitTablePtr->retryLimit[chNo][wayNo] = RETRY_LIMIT;
 				GetFromNandReqQ(chNo, wayNo, reqStatus, reqPoolPtr->reqPool[reqSlotTag].reqCode);
+
+				if(pairReqSlotTag != REQ_SLOT_TAG_NONE)
+				{
+					rowAddr = GenerateNandRowAddr(pairReqSlotTag);
+					phyBlockNo = ((rowAddr % LUN_1_BASE_ADDR) / PAGES_PER_MLC_BLOCK) + ((rowAddr / LUN_1_BASE_ADDR)* TOTAL_BLOCKS_PER_LUN);
+					UpdatePhyBlockMapForGrownBadBlock(Pcw2VdieTranslation(chNo, wayNo), phyBlockNo);
+					GetFromNandReqQ(chNo, wayNo, reqStatus, reqPoolPtr->reqPool[pairReqSlotTag].reqCode);
+				}
 				dieStateTablePtr->dieState[chNo][wayNo].dieState = DIE_STATE_IDLE;
 			}
 			else if(reqStatus == REQ_STATUS_WARNING)
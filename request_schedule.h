@@ -31,7 +31,7 @@
 // Module Name: Request Scheduler
 // File Name: request_schedule.h
 //
-// Version: v1.0.0
+// Version: v1.3.0
 //
 // Description:
 //   - define parameters, data structure and functions of request scheduler
@@ -40,6 +40,15 @@
 //////////////////////////////////////////////////////////////////////////////////
 // Revision History:
 //
+// * v1.3.0
+//   - host reads overtake queued programs, GC reads and erases within per-class deadlines
+//
+// * v1.2.0
+//   - program and erase suspension for host reads with per-die counters
+//
+// * v1.1.0
+//   - cache operation state of a die
+//
 // * v1.0.0
 //   - First draft
 //////////////////////////////////////////////////////////////////////////////////
@@ -62,6 +71,24 @@
 #define DIE_STATE_IDLE			0
 #define DIE_STATE_EXE			1
 
+#define DIE_CACHE_OP_NONE		0
+#define DIE_CACHE_OP_PROGRAM	1	//the head request is still programming, the request behind it is issued next
+#define DIE_CACHE_OP_READ		2	//the request behind the head is sensed while the head is transferred
+
+#define DIE_SUSPEND_NONE		0
+#define DIE_SUSPEND_REQUESTED	1	//a suspend command was issued to the program or erase at the head
+#define DIE_SUSPEND_ON			2	//the program or erase waits behind reads moved to the head
+
+#define NAND_PROGRAM_SUSPEND_LIMIT	0	//host reads that may overtake one program, too short to pay for suspending
+#define NAND_ERASE_SUSPEND_LIMIT	8	//host reads that may overtake one erase
+#define NAND_SUSPEND_SCAN_DEPTH	8	//requests behind a program or erase searched for a host read
+
+#define NAND_OVERTAKE_SCAN_DEPTH	32	//requests behind the head of an idle die searched for a host read
+#define NAND_HOST_WRITE_DEADLINE	0	//host reads that may overtake one host program, delayed programs cost more than the reads gain
+#define NAND_GC_READ_DEADLINE		8	//host reads that may overtake one GC read
+#define NAND_GC_WRITE_DEADLINE		8	//host reads that may overtake one GC program
+#define NAND_ERASE_DEADLINE			8	//host reads that may overtake one erase before it is issued
+
 #define REQ_STATUS_CHECK_OPT_NONE 				0
 #define REQ_STATUS_CHECK_OPT_CHECK				1
 #define REQ_STATUS_CHECK_OPT_REPORT 			2
@@ -98,13 +125,35 @@ typedef struct _DIE_STATE_ENTRY {
 	unsigned int reqStatusCheckOpt	:	4;
 	unsigned int prevWay	:	4;
 	unsigned int nextWay 	:	4;
-	unsigned int reserved	:	12;
+	unsigned int cacheOp	:	2;
+	unsigned int suspendOp	:	2;
+	unsigned int suspendCnt	:	4;	//reads that overtook the current program or erase
+	unsigned int overtakeCnt	:	4;	//reads moved in front of the head before it was issued
 } DIE_STATE_ENTRY, *P_DIE_STATE_ENTRY;
 
 typedef struct _DIE_STATE_TABLE {
 	DIE_STATE_ENTRY dieState[USER_CHANNELS][USER_WAYS];
 } DIE_STATE_TABLE, *P_DIE_STATE_TABLE;
 
+typedef struct _SUSPEND_STAT_ENTRY {
+	unsigned int suspendCnt;		//suspend commands issued
+	unsigned int readCnt;			//host reads served by suspended dies
+	unsigned int limitCnt;			//programs and erases that left host reads waiting at their limit
+} SUSPEND_STAT_ENTRY, *P_SUSPEND_STAT_ENTRY;
+
+typedef struct _SUSPEND_STAT_TABLE {
+	SUSPEND_STAT_ENTRY suspendStat[USER_CHANNELS][USER_WAYS];
+} SUSPEND_STAT_TABLE, *P_SUSPEND_STAT_TABLE;
+
+typedef struct _OVERTAKE_STAT_ENTRY {
+	unsigned int overtakeCnt;		//host reads moved in front of queued requests
+	unsigned int deadlineCnt;		//queued requests that left host reads waiting at their deadline
+} OVERTAKE_STAT_ENTRY, *P_OVERTAKE_STAT_ENTRY;
+
+typedef struct _OVERTAKE_STAT_TABLE {
+	OVERTAKE_STAT_ENTRY overtakeStat[USER_CHANNELS][USER_WAYS];
+} OVERTAKE_STAT_TABLE, *P_OVERTAKE_STAT_TABLE;
+
 
 typedef struct _WAY_PRIORITY_ENTRY {
 	unsigned int idleHead :	4;
@@ -167,6 +216,8 @@ extern P_COMPLETE_FLAG_TABLE completeFlagTablePtr;
 extern P_STATUS_REPORT_TABLE statusReportTablePtr;
 extern P_ERROR_INFO_TABLE eccErrorInfoTablePtr;
 extern P_RETRY_LIMIT_TABLE retryLimitTablePtr;
+extern P_SUSPEND_STAT_TABLE suspendStatTablePtr;
+extern P_OVERTAKE_STAT_TABLE overtakeStatTablePtr;
 extern P_DIE_STATE_TABLE dieStatusTablePtr;
 extern P_WAY_PRIORITY_TABLE wayPriorityTablePtr;
 
@@ -31,7 +31,7 @@
 // Module Name: Request Scheduler
 // File Name: request_transform.c
 //
-// Version: v1.0.0
+// Version: v1.3.1
 //
 // Description:
 //	 - transform request information
@@ -42,6 +42,24 @@
 //////////////////////////////////////////////////////////////////////////////////
 // Revision History:
 //
+// * v1.3.1
+//   - NAND requests are tracked by the checkpoint when they are selected
+//
+// * v1.3.0
+//   - host writes are recorded by the write temperature tracker
+//
+// * v1.2.1
+//   - sequential writes are detected per slice, evictions write back the dirty run following the victim
+//
+// * v1.2.0
+//   - partial writes fill only their NVMe blocks, the rest of the slice is read when it is needed
+//
+// * v1.1.1
+//   - dirty entries are written back through the write-back engine, FUA writes are written through
+//
+// * v1.1.0
+//   - programs blocked by row address dependency are released as soon as the preceding page is queued
+//
 // * v1.0.0
 //   - First draft
 //////////////////////////////////////////////////////////////////////////////////
@@ -92,6 +110,10 @@ void ReqTransNvmeToSlice(unsigned int cmdSlotTag, unsigned int startLba, unsigne
 	else
 		assert(!"[WARNING] Not supported command code [WARNING]");
 
+	//every host write heats its slices, buffer hits included
+	if(reqCode == REQ_CODE_WRITE)
+		RecordHostWrite(tempLsa, (startLba + nlb) / NVME_BLOCKS_PER_SLICE);
+
 	//first transform
 	nvmeBlockOffset = (startLba % NVME_BLOCKS_PER_SLICE);
 	if(loop)
@@ -161,39 +183,49 @@ void ReqTransNvmeToSlice(unsigned int cmdSlotTag, unsigned int startLba, unsigne
 
 void EvictDataBufEntry(unsigned int originReqSlotTag)
 {
-	unsigned int reqSlotTag, virtualSliceAddr, dataBufEntry;
+	unsigned int dataBufEntry;
 
 	dataBufEntry = reqPoolPtr->reqPool[originReqSlotTag].dataBufInfo.entry;
 	if(dataBufMapPtr->dataBuf[dataBufEntry].dirty == DATA_BUF_DIRTY)
+		WriteBackDataBufRun(dataBufEntry, reqPoolPtr->reqPool[originReqSlotTag].nvmeCmdSlotTag);
+}
+
+void DataReadFromNand(unsigned int originReqSlotTag)
+{
+	unsigned int reqSlotTag, virtualSliceAddr;
+
+	virtualSliceAddr =  AddrTransRead(reqPoolPtr->reqPool[originReqSlotTag].logicalSliceAddr);
+
+	if(virtualSliceAddr != VSA_FAIL)
 	{
 		reqSlotTag = GetFromFreeReqQ();
-		virtualSliceAddr =  AddrTransWrite(dataBufMapPtr->dataBuf[dataBufEntry].logicalSliceAddr);
 
 		reqPoolPtr->reqPool[reqSlotTag].reqType = REQ_TYPE_NAND;
-		reqPoolPtr->reqPool[reqSlotTag].reqCode = REQ_CODE_WRITE;
+		reqPoolPtr->reqPool[reqSlotTag].reqCode = REQ_CODE_READ;
 		reqPoolPtr->reqPool[reqSlotTag].nvmeCmdSlotTag = reqPoolPtr->reqPool[originReqSlotTag].nvmeCmdSlotTag;
-		reqPoolPtr->reqPool[reqSlotTag].logicalSliceAddr = dataBufMapPtr->dataBuf[dataBufEntry].logicalSliceAddr;
+		reqPoolPtr->reqPool[reqSlotTag].logicalSliceAddr = reqPoolPtr->reqPool[originReqSlotTag].logicalSliceAddr;
 		reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufFormat = REQ_OPT_DATA_BUF_ENTRY;
 		reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandAddr = REQ_OPT_NAND_ADDR_VSA;
 		reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandEcc = REQ_OPT_NAND_ECC_ON;
 		reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandEccWarning = REQ_OPT_NAND_ECC_WARNING_ON;
 		reqPoolPtr->reqPool[reqSlotTag].reqOpt.rowAddrDependencyCheck = REQ_OPT_ROW_ADDR_DEPENDENCY_CHECK;
 		reqPoolPtr->reqPool[reqSlotTag].reqOpt.blockSpace = REQ_OPT_BLOCK_SPACE_MAIN;
-		reqPoolPtr->reqPool[reqSlotTag].dataBufInfo.entry = dataBufEntry;
-		UpdateDataBufEntryInfoBlockingReq(dataBufEntry, reqSlotTag);
+		reqPoolPtr->reqPool[reqSlotTag].reqOpt.fillBlockMask = 0;
+
+		reqPoolPtr->reqPool[reqSlotTag].dataBufInfo.entry = reqPoolPtr->reqPool[originReqSlotTag].dataBufInfo.entry;
+		UpdateDataBufEntryInfoBlockingReq(reqPoolPtr->reqPool[reqSlotTag].dataBufInfo.entry, reqSlotTag);
 		reqPoolPtr->reqPool[reqSlotTag].nandInfo.virtualSliceAddr = virtualSliceAddr;
 
 		SelectLowLevelReqQ(reqSlotTag);
-
-		dataBufMapPtr->dataBuf[dataBufEntry].dirty = DATA_BUF_CLEAN;
 	}
 }
 
-void DataReadFromNand(unsigned int originReqSlotTag)
+//read the slice of a partially valid entry, only the blocks the host has not written are taken from NAND
+void FillDataBufEntry(unsigned int bufEntry, unsigned int cmdSlotTag)
 {
 	unsigned int reqSlotTag, virtualSliceAddr;
 
-	virtualSliceAddr =  AddrTransRead(reqPoolPtr->reqPool[originReqSlotTag].logicalSliceAddr);
+	virtualSliceAddr =  AddrTransRead(dataBufMapPtr->dataBuf[bufEntry].logicalSliceAddr);
 
 	if(virtualSliceAddr != VSA_FAIL)
 	{
@@ -201,27 +233,30 @@ void DataReadFromNand(unsigned int originReqSlotTag)
 
 		reqPoolPtr->reqPool[reqSlotTag].reqType = REQ_TYPE_NAND;
 		reqPoolPtr->reqPool[reqSlotTag].reqCode = REQ_CODE_READ;
-		reqPoolPtr->reqPool[reqSlotTag].nvmeCmdSlotTag = reqPoolPtr->reqPool[originReqSlotTag].nvmeCmdSlotTag;
-		reqPoolPtr->reqPool[reqSlotTag].logicalSliceAddr = reqPoolPtr->reqPool[originReqSlotTag].logicalSliceAddr;
+		reqPoolPtr->reqPool[reqSlotTag].nvmeCmdSlotTag = cmdSlotTag;
+		reqPoolPtr->reqPool[reqSlotTag].logicalSliceAddr = dataBufMapPtr->dataBuf[bufEntry].logicalSliceAddr;
 		reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufFormat = REQ_OPT_DATA_BUF_ENTRY;
 		reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandAddr = REQ_OPT_NAND_ADDR_VSA;
 		reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandEcc = REQ_OPT_NAND_ECC_ON;
 		reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandEccWarning = REQ_OPT_NAND_ECC_WARNING_ON;
 		reqPoolPtr->reqPool[reqSlotTag].reqOpt.rowAddrDependencyCheck = REQ_OPT_ROW_ADDR_DEPENDENCY_CHECK;
 		reqPoolPtr->reqPool[reqSlotTag].reqOpt.blockSpace = REQ_OPT_BLOCK_SPACE_MAIN;
+		reqPoolPtr->reqPool[reqSlotTag].reqOpt.fillBlockMask = ~dataBufMapPtr->dataBuf[bufEntry].blockValid & DATA_BUF_BLOCK_VALID_ALL;
 
-		reqPoolPtr->reqPool[reqSlotTag].dataBufInfo.entry = reqPoolPtr->reqPool[originReqSlotTag].dataBufInfo.entry;
-		UpdateDataBufEntryInfoBlockingReq(reqPoolPtr->reqPool[reqSlotTag].dataBufInfo.entry, reqSlotTag);
+		reqPoolPtr->reqPool[reqSlotTag].dataBufInfo.entry = bufEntry;
+		UpdateDataBufEntryInfoBlockingReq(bufEntry, reqSlotTag);
 		reqPoolPtr->reqPool[reqSlotTag].nandInfo.virtualSliceAddr = virtualSliceAddr;
 
 		SelectLowLevelReqQ(reqSlotTag);
 	}
+
+	dataBufMapPtr->dataBuf[bufEntry].blockValid = DATA_BUF_BLOCK_VALID_ALL;
 }
 
 
 void ReqTransSliceToLowLevel()
 {
-	unsigned int reqSlotTag, dataBufEntry;
+	unsigned int reqSlotTag, dataBufEntry, cmdSlotTag, writeThrough, blockMask;
 
 	while(sliceReqQ.headReq != REQ_SLOT_TAG_NONE)
 	{
@@ -239,7 +274,7 @@ void ReqTransSliceToLowLevel()
 		else
 		{
 			//data buffer miss, allocate a new buffer entry
-			dataBufEntry = AllocateDataBuf();
+			dataBufEntry = AllocateDataBuf(reqPoolPtr->reqPool[reqSlotTag].logicalSliceAddr);
 			reqPoolPtr->reqPool[reqSlotTag].dataBufInfo.entry = dataBufEntry;
 
 			//clear the allocated data buffer entry being used by a previous request
@@ -249,21 +284,35 @@ void ReqTransSliceToLowLevel()
 			dataBufMapPtr->dataBuf[dataBufEntry].logicalSliceAddr = reqPoolPtr->reqPool[reqSlotTag].logicalSliceAddr;
 			PutToDataBufHashList(dataBufEntry);
 
+			//a write does not read the slice first, its blocks are the only valid ones until the entry is filled
+			dataBufMapPtr->dataBuf[dataBufEntry].blockValid = DATA_BUF_BLOCK_VALID_ALL;
 			if(reqPoolPtr->reqPool[reqSlotTag].reqCode  == REQ_CODE_READ)
 				DataReadFromNand(reqSlotTag);
 			else if(reqPoolPtr->reqPool[reqSlotTag].reqCode  == REQ_CODE_WRITE)
-				if(reqPoolPtr->reqPool[reqSlotTag].nvmeDmaInfo.numOfNvmeBlock != NVME_BLOCKS_PER_SLICE) //for read modify write
-					DataReadFromNand(reqSlotTag);
+				dataBufMapPtr->dataBuf[dataBufEntry].blockValid = 0;
 		}
 
 		//transform this slice request to nvme request
+		cmdSlotTag = reqPoolPtr->reqPool[reqSlotTag].nvmeCmdSlotTag;
+		blockMask = ((1 << reqPoolPtr->reqPool[reqSlotTag].nvmeDmaInfo.numOfNvmeBlock) - 1) << reqPoolPtr->reqPool[reqSlotTag].nvmeDmaInfo.nvmeBlockOffset;
+		writeThrough = 0;
 		if(reqPoolPtr->reqPool[reqSlotTag].reqCode  == REQ_CODE_WRITE)
 		{
+			writeThrough = CheckFuaWrite(cmdSlotTag);
+			if(dataBufMapPtr->dataBuf[dataBufEntry].dirty == DATA_BUF_CLEAN)
+				dirtyDataBufCnt++;
 			dataBufMapPtr->dataBuf[dataBufEntry].dirty = DATA_BUF_DIRTY;
+			UpdateDataBufSeqFill(dataBufEntry, reqPoolPtr->reqPool[reqSlotTag].nvmeDmaInfo.nvmeBlockOffset);
+			dataBufMapPtr->dataBuf[dataBufEntry].blockValid |= blockMask;
 			reqPoolPtr->reqPool[reqSlotTag].reqCode = REQ_CODE_RxDMA;
 		}
 		else if(reqPoolPtr->reqPool[reqSlotTag].reqCode  == REQ_CODE_READ)
+		{
+			//a read of blocks a partial write left out waits for the fill in the blocking chain of the entry
+			if((dataBufMapPtr->dataBuf[dataBufEntry].blockValid & blockMask) != blockMask)
+				FillDataBufEntry(dataBufEntry, cmdSlotTag);
 			reqPoolPtr->reqPool[reqSlotTag].reqCode = REQ_CODE_TxDMA;
+		}
 		else
 			assert(!"[WARNING] Not supported reqCode. [WARNING]");
 
@@ -272,6 +321,10 @@ void ReqTransSliceToLowLevel()
 
 		UpdateDataBufEntryInfoBlockingReq(dataBufEntry, reqSlotTag);
 		SelectLowLevelReqQ(reqSlotTag);
+
+		//FUA writes are written through, the program waits for the DMA in the blocking chain of the entry
+		if(writeThrough)
+			WriteBackDataBufEntry(dataBufEntry, cmdSlotTag, REQ_OPT_FORCE_UNIT_ACCESS_ON);
 	}
 }
 
@@ -407,6 +460,9 @@ void SelectLowLevelReqQ(unsigned int reqSlotTag)
 {
 	unsigned int dieNo, chNo, wayNo, bufDepCheckReport, rowAddrDepCheckReport, rowAddrDepTableUpdateReport;
 
+	if(reqPoolPtr->reqPool[reqSlotTag].reqType == REQ_TYPE_NAND)
+		TrackCheckpointReq(reqSlotTag);
+
 	bufDepCheckReport = CheckBufDep(reqSlotTag);
 	if(bufDepCheckReport == BUF_DEPENDENCY_REPORT_PASS)
 	{
@@ -436,7 +492,13 @@ void SelectLowLevelReqQ(unsigned int reqSlotTag)
 				rowAddrDepCheckReport = CheckRowAddrDep(reqSlotTag, ROW_ADDR_DEPENDENCY_CHECK_OPT_SELECT);
 
 				if(rowAddrDepCheckReport == ROW_ADDR_DEPENDENCY_REPORT_PASS)
+				{
 					PutToNandReqQ(reqSlotTag, chNo, wayNo);
+
+					//programs to the following pages of the block may be waiting for this one
+					if(reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_WRITE)
+						ReleaseBlockedByRowAddrDepReq(chNo, wayNo);
+				}
 				else if(rowAddrDepCheckReport == ROW_ADDR_DEPENDENCY_REPORT_BLOCKED)
 					PutToBlockedByRowAddrDepReqQ(reqSlotTag, chNo, wayNo);
 				else
@@ -523,7 +585,11 @@ void ReleaseBlockedByBufDepReq(unsigned int reqSlotTag)
 				rowAddrDepCheckReport = CheckRowAddrDep(targetReqSlotTag, ROW_ADDR_DEPENDENCY_CHECK_OPT_RELEASE);
 
 				if(rowAddrDepCheckReport == ROW_ADDR_DEPENDENCY_REPORT_PASS)
+				{
 					PutToNandReqQ(targetReqSlotTag, chNo, wayNo);
+					if(reqPoolPtr->reqPool[targetReqSlotTag].reqCode == REQ_CODE_WRITE)
+						ReleaseBlockedByRowAddrDepReq(chNo, wayNo);
+				}
 				else if(rowAddrDepCheckReport == ROW_ADDR_DEPENDENCY_REPORT_BLOCKED)
 					PutToBlockedByRowAddrDepReqQ(targetReqSlotTag, chNo, wayNo);
 				else
@@ -556,6 +622,10 @@ void ReleaseBlockedByRowAddrDepReq(unsigned int chNo, unsigned int wayNo)
 			{
 				SelectiveGetFromBlockedByRowAddrDepReqQ(reqSlotTag, chNo, wayNo);
 				PutToNandReqQ(reqSlotTag, chNo, wayNo);
+
+				//a released program may unblock requests already passed over
+				if(reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_WRITE)
+					nextReq = blockedByRowAddrDepReqQ[chNo][wayNo].headReq;
 			}
 			else if(rowAddrDepCheckReport == ROW_ADDR_DEPENDENCY_REPORT_BLOCKED)
 			{
@@ -574,7 +644,7 @@ void ReleaseBlockedByRowAddrDepReq(unsigned int chNo, unsigned int wayNo)
 
 void IssueNvmeDmaReq(unsigned int reqSlotTag)
 {
-	unsigned int devAddr, dmaIndex, numOfNvmeBlock;
+	unsigned int devAddr, dmaIndex, numOfNvmeBlock, autoCompletion;
 
 	dmaIndex = reqPoolPtr->reqPool[reqSlotTag].nvmeDmaInfo.startIndex;
 	devAddr = GenerateDataBufAddr(reqSlotTag);
@@ -582,9 +652,10 @@ void IssueNvmeDmaReq(unsigned int reqSlotTag)
 
 	if(reqPoolPtr->reqPool[reqSlotTag].reqCode == REQ_CODE_RxDMA)
 	{
+		autoCompletion = CheckFuaWrite(reqPoolPtr->reqPool[reqSlotTag].nvmeCmdSlotTag) ? NVME_COMMAND_AUTO_COMPLETION_OFF : NVME_COMMAND_AUTO_COMPLETION_ON;
 		while(numOfNvmeBlock < reqPoolPtr->reqPool[reqSlotTag].nvmeDmaInfo.numOfNvmeBlock)
 		{
-			set_auto_rx_dma(reqPoolPtr->reqPool[reqSlotTag].nvmeCmdSlotTag, dmaIndex, devAddr, NVME_COMMAND_AUTO_COMPLETION_ON);
+			set_auto_rx_dma(reqPoolPtr->reqPool[reqSlotTag].nvmeCmdSlotTag, dmaIndex, devAddr, autoCompletion);
 
 			numOfNvmeBlock++;
 			dmaIndex++;
@@ -30,7 +30,7 @@
 // Module Name: Request Scheduler
 // File Name: request_transform.h
 //
-// Version: v1.0.0
+// Version: v1.0.1
 //
 // Description:
 //   - define parameters, data structure and functions of request scheduler
@@ -39,6 +39,9 @@
 //////////////////////////////////////////////////////////////////////////////////
 // Revision History:
 //
+// * v1.0.1
+//   - FillDataBufEntry for partially valid data buffer entries
+//
 // * v1.0.0
 //   - First draft
 //////////////////////////////////////////////////////////////////////////////////
@@ -82,6 +85,7 @@ void ReqTransSliceToLowLevel();
 void IssueNvmeDmaReq(unsigned int reqSlotTag);
 void CheckDoneNvmeDmaReq();
 
+void FillDataBufEntry(unsigned int bufEntry, unsigned int cmdSlotTag);
 void SelectLowLevelReqQ(unsigned int reqSlotTag);
 void ReleaseBlockedByBufDepReq(unsigned int reqSlotTag);
 void ReleaseBlockedByRowAddrDepReq(unsigned int chNo, unsigned int wayNo);
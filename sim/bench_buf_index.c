@@ -0,0 +1,349 @@
+//////////////////////////////////////////////////////////////////////////////////
+// bench_buf_index.c for Cosmos+ OpenSSD
+//
+// This file is part of Cosmos+ OpenSSD.
+//
+// Cosmos+ OpenSSD is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3, or (at your option)
+// any later version.
+//
+// Cosmos+ OpenSSD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Cosmos+ OpenSSD; see the file COPYING.
+// If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Project Name: Cosmos+ OpenSSD
+// Design Name: Cosmos+ Firmware (host simulator)
+// Module Name: Buffer Index Benchmark
+// File Name: bench_buf_index.c
+//
+// Version: v1.0.0
+//
+// Description:
+//   - time the lookup/replace path of the data buffer (CheckDataBufHit, and on
+//     a miss AllocateDataBuf + PutToDataBufHashList) of data_buffer.c against
+//     the former chained index (lsa % entry count, 16-bit links in the entries)
+//   - both run the same slice sequences; hit counts must agree, and the slots or
+//     chain links visited per lookup are reported next to the time per access
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Revision History:
+//
+// * v1.0.0
+//   - First draft
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "sim.h"
+#include "../memory_map.h"
+
+#define BENCH_ACCESS_COUNT		(8 * 1024 * 1024)
+
+int simVerbose;
+P_REQ_POOL reqPoolPtr;
+static REQ_POOL benchReqPool;
+
+//former chained index, kept as the reference
+typedef struct _LEGACY_DATA_BUF_ENTRY {
+	unsigned int logicalSliceAddr;
+	unsigned int prevEntry : 16;
+	unsigned int nextEntry : 16;
+	unsigned int blockingReqTail : 16;
+	unsigned int hashPrevEntry : 16;
+	unsigned int hashNextEntry : 16;
+	unsigned int dirty : 1;
+	unsigned int reserved0 : 15;
+} LEGACY_DATA_BUF_ENTRY;
+
+typedef struct _LEGACY_DATA_BUF_HASH_ENTRY {
+	unsigned int headEntry : 16;
+	unsigned int tailEntry : 16;
+} LEGACY_DATA_BUF_HASH_ENTRY;
+
+static LEGACY_DATA_BUF_ENTRY legacyBuf[AVAILABLE_DATA_BUFFER_ENTRY_COUNT];
+static LEGACY_DATA_BUF_HASH_ENTRY legacyHash[AVAILABLE_DATA_BUFFER_ENTRY_COUNT];
+static DATA_BUF_LRU_LIST legacyLru;
+
+static void LegacyInit()
+{
+	unsigned int bufEntry;
+
+	for(bufEntry = 0; bufEntry < AVAILABLE_DATA_BUFFER_ENTRY_COUNT; bufEntry++)
+	{
+		legacyBuf[bufEntry].logicalSliceAddr = LSA_NONE;
+		legacyBuf[bufEntry].prevEntry = bufEntry - 1;
+		legacyBuf[bufEntry].nextEntry = bufEntry + 1;
+		legacyBuf[bufEntry].hashPrevEntry = DATA_BUF_NONE;
+		legacyBuf[bufEntry].hashNextEntry = DATA_BUF_NONE;
+		legacyHash[bufEntry].headEntry = DATA_BUF_NONE;
+		legacyHash[bufEntry].tailEntry = DATA_BUF_NONE;
+	}
+
+	legacyBuf[0].prevEntry = DATA_BUF_NONE;
+	legacyBuf[AVAILABLE_DATA_BUFFER_ENTRY_COUNT - 1].nextEntry = DATA_BUF_NONE;
+	legacyLru.headEntry = 0;
+	legacyLru.tailEntry = AVAILABLE_DATA_BUFFER_ENTRY_COUNT - 1;
+}
+
+static void LegacyMoveToHead(unsigned int bufEntry)
+{
+	if((legacyBuf[bufEntry].nextEntry != DATA_BUF_NONE) && (legacyBuf[bufEntry].prevEntry != DATA_BUF_NONE))
+	{
+		legacyBuf[legacyBuf[bufEntry].prevEntry].nextEntry = legacyBuf[bufEntry].nextEntry;
+		legacyBuf[legacyBuf[bufEntry].nextEntry].prevEntry = legacyBuf[bufEntry].prevEntry;
+	}
+	else if((legacyBuf[bufEntry].nextEntry == DATA_BUF_NONE) && (legacyBuf[bufEntry].prevEntry != DATA_BUF_NONE))
+	{
+		legacyBuf[legacyBuf[bufEntry].prevEntry].nextEntry = DATA_BUF_NONE;
+		legacyLru.tailEntry = legacyBuf[bufEntry].prevEntry;
+	}
+	else if((legacyBuf[bufEntry].nextEntry != DATA_BUF_NONE) && (legacyBuf[bufEntry].prevEntry == DATA_BUF_NONE))
+	{
+		legacyBuf[legacyBuf[bufEntry].nextEntry].prevEntry = DATA_BUF_NONE;
+		legacyLru.headEntry = legacyBuf[bufEntry].nextEntry;
+	}
+	else
+	{
+		legacyLru.tailEntry = DATA_BUF_NONE;
+		legacyLru.headEntry = DATA_BUF_NONE;
+	}
+
+	if(legacyLru.headEntry != DATA_BUF_NONE)
+	{
+		legacyBuf[bufEntry].prevEntry = DATA_BUF_NONE;
+		legacyBuf[bufEntry].nextEntry = legacyLru.headEntry;
+		legacyBuf[legacyLru.headEntry].prevEntry = bufEntry;
+		legacyLru.headEntry = bufEntry;
+	}
+	else
+	{
+		legacyBuf[bufEntry].prevEntry = DATA_BUF_NONE;
+		legacyBuf[bufEntry].nextEntry = DATA_BUF_NONE;
+		legacyLru.headEntry = bufEntry;
+		legacyLru.tailEntry = bufEntry;
+	}
+}
+
+static void LegacyUnhash(unsigned int bufEntry)
+{
+	unsigned int prevBufEntry, nextBufEntry, hashEntry;
+
+	if(legacyBuf[bufEntry].logicalSliceAddr == LSA_NONE)
+		return;
+
+	prevBufEntry = legacyBuf[bufEntry].hashPrevEntry;
+	nextBufEntry = legacyBuf[bufEntry].hashNextEntry;
+	hashEntry = legacyBuf[bufEntry].logicalSliceAddr % AVAILABLE_DATA_BUFFER_ENTRY_COUNT;
+
+	if((nextBufEntry != DATA_BUF_NONE) && (prevBufEntry != DATA_BUF_NONE))
+	{
+		legacyBuf[prevBufEntry].hashNextEntry = nextBufEntry;
+		legacyBuf[nextBufEntry].hashPrevEntry = prevBufEntry;
+	}
+	else if((nextBufEntry == DATA_BUF_NONE) && (prevBufEntry != DATA_BUF_NONE))
+	{
+		legacyBuf[prevBufEntry].hashNextEntry = DATA_BUF_NONE;
+		legacyHash[hashEntry].tailEntry = prevBufEntry;
+	}
+	else if((nextBufEntry != DATA_BUF_NONE) && (prevBufEntry == DATA_BUF_NONE))
+	{
+		legacyBuf[nextBufEntry].hashPrevEntry = DATA_BUF_NONE;
+		legacyHash[hashEntry].headEntry = nextBufEntry;
+	}
+	else
+	{
+		legacyHash[hashEntry].headEntry = DATA_BUF_NONE;
+		legacyHash[hashEntry].tailEntry = DATA_BUF_NONE;
+	}
+}
+
+static void LegacyHash(unsigned int bufEntry)
+{
+	unsigned int hashEntry;
+
+	hashEntry = legacyBuf[bufEntry].logicalSliceAddr % AVAILABLE_DATA_BUFFER_ENTRY_COUNT;
+
+	if(legacyHash[hashEntry].tailEntry != DATA_BUF_NONE)
+	{
+		legacyBuf[bufEntry].hashPrevEntry = legacyHash[hashEntry].tailEntry;
+		legacyBuf[bufEntry].hashNextEntry = DATA_BUF_NONE;
+		legacyBuf[legacyHash[hashEntry].tailEntry].hashNextEntry = bufEntry;
+		legacyHash[hashEntry].tailEntry = bufEntry;
+	}
+	else
+	{
+		legacyBuf[bufEntry].hashPrevEntry = DATA_BUF_NONE;
+		legacyBuf[bufEntry].hashNextEntry = DATA_BUF_NONE;
+		legacyHash[hashEntry].headEntry = bufEntry;
+		legacyHash[hashEntry].tailEntry = bufEntry;
+	}
+}
+
+static unsigned int LegacyAccess(unsigned int logicalSliceAddr, unsigned long long* visitCnt)
+{
+	unsigned int bufEntry;
+
+	bufEntry = legacyHash[logicalSliceAddr % AVAILABLE_DATA_BUFFER_ENTRY_COUNT].headEntry;
+	while(bufEntry != DATA_BUF_NONE)
+	{
+		if(visitCnt)
+			(*visitCnt)++;
+
+		if(legacyBuf[bufEntry].logicalSliceAddr == logicalSliceAddr)
+		{
+			LegacyMoveToHead(bufEntry);
+			return 1;
+		}
+		bufEntry = legacyBuf[bufEntry].hashNextEntry;
+	}
+
+	//miss, reuse the LRU tail
+	bufEntry = legacyLru.tailEntry;
+	LegacyMoveToHead(bufEntry);
+	LegacyUnhash(bufEntry);
+	legacyBuf[bufEntry].logicalSliceAddr = logicalSliceAddr;
+	LegacyHash(bufEntry);
+
+	return 0;
+}
+
+//same path as ReqTransSliceToLowLevel without the requests
+static unsigned int CurrentAccess(unsigned int logicalSliceAddr, unsigned long long* visitCnt)
+{
+	unsigned int bufEntry, hashEntry;
+
+	if(visitCnt)
+	{
+		hashEntry = FindDataBufHashTableEntry(logicalSliceAddr);
+		do
+		{
+			(*visitCnt)++;
+			if(dataBufHashTablePtr->dataBufHash[hashEntry].logicalSliceAddr == logicalSliceAddr)
+				break;
+			hashEntry = (hashEntry + 1) & DATA_BUF_HASH_TABLE_MASK;
+		} while(dataBufHashTablePtr->dataBufHash[hashEntry].logicalSliceAddr != LSA_NONE);
+	}
+
+	reqPoolPtr->reqPool[0].logicalSliceAddr = logicalSliceAddr;
+	if(CheckDataBufHit(0) != DATA_BUF_FAIL)
+		return 1;
+
+	bufEntry = AllocateDataBuf(logicalSliceAddr);
+	dataBufMapPtr->dataBuf[bufEntry].logicalSliceAddr = logicalSliceAddr;
+	PutToDataBufHashList(bufEntry);
+
+	return 0;
+}
+
+static unsigned long long NextRandom(unsigned long long* state)
+{
+	*state ^= *state << 13;
+	*state ^= *state >> 7;
+	*state ^= *state << 17;
+
+	return *state;
+}
+
+static double NowNs()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void RunPattern(const char* name, unsigned int* sequence)
+{
+	unsigned long long legacyHitCnt, currentHitCnt, legacyVisitCnt, currentVisitCnt;
+	double legacyNs, currentNs, start;
+	unsigned int accessNo;
+
+	//untimed pass that counts the slots or links visited per lookup
+	LegacyInit();
+	InitDataBuf();
+	legacyVisitCnt = 0;
+	currentVisitCnt = 0;
+	for(accessNo = 0; accessNo < BENCH_ACCESS_COUNT; accessNo++)
+	{
+		LegacyAccess(sequence[accessNo], &legacyVisitCnt);
+		CurrentAccess(sequence[accessNo], &currentVisitCnt);
+	}
+
+	LegacyInit();
+	legacyHitCnt = 0;
+	start = NowNs();
+	for(accessNo = 0; accessNo < BENCH_ACCESS_COUNT; accessNo++)
+		legacyHitCnt += LegacyAccess(sequence[accessNo], NULL);
+	legacyNs = (NowNs() - start) / BENCH_ACCESS_COUNT;
+
+	InitDataBuf();
+	currentHitCnt = 0;
+	start = NowNs();
+	for(accessNo = 0; accessNo < BENCH_ACCESS_COUNT; accessNo++)
+		currentHitCnt += CurrentAccess(sequence[accessNo], NULL);
+	currentNs = (NowNs() - start) / BENCH_ACCESS_COUNT;
+
+	if(legacyHitCnt != currentHitCnt)
+	{
+		fprintf(stderr, "[bench] %s: hit counts differ (chained %llu, open addressing %llu)\n", name, legacyHitCnt, currentHitCnt);
+		exit(1);
+	}
+
+	printf("  %-10s hit %5.1f %%  chained %6.1f ns %5.2f links  open addressing %6.1f ns %5.2f slots  speedup %.2fx\n",
+			name, 100.0 * currentHitCnt / BENCH_ACCESS_COUNT,
+			legacyNs, (double)legacyVisitCnt / BENCH_ACCESS_COUNT,
+			currentNs, (double)currentVisitCnt / BENCH_ACCESS_COUNT,
+			legacyNs / currentNs);
+}
+
+int main()
+{
+	unsigned int* sequence;
+	unsigned long long rngState;
+	unsigned int accessNo;
+
+	sequence = malloc(BENCH_ACCESS_COUNT * sizeof(unsigned int));
+	if(sequence == NULL)
+		return 1;
+
+	SimInitDram();
+	reqPoolPtr = &benchReqPool;
+
+	printf("[bench] %u buffer entries, %u hash slots, %u accesses per pattern\n",
+			AVAILABLE_DATA_BUFFER_ENTRY_COUNT, DATA_BUF_HASH_TABLE_SIZE, BENCH_ACCESS_COUNT);
+
+	rngState = 0x9e3779b97f4a7c15ULL;
+	for(accessNo = 0; accessNo < BENCH_ACCESS_COUNT; accessNo++)
+		sequence[accessNo] = NextRandom(&rngState) % AVAILABLE_DATA_BUFFER_ENTRY_COUNT;
+	RunPattern("resident", sequence);
+
+	for(accessNo = 0; accessNo < BENCH_ACCESS_COUNT; accessNo++)
+		sequence[accessNo] = NextRandom(&rngState) % (2 * AVAILABLE_DATA_BUFFER_ENTRY_COUNT);
+	RunPattern("random-2x", sequence);
+
+	for(accessNo = 0; accessNo < BENCH_ACCESS_COUNT; accessNo++)
+		sequence[accessNo] = NextRandom(&rngState) % SLICES_PER_SSD;
+	RunPattern("random", sequence);
+
+	for(accessNo = 0; accessNo < BENCH_ACCESS_COUNT; accessNo++)
+		sequence[accessNo] = accessNo % SLICES_PER_SSD;
+	RunPattern("sequential", sequence);
+
+	//slices one entry count apart share a chain of the former index
+	for(accessNo = 0; accessNo < BENCH_ACCESS_COUNT; accessNo++)
+		sequence[accessNo] = (NextRandom(&rngState) % (2 * AVAILABLE_DATA_BUFFER_ENTRY_COUNT)) * AVAILABLE_DATA_BUFFER_ENTRY_COUNT % SLICES_PER_SSD;
+	RunPattern("strided", sequence);
+
+	free(sequence);
+	return 0;
+}
@@ -0,0 +1,388 @@
+//////////////////////////////////////////////////////////////////////////////////
+// host_lld_sim.c for Cosmos+ OpenSSD
+//
+// This file is part of Cosmos+ OpenSSD.
+//
+// Cosmos+ OpenSSD is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3, or (at your option)
+// any later version.
+//
+// Cosmos+ OpenSSD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Cosmos+ OpenSSD; see the file COPYING.
+// If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Project Name: Cosmos+ OpenSSD
+// Design Name: Cosmos+ Firmware (host simulator)
+// Module Name: Host Interface Model
+// File Name: host_lld_sim.c
+//
+// Version: v1.1.0
+//
+// Description:
+//   - implement the DMA and completion part of host_lld.h on a timed PCIe model
+//   - auto DMAs complete in FIFO order; a command completes when all of its
+//     NVMe blocks are transferred (auto completion) unless a DMA of it was
+//     issued without auto completion, then set_auto_nvme_cpl completes it
+//   - PRPs of direct DMAs are host pointers of the simulator process, so
+//     command payloads such as DSM range lists are really copied
+//   - a write stamps its LBA and write sequence number into every NVMe block it
+//     transfers, a read asserts it gets the stamp of the last write of the block
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Revision History:
+//
+// * v1.1.0
+//   - stamp written data and check it at read completion
+//
+// * v1.0.0
+//   - First draft
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+#include "../nvme/host_lld.h"
+
+#define SIM_AUTO_DMA_FIFO_DEPTH	256		//the FIFO pointers are unsigned char
+
+HOST_DMA_STATUS g_hostDmaStatus;
+HOST_DMA_ASSIST_STATUS g_hostDmaAssistStatus;
+
+static SIM_CMD_SLOT cmdSlot[SIM_MAX_CMD_SLOTS];
+static SIM_CMD_DONE_HANDLER cmdDoneHandler;
+static SIM_TIME txFreeAt;
+static SIM_TIME rxFreeAt;
+
+//device buffer address and command block of the auto DMAs in the FIFOs, indexed like the FIFO tail
+static unsigned int txDmaDevAddr[SIM_AUTO_DMA_FIFO_DEPTH];
+static unsigned int txDmaCmd4KBOffset[SIM_AUTO_DMA_FIFO_DEPTH];
+static unsigned int rxDmaDevAddr[SIM_AUTO_DMA_FIFO_DEPTH];
+static unsigned int rxDmaCmd4KBOffset[SIM_AUTO_DMA_FIFO_DEPTH];
+
+static P_SIM_LBA_STATE lbaState;
+static unsigned int lbaCnt;
+static unsigned int hostWriteSeq;
+static unsigned int hostEventSeq;		//advanced by every command submission and completion
+static SIM_DATA_CHECK_STAT dataCheckStat;
+
+void SimInitHost(SIM_CMD_DONE_HANDLER handler)
+{
+	memset(&g_hostDmaStatus, 0, sizeof(HOST_DMA_STATUS));
+	memset(&g_hostDmaAssistStatus, 0, sizeof(HOST_DMA_ASSIST_STATUS));
+	memset(cmdSlot, 0, sizeof(cmdSlot));
+
+	cmdDoneHandler = handler;
+	txFreeAt = 0;
+	rxFreeAt = 0;
+
+	free(lbaState);
+	lbaCnt = SLICES_PER_SSD * NVME_BLOCKS_PER_SLICE;
+	lbaState = calloc(lbaCnt, sizeof(SIM_LBA_STATE));
+	if(lbaState == NULL)
+	{
+		fprintf(stderr, "[sim] out of memory for the LBA states\n");
+		exit(1);
+	}
+	hostWriteSeq = 0;
+	hostEventSeq = 0;
+	memset(&dataCheckStat, 0, sizeof(SIM_DATA_CHECK_STAT));
+}
+
+static unsigned int EndLbaOf(P_SIM_CMD_SLOT slot)
+{
+	return (slot->startLba + slot->nlb < lbaCnt) ? slot->startLba + slot->nlb : lbaCnt;
+}
+
+void SimHostSubmitCmd(unsigned int cmdSlotTag, unsigned int op, unsigned int startLba, unsigned int nlb)
+{
+	P_SIM_CMD_SLOT slot;
+	P_SIM_LBA_STATE state;
+	unsigned int lba, endLba;
+
+	assert(cmdSlotTag < SIM_MAX_CMD_SLOTS && !cmdSlot[cmdSlotTag].valid);
+
+	slot = &cmdSlot[cmdSlotTag];
+	slot->valid = 1;
+	slot->manualCompletion = 0;
+	slot->op = op;
+	slot->startLba = startLba;
+	slot->nlb = nlb;
+	slot->writeSeq = 0;
+	slot->submitEventSeq = ++hostEventSeq;
+	slot->expectedDmaCnt = ((op == SIM_TRACE_OP_READ) || (op == SIM_TRACE_OP_WRITE)) ? nlb : 0;
+	slot->doneDmaCnt = 0;
+	slot->submitTime = simNow;
+
+	if((op != SIM_TRACE_OP_WRITE) && (op != SIM_TRACE_OP_TRIM))
+		return;
+
+	slot->writeSeq = ++hostWriteSeq;
+	endLba = EndLbaOf(slot);
+	for(lba = startLba; lba < endLba; lba++)
+	{
+		state = &lbaState[lba];
+		state->writeSeq = slot->writeSeq;
+		state->overlapped = (state->inFlightCnt != 0);
+		state->deallocated = (op == SIM_TRACE_OP_TRIM);
+		state->inFlightCnt++;
+	}
+}
+
+void SimGetDataCheckStat(P_SIM_DATA_CHECK_STAT stat)
+{
+	*stat = dataCheckStat;
+}
+
+unsigned int SimHostCmdSlotBusy(unsigned int cmdSlotTag)
+{
+	return cmdSlot[cmdSlotTag].valid;
+}
+
+static void CompleteCmd(unsigned int cmdSlotTag)
+{
+	P_SIM_CMD_SLOT slot;
+	P_SIM_LBA_STATE state;
+	unsigned int lba, endLba;
+
+	slot = &cmdSlot[cmdSlotTag];
+	if(!slot->valid)
+		return;
+
+	slot->valid = 0;
+	hostEventSeq++;
+	if(slot->writeSeq)
+	{
+		endLba = EndLbaOf(slot);
+		for(lba = slot->startLba; lba < endLba; lba++)
+		{
+			state = &lbaState[lba];
+			if(--state->inFlightCnt == 0)
+				state->settledEventSeq = hostEventSeq;
+		}
+	}
+
+	if(cmdDoneHandler)
+		cmdDoneHandler(cmdSlotTag, cmdSlot[cmdSlotTag].submitTime);
+}
+
+//the block is in the buffer when its RxDMA completes
+static void StampWrittenData(P_SIM_CMD_SLOT slot, unsigned int cmd4KBOffset, unsigned int devAddr)
+{
+	P_SIM_DATA_STAMP stamp;
+
+	stamp = (P_SIM_DATA_STAMP)(unsigned long)devAddr;
+	stamp->lba = slot->startLba + cmd4KBOffset;
+	stamp->writeSeq = slot->writeSeq;
+}
+
+//a block written concurrently with the read may return either data, one never written or deallocated anything
+static void CheckReadData(P_SIM_CMD_SLOT slot, unsigned int cmd4KBOffset, unsigned int devAddr)
+{
+	P_SIM_DATA_STAMP stamp;
+	P_SIM_LBA_STATE state;
+	unsigned int lba;
+
+	lba = slot->startLba + cmd4KBOffset;
+	if(lba >= lbaCnt)
+		return;
+
+	state = &lbaState[lba];
+	if(!state->writeSeq || state->deallocated || state->overlapped || state->inFlightCnt || (state->settledEventSeq > slot->submitEventSeq))
+	{
+		dataCheckStat.skippedBlockCnt++;
+		return;
+	}
+
+	stamp = (P_SIM_DATA_STAMP)(unsigned long)devAddr;
+	if((stamp->lba != lba) || (stamp->writeSeq != state->writeSeq))
+	{
+		fprintf(stderr, "[sim] read of LBA %u returned LBA %u write %u, expected write %u\n", lba, stamp->lba, stamp->writeSeq, state->writeSeq);
+		assert(!"[WARNING] host read returned data other than the last write [WARNING]");
+	}
+	dataCheckStat.checkedBlockCnt++;
+}
+
+static void AutoDmaDone(unsigned int direction, unsigned int cmdSlotTag)
+{
+	unsigned char head;
+
+	if(direction == HOST_DMA_TX_DIRECTION)
+	{
+		head = g_hostDmaStatus.fifoHead.autoDmaTx++;
+		if(cmdSlot[cmdSlotTag].valid)
+			CheckReadData(&cmdSlot[cmdSlotTag], txDmaCmd4KBOffset[head], txDmaDevAddr[head]);
+	}
+	else
+	{
+		head = g_hostDmaStatus.fifoHead.autoDmaRx++;
+		if(cmdSlot[cmdSlotTag].valid)
+			StampWrittenData(&cmdSlot[cmdSlotTag], rxDmaCmd4KBOffset[head], rxDmaDevAddr[head]);
+	}
+
+	if(cmdSlot[cmdSlotTag].valid && !cmdSlot[cmdSlotTag].manualCompletion)
+		if(++cmdSlot[cmdSlotTag].doneDmaCnt == cmdSlot[cmdSlotTag].expectedDmaCnt)
+			CompleteCmd(cmdSlotTag);
+}
+
+void set_auto_nvme_cpl(unsigned int cmdSlotTag, unsigned int specific, unsigned int statusFieldWord)
+{
+	CompleteCmd(cmdSlotTag);
+}
+
+void set_nvme_slot_release(unsigned int cmdSlotTag)
+{
+	CompleteCmd(cmdSlotTag);
+}
+
+void set_nvme_cpl(unsigned int sqId, unsigned int cid, unsigned int specific, unsigned int statusFieldWord)
+{
+}
+
+void set_direct_tx_dma(unsigned int devAddr, unsigned int pcieAddrH, unsigned int pcieAddrL, unsigned int len)
+{
+	g_hostDmaStatus.directDmaTxCnt++;
+}
+
+void set_direct_rx_dma(unsigned int devAddr, unsigned int pcieAddrH, unsigned int pcieAddrL, unsigned int len)
+{
+	unsigned long long hostAddr;
+
+	hostAddr = ((unsigned long long)pcieAddrH << 32) | pcieAddrL;
+	if(hostAddr)
+		memcpy((void*)(unsigned long)devAddr, (void*)(unsigned long)hostAddr, len);
+
+	g_hostDmaStatus.directDmaRxCnt++;
+}
+
+void check_direct_tx_dma_done()
+{
+}
+
+void check_direct_rx_dma_done()
+{
+}
+
+void set_auto_tx_dma(unsigned int cmdSlotTag, unsigned int cmd4KBOffset, unsigned int devAddr, unsigned int autoCompletion)
+{
+	unsigned char tempTail;
+
+	assert(cmd4KBOffset < 256);
+
+	while((unsigned char)(g_hostDmaStatus.fifoTail.autoDmaTx + 1) == g_hostDmaStatus.fifoHead.autoDmaTx)
+		SimPoll();
+
+	SimProgress();
+	txFreeAt = ((txFreeAt > simNow) ? txFreeAt : simNow) + simTiming.pcieNsPer4KB;
+	SimScheduleEvent(txFreeAt, AutoDmaDone, HOST_DMA_TX_DIRECTION, cmdSlotTag);
+
+	tempTail = g_hostDmaStatus.fifoTail.autoDmaTx++;
+	txDmaDevAddr[tempTail] = devAddr;
+	txDmaCmd4KBOffset[tempTail] = cmd4KBOffset;
+	if(tempTail > g_hostDmaStatus.fifoTail.autoDmaTx)
+		g_hostDmaAssistStatus.autoDmaTxOverFlowCnt++;
+
+	g_hostDmaStatus.autoDmaTxCnt++;
+}
+
+void set_auto_rx_dma(unsigned int cmdSlotTag, unsigned int cmd4KBOffset, unsigned int devAddr, unsigned int autoCompletion)
+{
+	unsigned char tempTail;
+
+	assert(cmd4KBOffset < 256);
+
+	if(!autoCompletion)
+		cmdSlot[cmdSlotTag].manualCompletion = 1;
+
+	while((unsigned char)(g_hostDmaStatus.fifoTail.autoDmaRx + 1) == g_hostDmaStatus.fifoHead.autoDmaRx)
+		SimPoll();
+
+	SimProgress();
+	rxFreeAt = ((rxFreeAt > simNow) ? rxFreeAt : simNow) + simTiming.pcieNsPer4KB;
+	SimScheduleEvent(rxFreeAt, AutoDmaDone, HOST_DMA_RX_DIRECTION, cmdSlotTag);
+
+	tempTail = g_hostDmaStatus.fifoTail.autoDmaRx++;
+	rxDmaDevAddr[tempTail] = devAddr;
+	rxDmaCmd4KBOffset[tempTail] = cmd4KBOffset;
+	if(tempTail > g_hostDmaStatus.fifoTail.autoDmaRx)
+		g_hostDmaAssistStatus.autoDmaRxOverFlowCnt++;
+
+	g_hostDmaStatus.autoDmaRxCnt++;
+}
+
+void check_auto_tx_dma_done()
+{
+	while(g_hostDmaStatus.fifoHead.autoDmaTx != g_hostDmaStatus.fifoTail.autoDmaTx)
+		SimPoll();
+}
+
+void check_auto_rx_dma_done()
+{
+	while(g_hostDmaStatus.fifoHead.autoDmaRx != g_hostDmaStatus.fifoTail.autoDmaRx)
+		SimPoll();
+}
+
+//same wrap-around comparison as host_lld.c, with the FIFO head advanced by the model
+static unsigned int CheckAutoDmaPartialDone(unsigned int head, unsigned int tail, unsigned int overFlowCnt, unsigned int tailIndex, unsigned int tailAssistIndex)
+{
+	if(head == tail)
+		return 1;
+
+	if(head < tailIndex)
+	{
+		if(tail < tailIndex)
+		{
+			if(tail > head)
+				return 1;
+			else
+				if(overFlowCnt != (tailAssistIndex + 1))
+					return 1;
+		}
+		else
+			if(overFlowCnt != tailAssistIndex)
+				return 1;
+	}
+	else if(head == tailIndex)
+		return 1;
+	else
+	{
+		if(tail < tailIndex)
+			return 1;
+		else
+		{
+			if(tail > head)
+				return 1;
+			else
+				if(overFlowCnt != tailAssistIndex)
+					return 1;
+		}
+	}
+
+	return 0;
+}
+
+unsigned int check_auto_tx_dma_partial_done(unsigned int tailIndex, unsigned int tailAssistIndex)
+{
+	SimPoll();
+
+	return CheckAutoDmaPartialDone(g_hostDmaStatus.fifoHead.autoDmaTx, g_hostDmaStatus.fifoTail.autoDmaTx,
+			g_hostDmaAssistStatus.autoDmaTxOverFlowCnt, tailIndex, tailAssistIndex);
+}
+
+unsigned int check_auto_rx_dma_partial_done(unsigned int tailIndex, unsigned int tailAssistIndex)
+{
+	SimPoll();
+
+	return CheckAutoDmaPartialDone(g_hostDmaStatus.fifoHead.autoDmaRx, g_hostDmaStatus.fifoTail.autoDmaRx,
+			g_hostDmaAssistStatus.autoDmaRxOverFlowCnt, tailIndex, tailAssistIndex);
+}
@@ -0,0 +1,20 @@
+//////////////////////////////////////////////////////////////////////////////////
+// xil_printf.h for the Cosmos+ OpenSSD host simulator
+//
+// Stand-in for the Xilinx standalone BSP header. Console output of the
+// firmware is routed to stdout and is silent unless the simulator runs verbose.
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SIM_XIL_PRINTF_H_
+#define SIM_XIL_PRINTF_H_
+
+#include <stdio.h>
+#include <stdint.h>
+
+extern int simVerbose;
+
+#define xil_printf(...) ((void)(simVerbose && printf(__VA_ARGS__)))
+
+char inbyte(void);
+
+#endif /* SIM_XIL_PRINTF_H_ */
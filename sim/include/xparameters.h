@@ -0,0 +1,54 @@
+//////////////////////////////////////////////////////////////////////////////////
+// xparameters.h for the Cosmos+ OpenSSD host simulator
+//
+// Stand-in for the generated hardware description. SIM_CHANNELS selects how
+// many NAND storage controllers are "connected"; their register and microcode
+// windows are placed in the reserved DRAM range that the simulator maps.
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SIM_XPARAMETERS_H_
+#define SIM_XPARAMETERS_H_
+
+#ifndef SIM_CHANNELS
+#define SIM_CHANNELS	2
+#endif
+
+#define SIM_NSC_REG_BASEADDR(ch)	(0x0E000000 + (ch) * 0x10000)
+#define SIM_NSC_UCODE_BASEADDR(ch)	(0x0F000000 + (ch) * 0x10000)
+
+#define XPAR_NVME_CTRL_0_BASEADDR	0x0D000000
+
+#if SIM_CHANNELS > 0
+#define XPAR_T4NFC_HLPER_0_BASEADDR			SIM_NSC_REG_BASEADDR(0)
+#define XPAR_AXI_BRAM_CTRL_0_S_AXI_BASEADDR	SIM_NSC_UCODE_BASEADDR(0)
+#endif
+#if SIM_CHANNELS > 1
+#define XPAR_T4NFC_HLPER_1_BASEADDR			SIM_NSC_REG_BASEADDR(1)
+#define XPAR_AXI_BRAM_CTRL_1_S_AXI_BASEADDR	SIM_NSC_UCODE_BASEADDR(1)
+#endif
+#if SIM_CHANNELS > 2
+#define XPAR_T4NFC_HLPER_2_BASEADDR			SIM_NSC_REG_BASEADDR(2)
+#define XPAR_AXI_BRAM_CTRL_2_S_AXI_BASEADDR	SIM_NSC_UCODE_BASEADDR(2)
+#endif
+#if SIM_CHANNELS > 3
+#define XPAR_T4NFC_HLPER_3_BASEADDR			SIM_NSC_REG_BASEADDR(3)
+#define XPAR_AXI_BRAM_CTRL_3_S_AXI_BASEADDR	SIM_NSC_UCODE_BASEADDR(3)
+#endif
+#if SIM_CHANNELS > 4
+#define XPAR_T4NFC_HLPER_4_BASEADDR			SIM_NSC_REG_BASEADDR(4)
+#define XPAR_AXI_BRAM_CTRL_4_S_AXI_BASEADDR	SIM_NSC_UCODE_BASEADDR(4)
+#endif
+#if SIM_CHANNELS > 5
+#define XPAR_T4NFC_HLPER_5_BASEADDR			SIM_NSC_REG_BASEADDR(5)
+#define XPAR_AXI_BRAM_CTRL_5_S_AXI_BASEADDR	SIM_NSC_UCODE_BASEADDR(5)
+#endif
+#if SIM_CHANNELS > 6
+#define XPAR_T4NFC_HLPER_6_BASEADDR			SIM_NSC_REG_BASEADDR(6)
+#define XPAR_AXI_BRAM_CTRL_6_S_AXI_BASEADDR	SIM_NSC_UCODE_BASEADDR(6)
+#endif
+#if SIM_CHANNELS > 7
+#define XPAR_T4NFC_HLPER_7_BASEADDR			SIM_NSC_REG_BASEADDR(7)
+#define XPAR_AXI_BRAM_CTRL_7_S_AXI_BASEADDR	SIM_NSC_UCODE_BASEADDR(7)
+#endif
+
+#endif /* SIM_XPARAMETERS_H_ */
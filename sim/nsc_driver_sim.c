@@ -0,0 +1,616 @@
+//////////////////////////////////////////////////////////////////////////////////
+// nsc_driver_sim.c for Cosmos+ OpenSSD
+//
+// This file is part of Cosmos+ OpenSSD.
+//
+// Cosmos+ OpenSSD is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3, or (at your option)
+// any later version.
+//
+// Cosmos+ OpenSSD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Cosmos+ OpenSSD; see the file COPYING.
+// If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Project Name: Cosmos+ OpenSSD
+// Design Name: Cosmos+ Firmware (host simulator)
+// Module Name: NAND Storage Controller Model
+// File Name: nsc_driver_sim.c
+//
+// Version: v1.3.2
+//
+// Description:
+//   - implement the V2F* driver API of nsc_driver.h on top of a timed NAND model
+//   - each die is busy for tR/tPROG/tBERS, each channel bus is shared by
+//     command, status and data transfer cycles of its ways
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Revision History:
+//
+// * v1.3.2
+//   - keep the whole data of checkpoint and bad block table pages, so that a restarted FTL reads them back
+//
+// * v1.3.1
+//   - keep the start of every NVMe block of a page, where the host model stamps its data
+//
+// * v1.3.0
+//   - model program/erase suspend and resume
+//
+// * v1.2.0
+//   - model cache program and cache read, the cache register of a die is ready before its array
+//
+// * v1.1.0
+//   - model multi-plane read, program and erase of two planes in one array operation
+//
+// * v1.0.0
+//   - First draft
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include "xil_printf.h"
+#include "sim.h"
+#include "../memory_map.h"
+#include "../address_translation.h"
+#include "../request_schedule.h"
+
+#define SIM_NAND_STATUS_READY	0x60
+#define SIM_NAND_RAW_READ_BYTES	(16384 + 1664)
+
+static SIM_DIE simDie[USER_CHANNELS][USER_WAYS];
+static SIM_CHANNEL simChannel[USER_CHANNELS];
+static SIM_NAND_STAT simNandStat;
+
+static void FreeSimBlock(P_SIM_NAND_BLOCK block)
+{
+	unsigned int pageNo;
+
+	if(block == NULL)
+		return;
+
+	for(pageNo = 0; pageNo < PAGES_PER_MLC_BLOCK; pageNo++)
+		free(block->page[pageNo].wholeData);
+	free(block);
+}
+
+void SimInitNand()
+{
+	unsigned int chNo, wayNo, blockNo;
+
+	for(chNo = 0; chNo < USER_CHANNELS; chNo++)
+	{
+		simChannel[chNo].busFreeAt = 0;
+		simChannel[chNo].busyTime = 0;
+
+		for(wayNo = 0; wayNo < USER_WAYS; wayNo++)
+		{
+			for(blockNo = 0; blockNo < TOTAL_BLOCKS_PER_DIE; blockNo++)
+				FreeSimBlock(simDie[chNo][wayNo].block[blockNo]);
+
+			memset(&simDie[chNo][wayNo], 0, sizeof(SIM_DIE));
+		}
+	}
+
+	memset(&simNandStat, 0, sizeof(SIM_NAND_STAT));
+}
+
+static unsigned int ChannelOf(T4REGS* t4regs)
+{
+	unsigned int chNo = (unsigned int)(t4regs - chCtlReg);
+
+	assert(chNo < USER_CHANNELS);
+	return chNo;
+}
+
+static P_SIM_NAND_PAGE LookUpPage(P_SIM_DIE die, unsigned int rowAddress, int allocate)
+{
+	unsigned int phyBlockNo, pageNo;
+
+#if (LUNS_PER_DIE == 1)
+	//extended blocks of a single-LUN die run past LUN_1_BASE_ADDR
+	phyBlockNo = rowAddress / PAGES_PER_MLC_BLOCK;
+#else
+	phyBlockNo = ((rowAddress % LUN_1_BASE_ADDR) / PAGES_PER_MLC_BLOCK) + ((rowAddress / LUN_1_BASE_ADDR) * TOTAL_BLOCKS_PER_LUN);
+#endif
+	pageNo = rowAddress % PAGES_PER_MLC_BLOCK;
+	assert(phyBlockNo < TOTAL_BLOCKS_PER_DIE);
+
+	if(die->block[phyBlockNo] == NULL)
+	{
+		if(!allocate)
+			return NULL;
+
+		die->block[phyBlockNo] = calloc(1, sizeof(SIM_NAND_BLOCK));
+		assert(die->block[phyBlockNo] != NULL);
+	}
+
+	return &die->block[phyBlockNo]->page[pageNo];
+}
+
+//occupy the channel bus from the earliest free slot and return the end of the occupation
+static SIM_TIME OccupyChannel(unsigned int chNo, SIM_TIME earliest, SIM_TIME duration)
+{
+	SIM_TIME start;
+
+	start = (earliest > simChannel[chNo].busFreeAt) ? earliest : simChannel[chNo].busFreeAt;
+	if(start < simNow)
+		start = simNow;
+
+	simChannel[chNo].busFreeAt = start + duration;
+	simChannel[chNo].busyTime += duration;
+
+	return start + duration;
+}
+
+static SIM_TIME PageTransferTime()
+{
+	return (BYTES_PER_NAND_ROW * simTiming.nsPerKB) / 1024;
+}
+
+static void OccupyDie(P_SIM_DIE die, SIM_TIME start, SIM_TIME end)
+{
+	if(start < die->arrayBusyUntil)
+		start = die->arrayBusyUntil;
+
+	die->busyTime += end - start;
+	die->busyUntil = end;
+	die->arrayBusyUntil = end;
+}
+
+//the page register takes a transferred page when the array has finished the previous program
+static SIM_TIME ArrayProgramStart(P_SIM_DIE die, SIM_TIME xferEnd)
+{
+	return (xferEnd > die->arrayBusyUntil) ? xferEnd : die->arrayBusyUntil;
+}
+
+static void ProgramSimPage(unsigned int chNo, unsigned int wayNo, unsigned int rowAddress, void* pageDataBuffer, void* spareDataBuffer)
+{
+	P_SIM_DIE die = &simDie[chNo][wayNo];
+	P_SIM_NAND_PAGE page;
+	unsigned int blockNo;
+
+	page = LookUpPage(die, rowAddress, 1);
+	if(page->programmed)
+	{
+		simNandStat.overwriteCnt++;
+		xil_printf("[sim] program without erase ch %d way %d rowAddr %x\r\n", chNo, wayNo, rowAddress);
+	}
+
+	page->programmed = 1;
+	for(blockNo = 0; blockNo < NVME_BLOCKS_PER_PAGE; blockNo++)
+		memcpy(page->data[blockNo], (unsigned char*)pageDataBuffer + blockNo * BYTES_PER_NVME_BLOCK, SIM_NAND_KEPT_DATA_BYTES);
+
+	//checkpoint and bad block table buffers lie above the buffers of slices
+	free(page->wholeData);
+	page->wholeData = NULL;
+	if((unsigned int)(unsigned long)pageDataBuffer >= CHECKPOINT_DATA_BUFFER_BASE_ADDR)
+	{
+		page->wholeData = malloc(BYTES_PER_DATA_REGION_OF_PAGE);
+		assert(page->wholeData != NULL);
+		memcpy(page->wholeData, pageDataBuffer, BYTES_PER_DATA_REGION_OF_PAGE);
+	}
+	if(spareDataBuffer)
+		memcpy(page->spare, spareDataBuffer, SIM_NAND_KEPT_SPARE_BYTES);
+
+	die->programCnt++;
+	simNandStat.programCnt++;
+}
+
+static void EraseSimBlock(P_SIM_DIE die, unsigned int rowAddress)
+{
+	unsigned int phyBlockNo;
+
+	assert((rowAddress & 0xFF) == 0);
+
+#if (LUNS_PER_DIE == 1)
+	//extended blocks of a single-LUN die run past LUN_1_BASE_ADDR
+	phyBlockNo = rowAddress / PAGES_PER_MLC_BLOCK;
+#else
+	phyBlockNo = ((rowAddress % LUN_1_BASE_ADDR) / PAGES_PER_MLC_BLOCK) + ((rowAddress / LUN_1_BASE_ADDR) * TOTAL_BLOCKS_PER_LUN);
+#endif
+	assert(phyBlockNo < TOTAL_BLOCKS_PER_DIE);
+	FreeSimBlock(die->block[phyBlockNo]);
+	die->block[phyBlockNo] = NULL;
+
+	die->eraseCnt++;
+	simNandStat.eraseCnt++;
+}
+
+static void CopyPageData(P_SIM_NAND_PAGE page, unsigned char* dataBuf)
+{
+	unsigned int blockNo;
+
+	if(page->wholeData)
+	{
+		memcpy(dataBuf, page->wholeData, BYTES_PER_DATA_REGION_OF_PAGE);
+		return;
+	}
+
+	for(blockNo = 0; blockNo < NVME_BLOCKS_PER_PAGE; blockNo++)
+		memcpy(dataBuf + blockNo * BYTES_PER_NVME_BLOCK, page->data[blockNo], SIM_NAND_KEPT_DATA_BYTES);
+}
+
+static void ReadTransferDone(unsigned int chNo, unsigned int wayNo)
+{
+	P_SIM_DIE die = &simDie[chNo][wayNo];
+	P_SIM_NAND_PAGE page;
+	unsigned char* dataBuf = (unsigned char*)die->pendingDataBuf;
+	unsigned char* spareBuf = (unsigned char*)die->pendingSpareBuf;
+
+	page = LookUpPage(die, die->pendingRow, 0);
+
+	if(die->pendingRaw)
+	{
+		if((page == NULL) || !page->programmed)
+			memset(dataBuf, CLEAN_DATA_IN_BYTE, SIM_NAND_RAW_READ_BYTES);
+		else
+		{
+			memset(dataBuf, 0, SIM_NAND_RAW_READ_BYTES);
+			CopyPageData(page, dataBuf);
+			memcpy(dataBuf + BYTES_PER_DATA_REGION_OF_PAGE, page->spare, SIM_NAND_KEPT_SPARE_BYTES);
+		}
+	}
+	else
+	{
+		if((page == NULL) || !page->programmed)
+		{
+			memset(dataBuf, CLEAN_DATA_IN_BYTE, BYTES_PER_DATA_REGION_OF_PAGE);
+			if(spareBuf)
+				memset(spareBuf, CLEAN_DATA_IN_BYTE, BYTES_PER_SPARE_REGION_OF_PAGE);
+		}
+		else
+		{
+			memset(dataBuf, 0, BYTES_PER_DATA_REGION_OF_PAGE);
+			CopyPageData(page, dataBuf);
+			if(spareBuf)
+			{
+				memset(spareBuf, 0, BYTES_PER_SPARE_REGION_OF_PAGE);
+				memcpy(spareBuf, page->spare, SIM_NAND_KEPT_SPARE_BYTES);
+			}
+		}
+
+		//crc valid, no bit errors
+		die->pendingErrorInfo[0] = 0x10000000;
+		die->pendingErrorInfo[1] = 0xFFFFFFFF;
+	}
+
+	*die->pendingCompletion = 1;
+}
+
+static void StatusReportDone(unsigned int chNo, unsigned int wayNo)
+{
+	P_SIM_DIE die = &simDie[chNo][wayNo];
+	unsigned int status;
+
+	status = (die->busyUntil > simNow) ? 0 : SIM_NAND_STATUS_READY;
+	*die->pendingStatusReport = (status << 1) | 1;
+}
+
+void nfc_set_dqs_delay(int channel, unsigned int newValue)
+{
+}
+
+void nfc_set_dq_delay(int channel, unsigned int newValue)
+{
+}
+
+void V2FInitializeHandle(T4REGS* t4regs, void* t4nscRegisterBaseAddress)
+{
+	unsigned char* base = (unsigned char*)t4nscRegisterBaseAddress;
+
+	t4regs->t4regID = (T4REG_ID*)(base + 0);
+	t4regs->t4regCFG = (T4REG_CFG*)(base + 0x1000);
+	t4regs->t4regEXT = (T4REG_EXT*)(base + 0x2000);
+	t4regs->t4regCC = (T4REG_CC*)(base + 0x3000);
+	t4regs->t4regBP = (T4REG_BP*)(base + 0x3800);
+	t4regs->t4regSP = (T4REG_SP*)(base + 0x4000);
+
+	//commands are queued by the model itself, so the controller queue never fills up
+	t4regs->t4regID->queueNotFull = 1;
+	t4regs->t4regID->queueCount = 0;
+	t4regs->t4regBP->nandReadyBusy = (1 << NSC_MAX_WAYS) - 1;
+}
+
+void V2FResetSync(T4REGS* t4regs, int way)
+{
+	unsigned int chNo = ChannelOf(t4regs);
+
+	SimProgress();
+	OccupyChannel(chNo, simNow, simTiming.cmdNs);
+}
+
+void V2FSetFeaturesSync(T4REGS* t4regs, int way, unsigned int feature0x02, unsigned int feature0x10, unsigned int feature0x91, unsigned int feature0x01, unsigned int payLoadAddr)
+{
+	unsigned int chNo = ChannelOf(t4regs);
+
+	SimProgress();
+	SimWaitUntil(OccupyChannel(chNo, simNow, 4 * simTiming.cmdNs));
+}
+
+void V2FReadPageTriggerAsync(T4REGS* t4regs, int way, unsigned int rowAddress)
+{
+	unsigned int chNo = ChannelOf(t4regs);
+	P_SIM_DIE die = &simDie[chNo][way];
+	SIM_TIME cmdEnd;
+
+	SimProgress();
+	cmdEnd = OccupyChannel(chNo, die->busyUntil, simTiming.cmdNs);
+	OccupyDie(die, cmdEnd, cmdEnd + simTiming.tR);
+
+	die->pendingRow = rowAddress;
+	die->readCnt++;
+	simNandStat.readCnt++;
+}
+
+void V2FReadPageTransferAsync(T4REGS* t4regs, int way, void* pageDataBuffer, void* spareDataBuffer, unsigned int* errorInformation, unsigned int* completion, unsigned int rowAddress)
+{
+	unsigned int chNo = ChannelOf(t4regs);
+	P_SIM_DIE die = &simDie[chNo][way];
+	SIM_TIME xferEnd, xferStart;
+
+	SimProgress();
+	*completion = 0;
+
+	xferEnd = OccupyChannel(chNo, die->busyUntil, simTiming.cmdNs + PageTransferTime());
+	xferStart = xferEnd - simTiming.cmdNs - PageTransferTime();
+	OccupyDie(die, xferStart, xferEnd);
+
+	die->pendingRow = rowAddress;
+	die->pendingDataBuf = pageDataBuffer;
+	die->pendingSpareBuf = spareDataBuffer;
+	die->pendingErrorInfo = errorInformation;
+	die->pendingCompletion = completion;
+	die->pendingRaw = 0;
+
+	SimScheduleEvent(xferEnd, ReadTransferDone, chNo, way);
+}
+
+void V2FReadPageTransferRawAsync(T4REGS* t4regs, int way, void* pageDataBuffer, unsigned int* completion)
+{
+	unsigned int chNo = ChannelOf(t4regs);
+	P_SIM_DIE die = &simDie[chNo][way];
+	SIM_TIME xferEnd, xferStart;
+
+	SimProgress();
+	*completion = 0;
+
+	xferEnd = OccupyChannel(chNo, die->busyUntil, simTiming.cmdNs + PageTransferTime());
+	xferStart = xferEnd - simTiming.cmdNs - PageTransferTime();
+	OccupyDie(die, xferStart, xferEnd);
+
+	die->pendingDataBuf = pageDataBuffer;
+	die->pendingSpareBuf = NULL;
+	die->pendingErrorInfo = NULL;
+	die->pendingCompletion = completion;
+	die->pendingRaw = 1;
+
+	SimScheduleEvent(xferEnd, ReadTransferDone, chNo, way);
+}
+
+void V2FProgramPageAsync(T4REGS* t4regs, int way, unsigned int rowAddress, void* pageDataBuffer, void* spareDataBuffer)
+{
+	unsigned int chNo = ChannelOf(t4regs);
+	P_SIM_DIE die = &simDie[chNo][way];
+	SIM_TIME xferEnd;
+
+	SimProgress();
+	xferEnd = OccupyChannel(chNo, die->busyUntil, simTiming.cmdNs + PageTransferTime());
+	OccupyDie(die, xferEnd - PageTransferTime(), ArrayProgramStart(die, xferEnd) + simTiming.tPROG);
+
+	ProgramSimPage(chNo, way, rowAddress, pageDataBuffer, spareDataBuffer);
+}
+
+void V2FEraseBlockAsync(T4REGS* t4regs, int way, unsigned int rowAddress)
+{
+	unsigned int chNo = ChannelOf(t4regs);
+	P_SIM_DIE die = &simDie[chNo][way];
+	SIM_TIME cmdEnd;
+
+	SimProgress();
+	cmdEnd = OccupyChannel(chNo, die->busyUntil, simTiming.cmdNs);
+	OccupyDie(die, cmdEnd, cmdEnd + simTiming.tBERS);
+
+	EraseSimBlock(die, rowAddress);
+}
+
+#if SUPPORT_MULTI_PLANE
+//both planes sense at once, each page stays in the register of its plane until its own transfer
+void V2FReadPageTriggerMultiPlaneAsync(T4REGS* t4regs, int way, unsigned int rowAddress0, unsigned int rowAddress1)
+{
+	unsigned int chNo = ChannelOf(t4regs);
+	P_SIM_DIE die = &simDie[chNo][way];
+	SIM_TIME cmdEnd;
+
+	SimProgress();
+	cmdEnd = OccupyChannel(chNo, die->busyUntil, 2 * simTiming.cmdNs);
+	OccupyDie(die, cmdEnd, cmdEnd + simTiming.tR);
+
+	die->pendingRow = rowAddress0;
+	die->readCnt += 2;
+	simNandStat.readCnt += 2;
+}
+
+void V2FProgramPageMultiPlaneAsync(T4REGS* t4regs, int way, unsigned int rowAddress0, void* pageDataBuffer0, void* spareDataBuffer0,
+		unsigned int rowAddress1, void* pageDataBuffer1, void* spareDataBuffer1)
+{
+	unsigned int chNo = ChannelOf(t4regs);
+	P_SIM_DIE die = &simDie[chNo][way];
+	SIM_TIME xferEnd;
+
+	SimProgress();
+	xferEnd = OccupyChannel(chNo, die->busyUntil, 2 * (simTiming.cmdNs + PageTransferTime()));
+	OccupyDie(die, xferEnd - 2 * PageTransferTime() - simTiming.cmdNs, xferEnd + simTiming.tPROG);
+
+	ProgramSimPage(chNo, way, rowAddress0, pageDataBuffer0, spareDataBuffer0);
+	ProgramSimPage(chNo, way, rowAddress1, pageDataBuffer1, spareDataBuffer1);
+}
+
+void V2FEraseBlockMultiPlaneAsync(T4REGS* t4regs, int way, unsigned int rowAddress0, unsigned int rowAddress1)
+{
+	unsigned int chNo = ChannelOf(t4regs);
+	P_SIM_DIE die = &simDie[chNo][way];
+	SIM_TIME cmdEnd;
+
+	SimProgress();
+	cmdEnd = OccupyChannel(chNo, die->busyUntil, 2 * simTiming.cmdNs);
+	OccupyDie(die, cmdEnd, cmdEnd + simTiming.tBERS);
+
+	EraseSimBlock(die, rowAddress0);
+	EraseSimBlock(die, rowAddress1);
+}
+#endif
+
+#if SUPPORT_CACHE_OPERATION
+void V2FProgramPageCacheAsync(T4REGS* t4regs, int way, unsigned int rowAddress, void* pageDataBuffer, void* spareDataBuffer)
+{
+	unsigned int chNo = ChannelOf(t4regs);
+	P_SIM_DIE die = &simDie[chNo][way];
+	SIM_TIME xferEnd, arrayStart;
+
+	SimProgress();
+	xferEnd = OccupyChannel(chNo, die->busyUntil, simTiming.cmdNs + PageTransferTime());
+	arrayStart = ArrayProgramStart(die, xferEnd);
+	OccupyDie(die, xferEnd - PageTransferTime(), arrayStart + simTiming.tPROG);
+	die->busyUntil = arrayStart;
+
+	ProgramSimPage(chNo, way, rowAddress, pageDataBuffer, spareDataBuffer);
+}
+
+void V2FReadPageTransferCacheAsync(T4REGS* t4regs, int way, void* pageDataBuffer, void* spareDataBuffer, unsigned int* errorInformation, unsigned int* completion, unsigned int rowAddress, unsigned int nextRowAddress)
+{
+	unsigned int chNo = ChannelOf(t4regs);
+	P_SIM_DIE die = &simDie[chNo][way];
+	SIM_TIME cmdEnd, xferEnd;
+
+	SimProgress();
+	*completion = 0;
+
+	cmdEnd = OccupyChannel(chNo, die->busyUntil, simTiming.cmdNs);
+	xferEnd = OccupyChannel(chNo, cmdEnd, simTiming.cmdNs + PageTransferTime());
+	OccupyDie(die, cmdEnd, (xferEnd > cmdEnd + simTiming.tR) ? xferEnd : cmdEnd + simTiming.tR);
+
+	die->pendingRow = rowAddress;
+	die->pendingDataBuf = pageDataBuffer;
+	die->pendingSpareBuf = spareDataBuffer;
+	die->pendingErrorInfo = errorInformation;
+	die->pendingCompletion = completion;
+	die->pendingRaw = 0;
+	die->readCnt++;
+	simNandStat.readCnt++;
+
+	SimScheduleEvent(xferEnd, ReadTransferDone, chNo, way);
+}
+#endif
+
+#if SUPPORT_SUSPEND
+void V2FSuspendAsync(T4REGS* t4regs, int way)
+{
+	unsigned int chNo = ChannelOf(t4regs);
+	P_SIM_DIE die = &simDie[chNo][way];
+	SIM_TIME cmdEnd;
+
+	SimProgress();
+	cmdEnd = OccupyChannel(chNo, simNow, simTiming.cmdNs);
+	if((die->suspendedTime != 0) || (die->arrayBusyUntil <= cmdEnd + simTiming.tSUS))
+		return;
+
+	die->suspendedTime = die->arrayBusyUntil - (cmdEnd + simTiming.tSUS);
+	die->busyTime -= die->suspendedTime;
+	die->busyUntil = cmdEnd + simTiming.tSUS;
+	die->arrayBusyUntil = die->busyUntil;
+
+	simNandStat.suspendCnt++;
+}
+
+void V2FResumeAsync(T4REGS* t4regs, int way)
+{
+	unsigned int chNo = ChannelOf(t4regs);
+	P_SIM_DIE die = &simDie[chNo][way];
+	SIM_TIME cmdEnd;
+
+	SimProgress();
+	cmdEnd = OccupyChannel(chNo, die->busyUntil, simTiming.cmdNs);
+	if(die->suspendedTime == 0)
+		return;
+
+	OccupyDie(die, cmdEnd, cmdEnd + die->suspendedTime);
+	die->suspendedTime = 0;
+}
+#endif
+
+void V2FStatusCheckAsync(T4REGS* t4regs, int way, unsigned int* statusReport)
+{
+	unsigned int chNo = ChannelOf(t4regs);
+	P_SIM_DIE die = &simDie[chNo][way];
+
+	SimProgress();
+	*statusReport = 0;
+	die->pendingStatusReport = statusReport;
+
+	SimScheduleEvent(OccupyChannel(chNo, simNow, simTiming.statusNs), StatusReportDone, chNo, way);
+}
+
+void V2FReadIdAsync(T4REGS* t4regs, int way, unsigned int* statusReport, unsigned int* completion)
+{
+	unsigned char* id = (unsigned char*)statusReport;
+
+	//Toggle NAND style id bytes, doubled as the controller reports them in DDR mode
+	id[0] = 0x2C; id[2] = 0x84; id[4] = 0x64; id[6] = 0x3C;
+	id[8] = 0xA5; id[10] = 0x04;
+	*completion = 1;
+}
+
+void V2FReadIdSync(T4REGS* t4regs, int way, unsigned int* statusReport)
+{
+	unsigned char buf[8] = {0};
+	unsigned char idBytes[24] = {0};
+	int i;
+
+	V2FReadIdAsync(t4regs, way, (unsigned int*)idBytes, (unsigned int*)&idBytes[16]);
+
+	for (i = 0; i < 6; i++)
+		buf[i] = idBytes[i * 2];
+	for (i = 0; i < 8; i++)
+		((unsigned char*)statusReport)[i] = buf[i];
+}
+
+unsigned int V2FReadyBusyAsync(T4REGS* t4regs)
+{
+	unsigned int chNo = ChannelOf(t4regs);
+	unsigned int wayNo, readyBusy;
+
+	SimPoll();
+
+	readyBusy = 0;
+	for(wayNo = 0; wayNo < USER_WAYS; wayNo++)
+		if(simDie[chNo][wayNo].busyUntil <= simNow)
+			readyBusy |= 1 << wayNo;
+
+	t4regs->t4regBP->nandReadyBusy = readyBusy;
+
+	return readyBusy;
+}
+
+void SimGetNandStat(P_SIM_NAND_STAT stat)
+{
+	*stat = simNandStat;
+}
+
+SIM_TIME SimGetDieBusyTime(unsigned int chNo, unsigned int wayNo)
+{
+	return simDie[chNo][wayNo].busyTime;
+}
+
+SIM_TIME SimGetChannelBusyTime(unsigned int chNo)
+{
+	return simChannel[chNo].busyTime;
+}
@@ -0,0 +1,226 @@
+//////////////////////////////////////////////////////////////////////////////////
+// sim.h for Cosmos+ OpenSSD
+//
+// This file is part of Cosmos+ OpenSSD.
+//
+// Cosmos+ OpenSSD is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3, or (at your option)
+// any later version.
+//
+// Cosmos+ OpenSSD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Cosmos+ OpenSSD; see the file COPYING.
+// If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Project Name: Cosmos+ OpenSSD
+// Design Name: Cosmos+ Firmware (host simulator)
+// Module Name: Host Simulator
+// File Name: sim.h
+//
+// Version: v1.0.4
+//
+// Description:
+//   - define virtual clock, event queue, timed NAND model and host DMA model
+//     used to run the FTL on a Linux host
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Revision History:
+//
+// * v1.0.4
+//   - a page programmed from a checkpoint or bad block table buffer keeps its whole data region
+//
+// * v1.0.3
+//   - a page keeps the host data stamp of each of its NVMe blocks, command slots know their LBA range
+//
+// * v1.0.2
+//   - suspend latency and the remaining array time of a suspended die
+//
+// * v1.0.1
+//   - a die keeps the end of its array operation apart from its ready time
+//
+// * v1.0.0
+//   - First draft
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SIM_H_
+#define SIM_H_
+
+#include "../ftl_config.h"
+
+typedef unsigned long long SIM_TIME;	//nanoseconds of simulated time
+
+#define SIM_NS_PER_US		1000ULL
+#define SIM_NS_PER_MS		1000000ULL
+#define SIM_NS_PER_SEC		1000000000ULL
+
+#define SIM_TIME_NONE		0xffffffffffffffffULL
+
+//number of polls without any device activity before the clock jumps to the next event
+#define SIM_IDLE_POLL_LIMIT		(4 * USER_CHANNELS)
+
+#define SIM_MAX_EVENTS			8192
+#define SIM_MAX_CMD_SLOTS		256
+
+//bytes kept at the start of every NVMe block of a programmed page (table markers and host data stamps)
+#define SIM_NAND_KEPT_DATA_BYTES	8
+#define SIM_NAND_KEPT_SPARE_BYTES	12
+
+typedef void (*SIM_EVENT_HANDLER)(unsigned int arg0, unsigned int arg1);
+
+typedef struct _SIM_EVENT {
+	SIM_TIME time;
+	unsigned long long seq;
+	SIM_EVENT_HANDLER handler;
+	unsigned int arg0;
+	unsigned int arg1;
+} SIM_EVENT, *P_SIM_EVENT;
+
+typedef struct _SIM_TIMING {
+	SIM_TIME tR;				//array read (page to register)
+	SIM_TIME tPROG;				//array program
+	SIM_TIME tBERS;				//block erase
+	SIM_TIME tSUS;				//program or erase suspend
+	SIM_TIME cmdNs;				//command/address cycles on the channel
+	SIM_TIME statusNs;			//status read on the channel
+	SIM_TIME nsPerKB;			//channel data transfer per KiB
+	SIM_TIME pcieNsPer4KB;		//host DMA per NVMe block
+	SIM_TIME pollNs;			//firmware cost charged per poll of the device
+} SIM_TIMING, *P_SIM_TIMING;
+
+typedef struct _SIM_NAND_PAGE {
+	unsigned char programmed;
+	unsigned char data[NVME_BLOCKS_PER_PAGE][SIM_NAND_KEPT_DATA_BYTES];
+	unsigned char* wholeData;			//the data region of a metadata page, NULL for a page of slices
+	unsigned char spare[SIM_NAND_KEPT_SPARE_BYTES];
+} SIM_NAND_PAGE, *P_SIM_NAND_PAGE;
+
+typedef struct _SIM_NAND_BLOCK {
+	SIM_NAND_PAGE page[PAGES_PER_MLC_BLOCK];
+} SIM_NAND_BLOCK, *P_SIM_NAND_BLOCK;
+
+typedef struct _SIM_DIE {
+	SIM_TIME busyUntil;
+	SIM_TIME arrayBusyUntil;	//later than busyUntil while a cache program runs
+	SIM_TIME suspendedTime;		//array time left to a suspended program or erase
+	SIM_TIME busyTime;
+	unsigned int pendingRow;
+	void* pendingDataBuf;
+	void* pendingSpareBuf;
+	unsigned int* pendingErrorInfo;
+	unsigned int* pendingCompletion;
+	unsigned int* pendingStatusReport;
+	unsigned int pendingRaw;
+	unsigned long long readCnt;
+	unsigned long long programCnt;
+	unsigned long long eraseCnt;
+	P_SIM_NAND_BLOCK block[TOTAL_BLOCKS_PER_DIE];
+} SIM_DIE, *P_SIM_DIE;
+
+typedef struct _SIM_CHANNEL {
+	SIM_TIME busFreeAt;
+	SIM_TIME busyTime;
+} SIM_CHANNEL, *P_SIM_CHANNEL;
+
+typedef struct _SIM_NAND_STAT {
+	unsigned long long readCnt;
+	unsigned long long programCnt;
+	unsigned long long eraseCnt;
+	unsigned long long overwriteCnt;
+	unsigned long long suspendCnt;
+} SIM_NAND_STAT, *P_SIM_NAND_STAT;
+
+typedef struct _SIM_CMD_SLOT {
+	unsigned int valid : 1;
+	unsigned int manualCompletion : 1;	//a DMA was issued without auto completion (FUA write)
+	unsigned int reserved0 : 30;
+	unsigned int op;
+	unsigned int startLba;
+	unsigned int nlb;
+	unsigned int writeSeq;				//stamped into the data of a write
+	unsigned int submitEventSeq;
+	unsigned int expectedDmaCnt;
+	unsigned int doneDmaCnt;
+	SIM_TIME submitTime;
+} SIM_CMD_SLOT, *P_SIM_CMD_SLOT;
+
+//written by the host model at the start of every NVMe block it transfers to the device
+typedef struct _SIM_DATA_STAMP {
+	unsigned int lba;
+	unsigned int writeSeq;
+} SIM_DATA_STAMP, *P_SIM_DATA_STAMP;
+
+//what the host may read back from an NVMe block
+typedef struct _SIM_LBA_STATE {
+	unsigned int writeSeq;				//last write or deallocate submitted, 0 if never written
+	unsigned int settledEventSeq;		//host event when the last write or deallocate in flight completed
+	unsigned short inFlightCnt;			//writes and deallocates submitted but not completed
+	unsigned char overlapped : 1;		//the last write was submitted while another one was in flight
+	unsigned char deallocated : 1;
+	unsigned char reserved0 : 6;
+	unsigned char reserved1;
+} SIM_LBA_STATE, *P_SIM_LBA_STATE;
+
+typedef struct _SIM_DATA_CHECK_STAT {
+	unsigned long long checkedBlockCnt;
+	unsigned long long skippedBlockCnt;	//never written, deallocated or written concurrently with the read
+} SIM_DATA_CHECK_STAT, *P_SIM_DATA_CHECK_STAT;
+
+typedef void (*SIM_CMD_DONE_HANDLER)(unsigned int cmdSlotTag, SIM_TIME submitTime);
+
+#define SIM_TRACE_OP_READ		0
+#define SIM_TRACE_OP_WRITE		1
+#define SIM_TRACE_OP_FLUSH		2
+#define SIM_TRACE_OP_TRIM		3	//Dataset Management deallocate
+#define SIM_TRACE_OP_COUNT		4
+
+typedef struct _SIM_TRACE_RECORD {
+	SIM_TIME time;					//arrival time relative to the first record
+	unsigned int op;
+	unsigned int nlb;				//number of 4 KiB NVMe blocks
+	unsigned long long startLba;	//4 KiB NVMe block address
+} SIM_TRACE_RECORD, *P_SIM_TRACE_RECORD;
+
+//sim_core.c
+void SimInitClock();
+void SimPoll();
+void SimProgress();
+void SimWaitUntil(SIM_TIME time);
+void SimSetHostWakeup(SIM_TIME time);
+void SimScheduleEvent(SIM_TIME time, SIM_EVENT_HANDLER handler, unsigned int arg0, unsigned int arg1);
+void SimRunDueEvents();
+SIM_TIME SimNextEventTime();
+
+//sim_memory.c
+void SimInitDram();
+void SimResetDram();
+
+//nsc_driver_sim.c
+void SimInitNand();
+void SimGetNandStat(P_SIM_NAND_STAT stat);
+SIM_TIME SimGetDieBusyTime(unsigned int chNo, unsigned int wayNo);
+SIM_TIME SimGetChannelBusyTime(unsigned int chNo);
+
+//host_lld_sim.c
+void SimInitHost(SIM_CMD_DONE_HANDLER cmdDoneHandler);
+void SimHostSubmitCmd(unsigned int cmdSlotTag, unsigned int op, unsigned int startLba, unsigned int nlb);
+void SimGetDataCheckStat(P_SIM_DATA_CHECK_STAT stat);
+unsigned int SimHostCmdSlotBusy(unsigned int cmdSlotTag);
+
+//sim_trace.c
+int SimOpenTrace(const char* path);
+int SimReadTrace(P_SIM_TRACE_RECORD record);
+void SimCloseTrace();
+
+extern SIM_TIME simNow;
+extern SIM_TIMING simTiming;
+extern int simVerbose;
+
+#endif /* SIM_H_ */
@@ -0,0 +1,187 @@
+//////////////////////////////////////////////////////////////////////////////////
+// sim_core.c for Cosmos+ OpenSSD
+//
+// This file is part of Cosmos+ OpenSSD.
+//
+// Cosmos+ OpenSSD is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3, or (at your option)
+// any later version.
+//
+// Cosmos+ OpenSSD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Cosmos+ OpenSSD; see the file COPYING.
+// If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Project Name: Cosmos+ OpenSSD
+// Design Name: Cosmos+ Firmware (host simulator)
+// Module Name: Simulation Core
+// File Name: sim_core.c
+//
+// Version: v1.0.0
+//
+// Description:
+//   - virtual clock driven by the polling loops of the firmware
+//   - time ordered event queue for device side completions
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Revision History:
+//
+// * v1.0.0
+//   - First draft
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <assert.h>
+#include "sim.h"
+
+SIM_TIME simNow;
+SIM_TIMING simTiming = {
+	45 * SIM_NS_PER_US,		//tR
+	350 * SIM_NS_PER_US,	//tPROG
+	3500 * SIM_NS_PER_US,	//tBERS
+	20 * SIM_NS_PER_US,		//tSUS
+	200,					//cmdNs
+	100,					//statusNs
+	5120,					//nsPerKB (200 MB/s toggle channel)
+	1300,					//pcieNsPer4KB
+	100						//pollNs
+};
+
+static SIM_EVENT eventHeap[SIM_MAX_EVENTS];
+static unsigned int eventCnt;
+static unsigned long long eventSeq;
+static unsigned int idlePollCnt;
+static SIM_TIME hostWakeup;
+
+void SimInitClock()
+{
+	simNow = 0;
+	eventCnt = 0;
+	eventSeq = 0;
+	idlePollCnt = 0;
+	hostWakeup = SIM_TIME_NONE;
+}
+
+static int EarlierEvent(P_SIM_EVENT a, P_SIM_EVENT b)
+{
+	if(a->time != b->time)
+		return a->time < b->time;
+
+	return a->seq < b->seq;
+}
+
+void SimScheduleEvent(SIM_TIME time, SIM_EVENT_HANDLER handler, unsigned int arg0, unsigned int arg1)
+{
+	unsigned int child, parent;
+	SIM_EVENT event;
+
+	if(eventCnt >= SIM_MAX_EVENTS)
+		assert(!"[WARNING] simulator event queue overflow [WARNING]");
+
+	event.time = time;
+	event.seq = eventSeq++;
+	event.handler = handler;
+	event.arg0 = arg0;
+	event.arg1 = arg1;
+
+	child = eventCnt++;
+	while(child > 0)
+	{
+		parent = (child - 1) / 2;
+		if(!EarlierEvent(&event, &eventHeap[parent]))
+			break;
+
+		eventHeap[child] = eventHeap[parent];
+		child = parent;
+	}
+	eventHeap[child] = event;
+}
+
+static void PopEvent(P_SIM_EVENT event)
+{
+	unsigned int parent, child;
+	SIM_EVENT last;
+
+	*event = eventHeap[0];
+	last = eventHeap[--eventCnt];
+
+	parent = 0;
+	while((child = 2 * parent + 1) < eventCnt)
+	{
+		if((child + 1 < eventCnt) && EarlierEvent(&eventHeap[child + 1], &eventHeap[child]))
+			child++;
+		if(!EarlierEvent(&eventHeap[child], &last))
+			break;
+
+		eventHeap[parent] = eventHeap[child];
+		parent = child;
+	}
+	eventHeap[parent] = last;
+}
+
+void SimRunDueEvents()
+{
+	SIM_EVENT event;
+
+	while(eventCnt && (eventHeap[0].time <= simNow))
+	{
+		PopEvent(&event);
+		event.handler(event.arg0, event.arg1);
+		idlePollCnt = 0;
+	}
+}
+
+SIM_TIME SimNextEventTime()
+{
+	SIM_TIME next;
+
+	next = (hostWakeup > simNow) ? hostWakeup : SIM_TIME_NONE;
+	if(eventCnt && (eventHeap[0].time < next))
+		next = eventHeap[0].time;
+
+	return next;
+}
+
+void SimSetHostWakeup(SIM_TIME time)
+{
+	hostWakeup = time;
+}
+
+void SimProgress()
+{
+	idlePollCnt = 0;
+}
+
+//called wherever the firmware polls a device register; charges the poll and skips idle time
+void SimPoll()
+{
+	SIM_TIME next;
+
+	simNow += simTiming.pollNs;
+	SimRunDueEvents();
+
+	if(++idlePollCnt < SIM_IDLE_POLL_LIMIT)
+		return;
+
+	next = SimNextEventTime();
+	if((next != SIM_TIME_NONE) && (next > simNow))
+		simNow = next;
+
+	idlePollCnt = 0;
+	SimRunDueEvents();
+}
+
+void SimWaitUntil(SIM_TIME time)
+{
+	if(time > simNow)
+		simNow = time;
+
+	SimRunDueEvents();
+}
@@ -0,0 +1,830 @@
+//////////////////////////////////////////////////////////////////////////////////
+// sim_main.c for Cosmos+ OpenSSD
+//
+// This file is part of Cosmos+ OpenSSD.
+//
+// Cosmos+ OpenSSD is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3, or (at your option)
+// any later version.
+//
+// Cosmos+ OpenSSD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Cosmos+ OpenSSD; see the file COPYING.
+// If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Project Name: Cosmos+ OpenSSD
+// Design Name: Cosmos+ Firmware (host simulator)
+// Module Name: Simulator Main
+// File Name: sim_main.c
+//
+// Version: v1.0.0
+//
+// Description:
+//   - run InitFTL and the nvme_main I/O loop against a closed-loop synthetic host
+//     or an open-loop trace replay (sim_trace.c)
+//   - commands enter through handle_nvme_io_cmd; trace reads and writes larger
+//     than 256 NVMe blocks are split into several commands, a discard is one
+//     Dataset Management command
+//   - report throughput, latency percentiles, write amplification, GC time
+//     share and NAND/channel utilization in simulated time
+//   - restart the FTL over the NAND it left and check the logical map it rebuilds
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Revision History:
+//
+// * v1.0.0
+//   - First draft
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "sim.h"
+#include "../ftl_config.h"
+#include "../request_allocation.h"
+#include "../request_transform.h"
+#include "../request_schedule.h"
+#include "../garbage_collection.h"
+#include "../write_back.h"
+#include "../checkpoint.h"
+#include "../wear_leveling.h"
+#include "../write_temperature.h"
+#include "../nvme/nvme.h"
+#include "../nvme/nvme_io_cmd.h"
+
+void __real_GarbageCollection(unsigned int dieNo);
+unsigned int __real_CheckDataBufHit(unsigned int reqSlotTag);
+
+#define SIM_MAX_BLOCKS_PER_CMD		256
+
+typedef enum {
+	SIM_WL_SEQ_WRITE = 0,
+	SIM_WL_RAND_WRITE,
+	SIM_WL_SEQ_READ,
+	SIM_WL_RAND_READ,
+	SIM_WL_MIXED
+} SIM_WORKLOAD;
+
+typedef struct _SIM_LATENCY_STAT {
+	unsigned long long cnt;
+	unsigned long long capacity;
+	SIM_TIME sum;
+	SIM_TIME* sample;
+} SIM_LATENCY_STAT, *P_SIM_LATENCY_STAT;
+
+int simVerbose;
+
+static SIM_WORKLOAD workload = SIM_WL_RAND_WRITE;
+static unsigned int readPercent = 70;
+static unsigned int hotPercent;
+static unsigned int scanPercent;
+static unsigned long long scanLba;
+static unsigned int trimPercent;
+static unsigned int fuaPercent;
+static unsigned int flushInterval;
+static unsigned int cmdsSinceFlush;
+static unsigned int blocksPerCmd = 1;
+static unsigned int queueDepth = 32;
+static unsigned long long cmdCnt = 100000;
+static unsigned int spanBlocks;
+static unsigned int precondition;
+static unsigned long long rngState = 0x9e3779b97f4a7c15ULL;
+static const char* tracePath;
+static unsigned int traceAsFast;
+static double traceSpeedup = 1.0;
+
+static unsigned int cmdOp[SIM_MAX_CMD_SLOTS];
+static DATASET_MANAGEMENT_RANGE cmdDsmRange[SIM_MAX_CMD_SLOTS];
+static SIM_TIME cmdArrival[SIM_MAX_CMD_SLOTS];
+static unsigned int freeSlot[SIM_MAX_CMD_SLOTS];
+static unsigned int freeSlotCnt;
+static unsigned int outstandingCmdCnt;
+static unsigned long long completedCmdCnt;
+static unsigned long long seqLba;
+static unsigned long long hostBlockCnt;
+static unsigned long long hostWriteSliceCnt;
+static unsigned long long bufLookupCnt;
+static unsigned long long bufHitCnt;
+static SIM_LATENCY_STAT latencyStat[SIM_TRACE_OP_COUNT];
+
+static unsigned int gcDepth;
+static SIM_TIME gcTime;
+
+static unsigned int gcPolicyNo = GC_POLICY_DEFAULT;
+static unsigned int gcCrossDie;
+static unsigned int bufPolicyNo = DATA_BUF_POLICY_DEFAULT;
+
+static unsigned int restartInterval;
+static unsigned int restartCnt;
+static unsigned int checkpointRestartCnt;
+static unsigned long long untrimmedSliceCnt;
+static unsigned int* restartSliceMap;
+static unsigned int* restartSliceOwner;		//logical slice the rebuilt map maps to each virtual slice
+
+char inbyte(void)
+{
+	return 0;
+}
+
+static unsigned long long NextRandom()
+{
+	rngState ^= rngState << 13;
+	rngState ^= rngState >> 7;
+	rngState ^= rngState << 17;
+
+	return rngState;
+}
+
+static void CmdDone(unsigned int cmdSlotTag, SIM_TIME submitTime)
+{
+	P_SIM_LATENCY_STAT stat;
+	SIM_TIME latency;
+
+	stat = &latencyStat[cmdOp[cmdSlotTag]];
+	latency = simNow - cmdArrival[cmdSlotTag];
+
+	if(stat->cnt == stat->capacity)
+	{
+		stat->capacity = stat->capacity ? stat->capacity * 2 : 65536;
+		stat->sample = realloc(stat->sample, stat->capacity * sizeof(SIM_TIME));
+		if(stat->sample == NULL)
+		{
+			fprintf(stderr, "[sim] out of memory for latency samples\n");
+			exit(1);
+		}
+	}
+	stat->sample[stat->cnt++] = latency;
+	stat->sum += latency;
+
+	freeSlot[freeSlotCnt++] = cmdSlotTag;
+	outstandingCmdCnt--;
+	completedCmdCnt++;
+}
+
+//build an NVMe I/O command and run it through the same path as nvme_main
+static void SubmitCmd(unsigned int op, unsigned int startLba, unsigned int nlb, SIM_TIME arrival)
+{
+	NVME_COMMAND nvmeCmd;
+	NVME_IO_COMMAND* nvmeIOCmd;
+	unsigned int cmdSlotTag;
+
+	cmdSlotTag = freeSlot[--freeSlotCnt];
+	cmdOp[cmdSlotTag] = op;
+	cmdArrival[cmdSlotTag] = arrival;
+	outstandingCmdCnt++;
+
+	memset(&nvmeCmd, 0, sizeof(NVME_COMMAND));
+	nvmeCmd.qID = 1;
+	nvmeCmd.cmdSlotTag = cmdSlotTag;
+	nvmeIOCmd = (NVME_IO_COMMAND*)nvmeCmd.cmdDword;
+	nvmeIOCmd->dword[10] = startLba;
+	nvmeIOCmd->dword[12] = nlb ? nlb - 1 : 0;
+
+	if(op == SIM_TRACE_OP_READ)
+		nvmeIOCmd->OPC = IO_NVM_READ;
+	else if(op == SIM_TRACE_OP_WRITE)
+	{
+		nvmeIOCmd->OPC = IO_NVM_WRITE;
+		if(fuaPercent && ((NextRandom() % 100) < fuaPercent))
+			((IO_WRITE_COMMAND_DW12*)&nvmeIOCmd->dword[12])->FUA = 1;
+		hostWriteSliceCnt += (startLba + nlb - 1) / NVME_BLOCKS_PER_SLICE - startLba / NVME_BLOCKS_PER_SLICE + 1;
+	}
+	else if(op == SIM_TRACE_OP_TRIM)
+	{
+		//one deallocate range, fetched by the firmware through PRP1
+		memset(&cmdDsmRange[cmdSlotTag], 0, sizeof(DATASET_MANAGEMENT_RANGE));
+		cmdDsmRange[cmdSlotTag].startingLBA[0] = startLba;
+		cmdDsmRange[cmdSlotTag].lengthInLogicalBlocks = nlb;
+		nvmeIOCmd->OPC = IO_NVM_DATASET_MANAGEMENT;
+		nvmeIOCmd->PRP1[0] = (unsigned int)(unsigned long)&cmdDsmRange[cmdSlotTag];
+		nvmeIOCmd->PRP1[1] = (unsigned int)((unsigned long long)(unsigned long)&cmdDsmRange[cmdSlotTag] >> 32);
+		nvmeIOCmd->dword[10] = 0;
+		nvmeIOCmd->dword[11] = 0x4;
+		nvmeIOCmd->dword[12] = 0;
+	}
+	else
+		nvmeIOCmd->OPC = IO_NVM_FLUSH;
+	if((op == SIM_TRACE_OP_READ) || (op == SIM_TRACE_OP_WRITE))
+		hostBlockCnt += nlb;
+
+	SimHostSubmitCmd(cmdSlotTag, op, startLba, nlb);
+	handle_nvme_io_cmd(&nvmeCmd);
+	ReqTransSliceToLowLevel();
+}
+
+static void SubmitNextCmd(SIM_WORKLOAD curWorkload)
+{
+	unsigned int op, startLba, alignedSpan;
+
+	if(flushInterval && (++cmdsSinceFlush > flushInterval))
+	{
+		cmdsSinceFlush = 0;
+		SubmitCmd(SIM_TRACE_OP_FLUSH, 0, 0, simNow);
+		return;
+	}
+
+	op = ((curWorkload == SIM_WL_SEQ_READ) || (curWorkload == SIM_WL_RAND_READ)) ? SIM_TRACE_OP_READ : SIM_TRACE_OP_WRITE;
+	if(curWorkload == SIM_WL_MIXED)
+		op = ((NextRandom() % 100) < readPercent) ? SIM_TRACE_OP_READ : SIM_TRACE_OP_WRITE;
+	if((op == SIM_TRACE_OP_WRITE) && trimPercent && ((NextRandom() % 100) < trimPercent))
+		op = SIM_TRACE_OP_TRIM;
+
+	alignedSpan = spanBlocks / blocksPerCmd;
+	if(scanPercent && (curWorkload != SIM_WL_SEQ_WRITE) && (curWorkload != SIM_WL_SEQ_READ) && ((NextRandom() % 100) < scanPercent))
+	{
+		//a backup-like sequential read stream interleaved with the random commands
+		SubmitCmd(SIM_TRACE_OP_READ, (scanLba++ % alignedSpan) * blocksPerCmd, blocksPerCmd, simNow);
+		return;
+	}
+
+	if((curWorkload == SIM_WL_SEQ_WRITE) || (curWorkload == SIM_WL_SEQ_READ))
+		startLba = (seqLba++ % alignedSpan) * blocksPerCmd;
+	else if(hotPercent && ((NextRandom() % 100) < hotPercent) && (alignedSpan * (100 - hotPercent) / 100))
+		startLba = (NextRandom() % (alignedSpan * (100 - hotPercent) / 100)) * blocksPerCmd;
+	else
+		startLba = (NextRandom() % alignedSpan) * blocksPerCmd;
+
+	SubmitCmd(op, startLba, blocksPerCmd, simNow);
+}
+
+static void RunGc()
+{
+	SIM_TIME gcStart;
+
+	gcStart = simNow;
+	gcDepth++;
+
+	GcScheduler();
+
+	gcDepth--;
+	gcTime += simNow - gcStart;
+}
+
+//foreground GC called from FindFreeVirtualSlice (linked with --wrap=GarbageCollection)
+void __wrap_GarbageCollection(unsigned int dieNo)
+{
+	SIM_TIME gcStart;
+
+	if(gcDepth)
+	{
+		__real_GarbageCollection(dieNo);
+		return;
+	}
+
+	gcStart = simNow;
+	gcDepth++;
+	__real_GarbageCollection(dieNo);
+	gcDepth--;
+	gcTime += simNow - gcStart;
+}
+
+//slice lookups of ReqTransSliceToLowLevel (linked with --wrap=CheckDataBufHit)
+unsigned int __wrap_CheckDataBufHit(unsigned int reqSlotTag)
+{
+	unsigned int bufEntry;
+
+	bufEntry = __real_CheckDataBufHit(reqSlotTag);
+	bufLookupCnt++;
+	if(bufEntry != DATA_BUF_FAIL)
+		bufHitCnt++;
+
+	return bufEntry;
+}
+
+static void RunFirmwareLoop()
+{
+	if((nvmeDmaReqQ.headReq != REQ_SLOT_TAG_NONE) || notCompletedNandReqCnt || blockedReqCnt)
+	{
+		CheckDoneNvmeDmaReq();
+		SchedulingNandReq();
+	}
+
+	WriteBackScheduler();
+	CheckpointScheduler();
+	LazyEraseScheduler();
+	RunGc();
+	SimPoll();
+}
+
+static void ConfigureFtl()
+{
+	SetGcPolicy(gcPolicyNo);
+	SetGcCopyTarget(gcCrossDie);
+	SetDataBufPolicy(bufPolicyNo);
+}
+
+//the firmware loop without CheckpointScheduler, a background checkpoint in progress queues no more pages
+static void RunFirmwareLoopForRestart()
+{
+	if((nvmeDmaReqQ.headReq != REQ_SLOT_TAG_NONE) || notCompletedNandReqCnt || blockedReqCnt)
+	{
+		CheckDoneNvmeDmaReq();
+		SchedulingNandReq();
+	}
+
+	WriteBackScheduler();
+	LazyEraseScheduler();
+	RunGc();
+	SimPoll();
+}
+
+//every other restart waits until a background checkpoint is being written, for at most another interval of commands
+static unsigned int RestartDue(unsigned long long issuedCmdCnt, unsigned long long restartCmdCnt)
+{
+	if(!restartInterval || (issuedCmdCnt < restartCmdCnt))
+		return 0;
+
+	if((restartCnt % 2) && !checkpointMapPtr->writing && (issuedCmdCnt < restartCmdCnt + restartInterval))
+		return 0;
+
+	return 1;
+}
+
+//the commands are completed and flushed, so that the host can read back all it wrote, then the power is cut
+//with the NAND idle and the FTL is initialized again over it, it has to map every logical slice as before
+//except slices trimmed after the last checkpoint, which may come back with the data they had,
+//no virtual slice may be mapped by two logical slices
+static void RestartFtl()
+{
+	unsigned long long workloadCmdCnt;
+	unsigned int sliceAddr, virtualSliceAddr, writing;
+
+	while(outstandingCmdCnt)
+		RunFirmwareLoopForRestart();
+	workloadCmdCnt = completedCmdCnt;
+	SubmitCmd(SIM_TRACE_OP_FLUSH, 0, 0, simNow);
+	while(outstandingCmdCnt)
+		RunFirmwareLoopForRestart();
+	completedCmdCnt = workloadCmdCnt;
+
+	SyncAllLowLevelReqDone();
+	writing = checkpointMapPtr->writing;
+	for(sliceAddr = 0; sliceAddr < SLICES_PER_SSD; sliceAddr++)
+		restartSliceMap[sliceAddr] = logicalSliceMapPtr->logicalSlice[sliceAddr].virtualSliceAddr;
+
+	SimResetDram();
+	InitFTL();
+	ConfigureFtl();
+
+	for(virtualSliceAddr = 0; virtualSliceAddr < SLICES_PER_SSD; virtualSliceAddr++)
+		restartSliceOwner[virtualSliceAddr] = LSA_NONE;
+	for(sliceAddr = 0; sliceAddr < SLICES_PER_SSD; sliceAddr++)
+	{
+		virtualSliceAddr = logicalSliceMapPtr->logicalSlice[sliceAddr].virtualSliceAddr;
+		if(virtualSliceAddr == VSA_NONE)
+			continue;
+
+		if(restartSliceOwner[virtualSliceAddr] != LSA_NONE)
+		{
+			fprintf(stderr, "[sim] restart %u maps logical slices %u and %u to %u\n", restartCnt + 1,
+					restartSliceOwner[virtualSliceAddr], sliceAddr, virtualSliceAddr);
+			assert(!"[WARNING] a restart maps two logical slices to one virtual slice [WARNING]");
+		}
+		restartSliceOwner[virtualSliceAddr] = sliceAddr;
+	}
+
+	for(sliceAddr = 0; sliceAddr < SLICES_PER_SSD; sliceAddr++)
+		if(logicalSliceMapPtr->logicalSlice[sliceAddr].virtualSliceAddr != restartSliceMap[sliceAddr])
+		{
+			if(restartSliceMap[sliceAddr] == VSA_NONE)
+			{
+				untrimmedSliceCnt++;
+				continue;
+			}
+
+			fprintf(stderr, "[sim] restart %u maps logical slice %u to %u, it was mapped to %u\n", restartCnt + 1, sliceAddr,
+					logicalSliceMapPtr->logicalSlice[sliceAddr].virtualSliceAddr, restartSliceMap[sliceAddr]);
+			assert(!"[WARNING] the logical slice map rebuilt by a restart differs [WARNING]");
+		}
+
+	restartCnt++;
+	if(writing)
+		checkpointRestartCnt++;
+}
+
+static void RunWorkload(SIM_WORKLOAD curWorkload, unsigned long long totalCmdCnt, unsigned int restart)
+{
+	unsigned long long issuedCmdCnt, restartCmdCnt;
+
+	issuedCmdCnt = 0;
+	completedCmdCnt = 0;
+	seqLba = 0;
+	restartCmdCnt = restart ? restartInterval : ~0ULL;
+
+	while(completedCmdCnt < totalCmdCnt)
+	{
+		if((issuedCmdCnt < totalCmdCnt) && RestartDue(issuedCmdCnt, restartCmdCnt))
+		{
+			RestartFtl();
+			restartCmdCnt = issuedCmdCnt + restartInterval;
+		}
+
+		if((issuedCmdCnt < totalCmdCnt) && (outstandingCmdCnt < queueDepth))
+		{
+			SubmitNextCmd(curWorkload);
+			issuedCmdCnt++;
+			SimPoll();
+			continue;
+		}
+
+		RunFirmwareLoop();
+	}
+}
+
+//open-loop replay: a record is submitted at its trace time unless QD commands are outstanding
+static unsigned long long ReplayTrace(unsigned long long maxRecordCnt)
+{
+	SIM_TRACE_RECORD record;
+	SIM_TIME traceStart, arrival;
+	unsigned long long recordCnt;
+	unsigned int pending, nlb, startLba;
+
+	traceStart = simNow;
+	recordCnt = 0;
+	arrival = simNow;
+	pending = (maxRecordCnt != 0) && SimReadTrace(&record);
+
+	while(pending || outstandingCmdCnt)
+	{
+		if(pending)
+			arrival = traceAsFast ? simNow : traceStart + (SIM_TIME)(record.time / traceSpeedup);
+
+		if(pending && (outstandingCmdCnt < queueDepth) && (arrival <= simNow))
+		{
+			startLba = (unsigned int)(record.startLba % storageCapacity_L);
+			nlb = ((record.nlb > SIM_MAX_BLOCKS_PER_CMD) && (record.op != SIM_TRACE_OP_TRIM)) ? SIM_MAX_BLOCKS_PER_CMD : record.nlb;
+			if(startLba + nlb > storageCapacity_L)
+				nlb = storageCapacity_L - startLba;
+
+			SubmitCmd(record.op, startLba, nlb, arrival);
+
+			record.startLba = startLba + nlb;
+			record.nlb -= nlb;
+			if(!record.nlb)
+				pending = (++recordCnt < maxRecordCnt) && SimReadTrace(&record);
+
+			SimPoll();
+			continue;
+		}
+
+		SimSetHostWakeup((pending && (outstandingCmdCnt < queueDepth)) ? arrival : SIM_TIME_NONE);
+		RunFirmwareLoop();
+	}
+
+	SimSetHostWakeup(SIM_TIME_NONE);
+	return recordCnt;
+}
+
+static void ResetHostStat()
+{
+	unsigned int op;
+
+	for(op = 0; op < SIM_TRACE_OP_COUNT; op++)
+	{
+		latencyStat[op].cnt = 0;
+		latencyStat[op].sum = 0;
+	}
+	hostBlockCnt = 0;
+	hostWriteSliceCnt = 0;
+	bufLookupCnt = 0;
+	bufHitCnt = 0;
+	gcTime = 0;
+}
+
+static int CompareTime(const void* a, const void* b)
+{
+	SIM_TIME x = *(const SIM_TIME*)a;
+	SIM_TIME y = *(const SIM_TIME*)b;
+
+	return (x > y) - (x < y);
+}
+
+static double Percentile(P_SIM_LATENCY_STAT stat, double pct)
+{
+	unsigned long long index;
+
+	index = (unsigned long long)(pct / 100 * stat->cnt);
+	if(index >= stat->cnt)
+		index = stat->cnt - 1;
+
+	return (double)stat->sample[index] / SIM_NS_PER_US;
+}
+
+static void PrintLatency(const char* name, P_SIM_LATENCY_STAT stat)
+{
+	if(!stat->cnt)
+		return;
+
+	qsort(stat->sample, stat->cnt, sizeof(SIM_TIME), CompareTime);
+	printf("  %-5s cmds %llu  avg %.1f us\n", name, stat->cnt, (double)stat->sum / stat->cnt / SIM_NS_PER_US);
+	printf("        p50 %.1f  p90 %.1f  p99 %.1f  p99.9 %.1f  p99.99 %.1f  max %.1f us\n",
+			Percentile(stat, 50), Percentile(stat, 90), Percentile(stat, 99),
+			Percentile(stat, 99.9), Percentile(stat, 99.99), Percentile(stat, 100));
+}
+
+//slice groups per write temperature, as in the vendor log page VENDOR_LOG_WRITE_TEMPERATURE
+static void PrintWriteTemperature()
+{
+	WRITE_TEMPERATURE_LOG log;
+	unsigned int temperature;
+
+	GetWriteTemperatureLog(&log);
+
+	printf("  temp  %u groups of %u slices by temperature", log.groupCnt, log.slicesPerGroup);
+	for(temperature = 0; temperature <= WRITE_TEMPERATURE_MAX; temperature++)
+		printf(" %u", log.groupCntOfTemperature[temperature]);
+	printf("  writes recorded %u\n", log.recordedWriteCnt);
+}
+
+//erase counts of the good user blocks of all dies
+static void PrintWear()
+{
+	unsigned int dieNo, blockNo, eraseCnt, minEraseCnt, maxEraseCnt, blockCnt;
+	unsigned long long eraseSum;
+
+	minEraseCnt = 0xffffffff;
+	maxEraseCnt = 0;
+	eraseSum = 0;
+	blockCnt = 0;
+	for(dieNo = 0; dieNo < USER_DIES; dieNo++)
+		for(blockNo = 0; blockNo < USER_BLOCKS_PER_DIE; blockNo++)
+		{
+			if(virtualBlockMapPtr->block[dieNo][blockNo].bad)
+				continue;
+
+			eraseCnt = virtualBlockMapPtr->block[dieNo][blockNo].eraseCnt;
+			if(eraseCnt < minEraseCnt)
+				minEraseCnt = eraseCnt;
+			if(eraseCnt > maxEraseCnt)
+				maxEraseCnt = eraseCnt;
+			eraseSum += eraseCnt;
+			blockCnt++;
+		}
+
+	printf("  wear  erase count min %u  avg %.1f  max %u  cold blocks migrated %u\n", minEraseCnt,
+			blockCnt ? (double)eraseSum / blockCnt : 0, maxEraseCnt, wearLevelingMapPtr->migratedBlockCnt);
+}
+
+static void PrintReport(SIM_TIME elapsed, P_SIM_NAND_STAT before, SIM_TIME* dieBusyBefore, SIM_TIME* chBusyBefore, unsigned int copyCntBefore)
+{
+	SIM_NAND_STAT after;
+	SIM_DATA_CHECK_STAT dataCheck;
+	unsigned long long cmds, copies, programs;
+	double sec, dieUtil, chUtil;
+	unsigned int chNo, wayNo, op;
+
+	SimGetNandStat(&after);
+	cmds = 0;
+	for(op = 0; op < SIM_TRACE_OP_COUNT; op++)
+		cmds += latencyStat[op].cnt;
+	sec = (double)elapsed / SIM_NS_PER_SEC;
+	copies = copyCnt - copyCntBefore;
+	programs = after.programCnt - before->programCnt;
+
+	dieUtil = 0;
+	chUtil = 0;
+	for(chNo = 0; chNo < USER_CHANNELS; chNo++)
+	{
+		chUtil += (double)(SimGetChannelBusyTime(chNo) - chBusyBefore[chNo]);
+		for(wayNo = 0; wayNo < USER_WAYS; wayNo++)
+			dieUtil += (double)(SimGetDieBusyTime(chNo, wayNo) - dieBusyBefore[chNo * USER_WAYS + wayNo]);
+	}
+	dieUtil = elapsed ? dieUtil / elapsed / USER_DIES * 100 : 0;
+	chUtil = elapsed ? chUtil / elapsed / USER_CHANNELS * 100 : 0;
+
+	printf("\n[sim] %u ch x %u way, QD %u, GC %s%s\n", USER_CHANNELS, USER_WAYS, queueDepth, gcPolicyTable[GetGcPolicy()].name,
+			GetGcCopyTarget() ? " (cross-die copies)" : "");
+	printf("  elapsed %.3f ms  %.0f IOPS  %.1f MB/s\n", (double)elapsed / SIM_NS_PER_MS,
+			sec ? cmds / sec : 0, sec ? hostBlockCnt * 4096.0 / sec / 1000000 : 0);
+	PrintLatency("read", &latencyStat[SIM_TRACE_OP_READ]);
+	PrintLatency("write", &latencyStat[SIM_TRACE_OP_WRITE]);
+	PrintLatency("flush", &latencyStat[SIM_TRACE_OP_FLUSH]);
+	PrintLatency("trim", &latencyStat[SIM_TRACE_OP_TRIM]);
+	printf("  nand  read %llu  program %llu  erase %llu  overwrite %llu  suspend %llu\n",
+			after.readCnt - before->readCnt, programs,
+			after.eraseCnt - before->eraseCnt, after.overwriteCnt - before->overwriteCnt, after.suspendCnt - before->suspendCnt);
+	if(hostWriteSliceCnt)
+		printf("  waf   %.3f (host slices %llu, gc copies %llu)  nand programs/host slices %.3f\n",
+				(double)(hostWriteSliceCnt + copies) / hostWriteSliceCnt, hostWriteSliceCnt, copies,
+				(double)programs / hostWriteSliceCnt);
+	printf("  buf   %s  hit %.1f %% of %llu slice lookups\n", dataBufPolicyName[GetDataBufPolicy()],
+			bufLookupCnt ? (double)bufHitCnt / bufLookupCnt * 100 : 0, bufLookupCnt);
+	printf("  gc    %.2f %% of elapsed time in GC\n", elapsed ? (double)gcTime / elapsed * 100 : 0);
+	PrintWear();
+	PrintWriteTemperature();
+	printf("  util  die %.1f %%  channel %.1f %%\n", dieUtil, chUtil);
+	SimGetDataCheckStat(&dataCheck);
+	printf("  check %llu NVMe blocks read back the data of their last write, %llu written concurrently or never\n",
+			dataCheck.checkedBlockCnt, dataCheck.skippedBlockCnt);
+	if(restartCnt)
+		printf("  restart %u restarts rebuilt the logical map, %u cut a background checkpoint, %llu trimmed slices mapped again\n",
+				restartCnt, checkpointRestartCnt, untrimmedSliceCnt);
+}
+
+static void SnapshotBusyTime(SIM_TIME* dieBusy, SIM_TIME* chBusy)
+{
+	unsigned int chNo, wayNo;
+
+	for(chNo = 0; chNo < USER_CHANNELS; chNo++)
+	{
+		chBusy[chNo] = SimGetChannelBusyTime(chNo);
+		for(wayNo = 0; wayNo < USER_WAYS; wayNo++)
+			dieBusy[chNo * USER_WAYS + wayNo] = SimGetDieBusyTime(chNo, wayNo);
+	}
+}
+
+static void Usage(const char* prog)
+{
+	fprintf(stderr,
+			"usage: %s [options]\n"
+			"  -w <seqwrite|randwrite|seqread|randread|mixed>  workload (randwrite)\n"
+			"  -t <file>    replay a blkparse, fio iolog or plain trace instead\n"
+			"  -a           replay the trace as fast as possible (ignore timestamps)\n"
+			"  -S <factor>  replay speedup of trace timestamps (1.0)\n"
+			"  -r <pct>     read percentage of the mixed workload (70)\n"
+			"  -d <pct>     percentage of writes replaced by deallocates of the same range (0)\n"
+			"  -k <pct>     skew: pct of random commands hit the first (100 - pct)%% of the span (0)\n"
+			"  -l <pct>     percentage of random commands replaced by reads of a sequential scan (0)\n"
+			"  -u <pct>     percentage of writes with FUA set (0)\n"
+			"  -f <cmds>    flush after every <cmds> synthetic commands (0, never)\n"
+			"  -X <cmds>    restart the FTL over its NAND after every <cmds> synthetic commands and check its map (0, never)\n"
+			"  -b <blocks>  4 KiB blocks per command (1)\n"
+			"  -q <depth>   queue depth (32)\n"
+			"  -n <cmds>    number of commands or trace records (100000, all records of a trace)\n"
+			"  -s <MiB>     LBA span (whole capacity)\n"
+			"  -p           fill the span sequentially before measuring\n"
+			"  -x <seed>    random seed\n"
+			"  -g <policy>  GC policy: original, game, cb, cbgame or 0-3 (cb)\n"
+			"  -c           program GC copies to the least-loaded die\n"
+			"  -B <policy>  data buffer replacement policy: lru, arc or 0-1 (lru)\n"
+			"  -R <us>      tR    -P <us> tPROG    -E <us> tBERS\n"
+			"  -C <ns>      channel ns per KiB    -H <ns> PCIe ns per 4 KiB\n"
+			"  -v           show firmware console output\n", prog);
+	exit(1);
+}
+
+static unsigned int ParseGcPolicy(const char* name, const char* prog)
+{
+	unsigned int policyNo;
+
+	for(policyNo = 0; policyNo < GC_POLICY_COUNT; policyNo++)
+		if(!strcasecmp(name, gcPolicyTable[policyNo].name))
+			return policyNo;
+
+	if((name[0] >= '0') && (name[0] < '0' + GC_POLICY_COUNT) && !name[1])
+		return name[0] - '0';
+
+	Usage(prog);
+	return GC_POLICY_DEFAULT;
+}
+
+static unsigned int ParseBufPolicy(const char* name, const char* prog)
+{
+	unsigned int policyNo;
+
+	for(policyNo = 0; policyNo < DATA_BUF_POLICY_COUNT; policyNo++)
+		if(!strcasecmp(name, dataBufPolicyName[policyNo]))
+			return policyNo;
+
+	if((name[0] >= '0') && (name[0] < '0' + DATA_BUF_POLICY_COUNT) && !name[1])
+		return name[0] - '0';
+
+	Usage(prog);
+	return DATA_BUF_POLICY_DEFAULT;
+}
+
+static SIM_WORKLOAD ParseWorkload(const char* name, const char* prog)
+{
+	if(!strcmp(name, "seqwrite"))
+		return SIM_WL_SEQ_WRITE;
+	if(!strcmp(name, "randwrite"))
+		return SIM_WL_RAND_WRITE;
+	if(!strcmp(name, "seqread"))
+		return SIM_WL_SEQ_READ;
+	if(!strcmp(name, "randread"))
+		return SIM_WL_RAND_READ;
+	if(!strcmp(name, "mixed"))
+		return SIM_WL_MIXED;
+
+	Usage(prog);
+	return SIM_WL_RAND_WRITE;
+}
+
+int main(int argc, char** argv)
+{
+	SIM_NAND_STAT before;
+	SIM_TIME start, dieBusyBefore[USER_DIES], chBusyBefore[USER_CHANNELS];
+	unsigned int slot, spanMB, copyCntBefore, cmdCntGiven;
+	unsigned long long recordCnt;
+	int opt;
+
+	spanMB = 0;
+	cmdCntGiven = 0;
+	while((opt = getopt(argc, argv, "w:t:aS:r:d:k:l:u:f:X:b:q:n:s:px:g:cB:R:P:E:C:H:v")) != -1)
+	{
+		switch(opt)
+		{
+		case 'w': workload = ParseWorkload(optarg, argv[0]); break;
+		case 't': tracePath = optarg; break;
+		case 'a': traceAsFast = 1; break;
+		case 'S': traceSpeedup = atof(optarg); break;
+		case 'r': readPercent = atoi(optarg); break;
+		case 'd': trimPercent = atoi(optarg); break;
+		case 'k': hotPercent = (atoi(optarg) < 100) ? atoi(optarg) : 0; break;
+		case 'l': scanPercent = atoi(optarg); break;
+		case 'u': fuaPercent = atoi(optarg); break;
+		case 'f': flushInterval = atoi(optarg); break;
+		case 'X': restartInterval = atoi(optarg); break;
+		case 'b': blocksPerCmd = atoi(optarg); break;
+		case 'q': queueDepth = atoi(optarg); break;
+		case 'n': cmdCnt = strtoull(optarg, NULL, 0); cmdCntGiven = 1; break;
+		case 's': spanMB = atoi(optarg); break;
+		case 'p': precondition = 1; break;
+		case 'x': rngState = strtoull(optarg, NULL, 0) | 1; break;
+		case 'g': gcPolicyNo = ParseGcPolicy(optarg, argv[0]); break;
+		case 'c': gcCrossDie = 1; break;
+		case 'B': bufPolicyNo = ParseBufPolicy(optarg, argv[0]); break;
+		case 'R': simTiming.tR = strtoull(optarg, NULL, 0) * SIM_NS_PER_US; break;
+		case 'P': simTiming.tPROG = strtoull(optarg, NULL, 0) * SIM_NS_PER_US; break;
+		case 'E': simTiming.tBERS = strtoull(optarg, NULL, 0) * SIM_NS_PER_US; break;
+		case 'C': simTiming.nsPerKB = strtoull(optarg, NULL, 0); break;
+		case 'H': simTiming.pcieNsPer4KB = strtoull(optarg, NULL, 0); break;
+		case 'v': simVerbose = 1; break;
+		default: Usage(argv[0]);
+		}
+	}
+
+	if(!blocksPerCmd || (blocksPerCmd > SIM_MAX_BLOCKS_PER_CMD) || !queueDepth || (queueDepth > SIM_MAX_CMD_SLOTS) || (traceSpeedup <= 0))
+		Usage(argv[0]);
+
+	if(tracePath && !SimOpenTrace(tracePath))
+	{
+		fprintf(stderr, "[sim] cannot open trace %s\n", tracePath);
+		return 1;
+	}
+
+	SimInitDram();
+	SimInitClock();
+	SimInitNand();
+	SimInitHost(CmdDone);
+
+	for(slot = 0; slot < SIM_MAX_CMD_SLOTS; slot++)
+		freeSlot[freeSlotCnt++] = SIM_MAX_CMD_SLOTS - 1 - slot;
+
+	if(restartInterval)
+	{
+		restartSliceMap = malloc(SLICES_PER_SSD * sizeof(unsigned int));
+		restartSliceOwner = malloc(SLICES_PER_SSD * sizeof(unsigned int));
+		if((restartSliceMap == NULL) || (restartSliceOwner == NULL))
+		{
+			fprintf(stderr, "[sim] out of memory for the logical slice map of a restart\n");
+			return 1;
+		}
+	}
+
+	InitFTL();
+	ConfigureFtl();
+	printf("[sim] FTL reset took %.3f ms of simulated time, capacity %u MiB\n",
+			(double)simNow / SIM_NS_PER_MS, storageCapacity_L / 256);
+
+	spanBlocks = storageCapacity_L;
+	if(spanMB && (spanMB * 256 < storageCapacity_L))
+		spanBlocks = spanMB * 256;
+	if(spanBlocks < blocksPerCmd)
+		Usage(argv[0]);
+
+	if(precondition)
+	{
+		RunWorkload(SIM_WL_SEQ_WRITE, spanBlocks / blocksPerCmd, 0);
+		printf("[sim] preconditioned %u MiB at %.3f ms\n", spanBlocks / 256, (double)simNow / SIM_NS_PER_MS);
+	}
+
+	ResetHostStat();
+	SimGetNandStat(&before);
+	SnapshotBusyTime(dieBusyBefore, chBusyBefore);
+	copyCntBefore = copyCnt;
+	start = simNow;
+
+	if(tracePath)
+	{
+		recordCnt = ReplayTrace(cmdCntGiven ? cmdCnt : ~0ULL);
+		SimCloseTrace();
+		printf("[sim] replayed %llu trace records from %s\n", recordCnt, tracePath);
+	}
+	else
+		RunWorkload(workload, cmdCnt, 1);
+
+	PrintReport(simNow - start, &before, dieBusyBefore, chBusyBefore, copyCntBefore);
+
+	return 0;
+}
@@ -0,0 +1,88 @@
+//////////////////////////////////////////////////////////////////////////////////
+// sim_memory.c for Cosmos+ OpenSSD
+//
+// This file is part of Cosmos+ OpenSSD.
+//
+// Cosmos+ OpenSSD is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3, or (at your option)
+// any later version.
+//
+// Cosmos+ OpenSSD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Cosmos+ OpenSSD; see the file COPYING.
+// If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Project Name: Cosmos+ OpenSSD
+// Design Name: Cosmos+ Firmware (host simulator)
+// Module Name: DRAM Arena
+// File Name: sim_memory.c
+//
+// Version: v1.0.1
+//
+// Description:
+//   - back the fixed DRAM regions of memory_map.h with an anonymous arena
+//     so that the FTL keeps using its integer addresses unchanged
+//   - clear the arena when the firmware is restarted
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Revision History:
+//
+// * v1.0.1
+//   - SimResetDram clears the DRAM window as a power cycle does
+//
+// * v1.0.0
+//   - First draft
+//////////////////////////////////////////////////////////////////////////////////
+
+#define _GNU_SOURCE
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include "sim.h"
+#include "../memory_map.h"
+
+#ifndef MAP_FIXED_NOREPLACE
+#define MAP_FIXED_NOREPLACE 0x100000
+#endif
+
+void SimInitDram()
+{
+	void* arena;
+	size_t arenaSize;
+
+	if(FTL_MANAGEMENT_END_ADDR > DRAM_END_ADDR)
+		assert(!"[WARNING] Configuration Error: Metadata of FTL is too large to be allocated to DRAM [WARNING]");
+
+	//pages are committed lazily, so reserving the whole 1 GiB DRAM window is cheap
+	arenaSize = (size_t)DRAM_END_ADDR + 1 - DRAM_START_ADDR;
+	arena = mmap((void*)DRAM_START_ADDR, arenaSize, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED_NOREPLACE, -1, 0);
+
+	if(arena != (void*)DRAM_START_ADDR)
+	{
+		fprintf(stderr, "[sim] cannot map DRAM window at 0x%08X (build as PIE so the low 1 GiB is free)\n", DRAM_START_ADDR);
+		exit(1);
+	}
+}
+
+//the pages of the window are dropped and read back as zeros
+void SimResetDram()
+{
+	size_t arenaSize;
+
+	arenaSize = (size_t)DRAM_END_ADDR + 1 - DRAM_START_ADDR;
+	if(madvise((void*)DRAM_START_ADDR, arenaSize, MADV_DONTNEED))
+	{
+		fprintf(stderr, "[sim] cannot clear the DRAM window\n");
+		exit(1);
+	}
+}
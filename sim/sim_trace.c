@@ -0,0 +1,250 @@
+//////////////////////////////////////////////////////////////////////////////////
+// sim_trace.c for Cosmos+ OpenSSD
+//
+// This file is part of Cosmos+ OpenSSD.
+//
+// Cosmos+ OpenSSD is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3, or (at your option)
+// any later version.
+//
+// Cosmos+ OpenSSD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Cosmos+ OpenSSD; see the file COPYING.
+// If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Project Name: Cosmos+ OpenSSD
+// Design Name: Cosmos+ Firmware (host simulator)
+// Module Name: Trace Reader
+// File Name: sim_trace.c
+//
+// Version: v1.0.0
+//
+// Description:
+//   - read block traces for replay; three text formats are detected
+//     * blkparse default output
+//         "8,0 3 1 0.000000000 697 Q WS 223490 + 8 [proc]"
+//     * fio iolog version 2/3 ("fio version N iolog" header, byte offsets,
+//       v3 lines start with a millisecond timestamp)
+//     * plain "<time_us> <R|W|F|D> <sector> <sectors>" lines, '#' comments
+//   - sectors are 512 bytes and are rounded out to 4 KiB NVMe blocks
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Revision History:
+//
+// * v1.0.0
+//   - First draft
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+
+#define SIM_TRACE_FORMAT_UNKNOWN	0
+#define SIM_TRACE_FORMAT_PLAIN		1
+#define SIM_TRACE_FORMAT_BLKPARSE	2
+#define SIM_TRACE_FORMAT_FIO_V2		3
+#define SIM_TRACE_FORMAT_FIO_V3		4
+
+static FILE* traceFile;
+static unsigned int traceFormat;
+static char blkparseAction;
+static int traceTimeValid;
+static SIM_TIME traceTimeBase;
+
+int SimOpenTrace(const char* path)
+{
+	traceFile = fopen(path, "r");
+	if(traceFile == NULL)
+		return 0;
+
+	traceFormat = SIM_TRACE_FORMAT_UNKNOWN;
+	blkparseAction = 0;
+	traceTimeValid = 0;
+	traceTimeBase = 0;
+
+	return 1;
+}
+
+void SimCloseTrace()
+{
+	if(traceFile)
+		fclose(traceFile);
+	traceFile = NULL;
+}
+
+static int ParseOp(const char* op, unsigned int* traceOp)
+{
+	if(!strcasecmp(op, "r") || !strcasecmp(op, "read"))
+		*traceOp = SIM_TRACE_OP_READ;
+	else if(!strcasecmp(op, "w") || !strcasecmp(op, "write"))
+		*traceOp = SIM_TRACE_OP_WRITE;
+	else if(!strcasecmp(op, "f") || !strcasecmp(op, "flush") || !strcasecmp(op, "sync") || !strcasecmp(op, "datasync"))
+		*traceOp = SIM_TRACE_OP_FLUSH;
+	else if(!strcasecmp(op, "d") || !strcasecmp(op, "trim") || !strcasecmp(op, "discard"))
+		*traceOp = SIM_TRACE_OP_TRIM;
+	else
+		return 0;
+
+	return 1;
+}
+
+//blkparse RWBS field: F flush, D discard, R read, W write
+static int ParseRwbs(const char* rwbs, unsigned int sectors, unsigned int* traceOp)
+{
+	if(strchr(rwbs, 'D'))
+		*traceOp = SIM_TRACE_OP_TRIM;
+	else if(strchr(rwbs, 'R'))
+		*traceOp = SIM_TRACE_OP_READ;
+	else if(strchr(rwbs, 'W') && sectors)
+		*traceOp = SIM_TRACE_OP_WRITE;
+	else if(strchr(rwbs, 'F'))
+		*traceOp = SIM_TRACE_OP_FLUSH;
+	else
+		return 0;
+
+	return 1;
+}
+
+static void DetectFormat(const char* line)
+{
+	char field[32];
+	double time;
+	unsigned long long sector;
+	unsigned int sectors;
+
+	if(strstr(line, "fio version 2 iolog"))
+		traceFormat = SIM_TRACE_FORMAT_FIO_V2;
+	else if(strstr(line, "fio version 3 iolog"))
+		traceFormat = SIM_TRACE_FORMAT_FIO_V3;
+	else if(sscanf(line, "%*s %*s %*s %lf %*s %*s %31s %llu + %u", &time, field, &sector, &sectors) == 4)
+		traceFormat = SIM_TRACE_FORMAT_BLKPARSE;
+	else
+		traceFormat = SIM_TRACE_FORMAT_PLAIN;
+}
+
+static int ParseLine(const char* line, double* timeNs, unsigned int* traceOp, unsigned long long* offsetBytes, unsigned long long* lengthBytes)
+{
+	char field0[64], field1[64], field2[64];
+	double time;
+	unsigned long long offset, length;
+	unsigned int sectors;
+
+	switch(traceFormat)
+	{
+	case SIM_TRACE_FORMAT_BLKPARSE:
+		if(sscanf(line, "%*s %*s %*s %lf %*s %63s %63s %llu + %u", &time, field0, field1, &offset, &sectors) != 5)
+			return 0;
+		//replay each request once, at the first of queue (Q) or dispatch (D) events seen
+		if(strcmp(field0, "Q") && strcmp(field0, "D"))
+			return 0;
+		if(!blkparseAction)
+			blkparseAction = field0[0];
+		if(field0[0] != blkparseAction)
+			return 0;
+		if(!ParseRwbs(field1, sectors, traceOp))
+			return 0;
+
+		*timeNs = time * SIM_NS_PER_SEC;
+		*offsetBytes = offset * 512;
+		*lengthBytes = (unsigned long long)sectors * 512;
+		return 1;
+
+	case SIM_TRACE_FORMAT_FIO_V2:
+		if(sscanf(line, "%63s %63s %llu %llu", field0, field1, &offset, &length) != 4)
+			return 0;
+		if(!ParseOp(field1, traceOp))
+			return 0;
+
+		*timeNs = -1;
+		*offsetBytes = offset;
+		*lengthBytes = length;
+		return 1;
+
+	case SIM_TRACE_FORMAT_FIO_V3:
+		if(sscanf(line, "%lf %63s %63s %llu %llu", &time, field0, field1, &offset, &length) != 5)
+			return 0;
+		if(!ParseOp(field1, traceOp))
+			return 0;
+
+		*timeNs = time * SIM_NS_PER_MS;
+		*offsetBytes = offset;
+		*lengthBytes = length;
+		return 1;
+
+	default:
+		if(sscanf(line, "%lf %63s %llu %llu", &time, field2, &offset, &length) != 4)
+			return 0;
+		if(!ParseOp(field2, traceOp))
+			return 0;
+
+		*timeNs = time * SIM_NS_PER_US;
+		*offsetBytes = offset * 512;
+		*lengthBytes = length * 512;
+		return 1;
+	}
+}
+
+//returns 0 at the end of the trace; unknown lines are skipped
+int SimReadTrace(P_SIM_TRACE_RECORD record)
+{
+	char line[512];
+	double timeNs;
+	unsigned long long offset, length, endLba;
+	unsigned int traceOp;
+
+	while(fgets(line, sizeof(line), traceFile))
+	{
+		if((line[0] == '#') || (line[0] == '\n'))
+			continue;
+
+		if(traceFormat == SIM_TRACE_FORMAT_UNKNOWN)
+		{
+			DetectFormat(line);
+			if((traceFormat == SIM_TRACE_FORMAT_FIO_V2) || (traceFormat == SIM_TRACE_FORMAT_FIO_V3))
+				continue;
+		}
+
+		if(!ParseLine(line, &timeNs, &traceOp, &offset, &length))
+			continue;
+		if((traceOp != SIM_TRACE_OP_FLUSH) && !length)
+			continue;
+
+		if(timeNs < 0)
+			record->time = 0;
+		else
+		{
+			if(!traceTimeValid)
+			{
+				traceTimeBase = (SIM_TIME)timeNs;
+				traceTimeValid = 1;
+			}
+			record->time = ((SIM_TIME)timeNs > traceTimeBase) ? (SIM_TIME)timeNs - traceTimeBase : 0;
+		}
+
+		record->op = traceOp;
+		if(traceOp == SIM_TRACE_OP_FLUSH)
+		{
+			record->startLba = 0;
+			record->nlb = 0;
+		}
+		else
+		{
+			endLba = (offset + length + BYTES_PER_NVME_BLOCK - 1) / BYTES_PER_NVME_BLOCK;
+			record->startLba = offset / BYTES_PER_NVME_BLOCK;
+			record->nlb = (unsigned int)(endLba - record->startLba);
+		}
+
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,211 @@
+//////////////////////////////////////////////////////////////////////////////////
+// wear_leveling.c for Cosmos+ OpenSSD
+//
+// This file is part of Cosmos+ OpenSSD.
+//
+// Cosmos+ OpenSSD is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3, or (at your option)
+// any later version.
+//
+// Cosmos+ OpenSSD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Cosmos+ OpenSSD; see the file COPYING.
+// If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Project Name: Cosmos+ OpenSSD
+// Design Name: Cosmos+ Firmware
+// Module Name: Wear Leveler
+// File Name: wear_leveling.c
+//
+// Version: v1.0.0
+//
+// Description:
+//   - hand out the least worn erased free block of a die or of a plane (dynamic wear leveling)
+//   - pick a block of cold data as GC victim when the erase counts of a die spread too far (static wear leveling)
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Revision History:
+//
+// * v1.0.0
+//   - First draft
+//////////////////////////////////////////////////////////////////////////////////
+
+
+#include "xil_printf.h"
+#include <assert.h>
+#include "memory_map.h"
+
+P_WEAR_LEVELING_MAP wearLevelingMapPtr;
+
+void InitWearLeveling()
+{
+	unsigned int dieNo;
+
+	wearLevelingMapPtr = (P_WEAR_LEVELING_MAP) WEAR_LEVELING_MAP_ADDR;
+
+	for(dieNo = 0; dieNo < USER_DIES; dieNo++)
+	{
+		ResetFreeBlockHeap(dieNo);
+		wearLevelingMapPtr->die[dieNo].erasedBlockCnt = 0;
+		wearLevelingMapPtr->die[dieNo].minEraseCnt = 0;
+		wearLevelingMapPtr->die[dieNo].maxEraseCnt = 0;
+	}
+
+	wearLevelingMapPtr->migratedBlockCnt = 0;
+}
+
+void ResetFreeBlockHeap(unsigned int dieNo)
+{
+	unsigned int planeNo;
+
+	for(planeNo = 0; planeNo < PLANES_PER_DIE; planeNo++)
+		wearLevelingMapPtr->die[dieNo].heapBlockCnt[planeNo] = 0;
+}
+
+static unsigned int HeapEraseCnt(unsigned int dieNo, unsigned int blockNo)
+{
+	return virtualBlockMapPtr->block[dieNo][blockNo].eraseCnt;
+}
+
+//the erase count of a free block does not change until it is taken, so heap entries keep their order
+void PushFreeBlockHeap(unsigned int dieNo, unsigned int blockNo)
+{
+	unsigned short* heap;
+	unsigned int planeNo, index, parent, eraseCnt;
+
+	planeNo = Vblock2PplaneTranslation(dieNo, blockNo);
+	heap = wearLevelingMapPtr->die[dieNo].freeBlockHeap[planeNo];
+	eraseCnt = HeapEraseCnt(dieNo, blockNo);
+
+	index = wearLevelingMapPtr->die[dieNo].heapBlockCnt[planeNo]++;
+	while(index > 0)
+	{
+		parent = (index - 1) / 2;
+		if(HeapEraseCnt(dieNo, heap[parent]) <= eraseCnt)
+			break;
+
+		heap[index] = heap[parent];
+		index = parent;
+	}
+	heap[index] = blockNo;
+}
+
+//BLOCK_NONE when the plane has no erased free block
+unsigned int PopFreeBlockHeap(unsigned int dieNo, unsigned int planeNo)
+{
+	unsigned short* heap;
+	unsigned int blockNo, lastBlockNo, blockCnt, index, child, eraseCnt;
+
+	heap = wearLevelingMapPtr->die[dieNo].freeBlockHeap[planeNo];
+	blockCnt = wearLevelingMapPtr->die[dieNo].heapBlockCnt[planeNo];
+	if(blockCnt == 0)
+		return BLOCK_NONE;
+
+	blockNo = heap[0];
+	blockCnt--;
+	wearLevelingMapPtr->die[dieNo].heapBlockCnt[planeNo] = blockCnt;
+
+	lastBlockNo = heap[blockCnt];
+	eraseCnt = HeapEraseCnt(dieNo, lastBlockNo);
+	index = 0;
+	while((child = 2 * index + 1) < blockCnt)
+	{
+		if((child + 1 < blockCnt) && (HeapEraseCnt(dieNo, heap[child + 1]) < HeapEraseCnt(dieNo, heap[child])))
+			child++;
+		if(eraseCnt <= HeapEraseCnt(dieNo, heap[child]))
+			break;
+
+		heap[index] = heap[child];
+		index = child;
+	}
+	heap[index] = lastBlockNo;
+
+	return blockNo;
+}
+
+unsigned int PopLeastWornFreeBlock(unsigned int dieNo)
+{
+	unsigned int planeNo, leastWornPlaneNo;
+	P_WEAR_LEVELING_DIE_ENTRY wlDie;
+
+	wlDie = &wearLevelingMapPtr->die[dieNo];
+	leastWornPlaneNo = PLANES_PER_DIE;
+	for(planeNo = 0; planeNo < PLANES_PER_DIE; planeNo++)
+		if(wlDie->heapBlockCnt[planeNo] && ((leastWornPlaneNo == PLANES_PER_DIE) ||
+				(HeapEraseCnt(dieNo, wlDie->freeBlockHeap[planeNo][0]) < HeapEraseCnt(dieNo, wlDie->freeBlockHeap[leastWornPlaneNo][0]))))
+			leastWornPlaneNo = planeNo;
+
+	if(leastWornPlaneNo == PLANES_PER_DIE)
+		return BLOCK_NONE;
+
+	return PopFreeBlockHeap(dieNo, leastWornPlaneNo);
+}
+
+static unsigned int IsOpenBlock(unsigned int dieNo, unsigned int blockNo)
+{
+	unsigned int writeStream;
+
+	for(writeStream = 0; writeStream < WRITE_STREAM_COUNT; writeStream++)
+		if((virtualDieMapPtr->die[dieNo].currentBlock[writeStream] == blockNo) || (virtualDieMapPtr->die[dieNo].planeBlock[writeStream] == blockNo))
+			return 1;
+
+	return 0;
+}
+
+//called by GC before its policy picks a victim, every WL_CHECK_INTERVAL erases of the die the least worn block holding data
+//is searched for and taken as victim if the die's erase counts spread over WL_ERASE_SPREAD_THRESHOLD,
+//its valid slices go through the GC copy path and the block returns to the free block heap to take hot data
+unsigned int SelectWearLevelingVictim(unsigned int dieNo)
+{
+	unsigned int blockNo, eraseCnt, minEraseCnt, maxEraseCnt, coldBlockNo;
+	P_WEAR_LEVELING_DIE_ENTRY wlDie;
+
+	wlDie = &wearLevelingMapPtr->die[dieNo];
+	if(wlDie->erasedBlockCnt < WL_CHECK_INTERVAL)
+		return BLOCK_NONE;
+
+	wlDie->erasedBlockCnt = 0;
+
+	coldBlockNo = BLOCK_NONE;
+	minEraseCnt = 0xffff;
+	maxEraseCnt = 0;
+	for(blockNo = 0; blockNo < USER_BLOCKS_PER_DIE; blockNo++)
+	{
+		if(virtualBlockMapPtr->block[dieNo][blockNo].bad)
+			continue;
+
+		eraseCnt = virtualBlockMapPtr->block[dieNo][blockNo].eraseCnt;
+		if(eraseCnt > maxEraseCnt)
+			maxEraseCnt = eraseCnt;
+
+		//free blocks are handed out least worn first anyway
+		if(virtualBlockMapPtr->block[dieNo][blockNo].free || IsOpenBlock(dieNo, blockNo))
+			continue;
+
+		if(eraseCnt < minEraseCnt)
+		{
+			minEraseCnt = eraseCnt;
+			coldBlockNo = blockNo;
+		}
+	}
+
+	wlDie->minEraseCnt = (coldBlockNo != BLOCK_NONE) ? minEraseCnt : maxEraseCnt;
+	wlDie->maxEraseCnt = maxEraseCnt;
+
+	if((coldBlockNo == BLOCK_NONE) || (maxEraseCnt - minEraseCnt <= WL_ERASE_SPREAD_THRESHOLD))
+		return BLOCK_NONE;
+
+	SelectiveGetFromGcVictimList(dieNo, coldBlockNo);
+	wearLevelingMapPtr->migratedBlockCnt++;
+	xil_printf("[WL] Die %d migrates block %d (erase count %d, max %d)\r\n", dieNo, coldBlockNo, minEraseCnt, maxEraseCnt);
+
+	return coldBlockNo;
+}
@@ -0,0 +1,71 @@
+//////////////////////////////////////////////////////////////////////////////////
+// wear_leveling.h for Cosmos+ OpenSSD
+//
+// This file is part of Cosmos+ OpenSSD.
+//
+// Cosmos+ OpenSSD is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3, or (at your option)
+// any later version.
+//
+// Cosmos+ OpenSSD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Cosmos+ OpenSSD; see the file COPYING.
+// If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Project Name: Cosmos+ OpenSSD
+// Design Name: Cosmos+ Firmware
+// Module Name: Wear Leveler
+// File Name: wear_leveling.h
+//
+// Version: v1.0.0
+//
+// Description:
+//   - define parameters, data structure and functions of wear leveler
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Revision History:
+//
+// * v1.0.0
+//   - First draft
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef WEAR_LEVELING_H_
+#define WEAR_LEVELING_H_
+
+#include "address_translation.h"
+
+#define WL_ERASE_SPREAD_THRESHOLD	64	//erase count spread of a die above which cold data is migrated
+#define WL_CHECK_INTERVAL			64	//erases of a die between searches for a block of cold data
+
+//erased free blocks of each plane are kept in a min-heap on eraseCnt, so the least worn one is taken first
+typedef struct _WEAR_LEVELING_DIE_ENTRY {
+	unsigned short freeBlockHeap[PLANES_PER_DIE][USER_BLOCKS_PER_DIE];
+	unsigned short heapBlockCnt[PLANES_PER_DIE];
+	unsigned short erasedBlockCnt;		//since the last search for cold data
+	unsigned short minEraseCnt;			//of the last search
+	unsigned short maxEraseCnt;
+} WEAR_LEVELING_DIE_ENTRY, *P_WEAR_LEVELING_DIE_ENTRY;
+
+typedef struct _WEAR_LEVELING_MAP {
+	WEAR_LEVELING_DIE_ENTRY die[USER_DIES];
+	unsigned int migratedBlockCnt;		//blocks of cold data collected by static wear leveling
+} WEAR_LEVELING_MAP, *P_WEAR_LEVELING_MAP;
+
+void InitWearLeveling();
+void ResetFreeBlockHeap(unsigned int dieNo);
+void PushFreeBlockHeap(unsigned int dieNo, unsigned int blockNo);
+unsigned int PopFreeBlockHeap(unsigned int dieNo, unsigned int planeNo);
+unsigned int PopLeastWornFreeBlock(unsigned int dieNo);
+unsigned int SelectWearLevelingVictim(unsigned int dieNo);
+
+extern P_WEAR_LEVELING_MAP wearLevelingMapPtr;
+
+#endif /* WEAR_LEVELING_H_ */
@@ -0,0 +1,297 @@
+//////////////////////////////////////////////////////////////////////////////////
+// write_back.c for Cosmos+ OpenSSD
+//
+// This file is part of Cosmos+ OpenSSD.
+//
+// Cosmos+ OpenSSD is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3, or (at your option)
+// any later version.
+//
+// Cosmos+ OpenSSD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Cosmos+ OpenSSD; see the file COPYING.
+// If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Project Name: Cosmos+ OpenSSD
+// Design Name: Cosmos+ Firmware
+// Module Name: Write-Back Engine
+// File Name: write_back.c
+//
+// Version: v1.3.0
+//
+// Description:
+//   - write dirty data buffer entries back to NAND flash memory
+//   - complete flush commands and FUA writes when their programs are finished
+//   - clean the LRU tail in the background so that allocations rarely wait for a program
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Revision History:
+//
+// * v1.3.0
+//   - a program of an entry takes the next write sequence of the map checkpoint
+//   - all dirty entries are written back before a shutdown checkpoint (WriteBackAllDataBuf)
+//
+// * v1.2.0
+//   - evictions take the dirty run of slices following the evicted one along (WriteBackDataBufRun)
+//   - the background write-back leaves partially valid entries to be filled by the host
+//
+// * v1.1.2
+//   - partially valid entries are filled from NAND before their program
+//
+// * v1.1.1
+//   - dirty entries are looked up in the recency and frequency lists of the data buffer
+//
+// * v1.1.0
+//   - background write-back of the LRU tail with dirty entry watermarks
+//
+// * v1.0.0
+//   - First draft
+//////////////////////////////////////////////////////////////////////////////////
+
+
+#include "xil_printf.h"
+#include <assert.h>
+#include "memory_map.h"
+#include "nvme/host_lld.h"
+
+P_WRITE_BACK_MAP writeBackMapPtr;
+
+void InitWriteBack()
+{
+	unsigned int genNo, cmdSlotTag;
+
+	writeBackMapPtr = (P_WRITE_BACK_MAP)WRITE_BACK_MAP_ADDR;
+
+	for(genNo = 0; genNo < WRITE_BACK_GENERATION_COUNT; genNo++)
+	{
+		writeBackMapPtr->gen[genNo].pendingProgCnt = 0;
+		writeBackMapPtr->gen[genNo].flushCmdSlotTag = WRITE_BACK_CMD_SLOT_NONE;
+	}
+
+	for(cmdSlotTag = 0; cmdSlotTag < WRITE_BACK_CMD_SLOT_COUNT; cmdSlotTag++)
+		writeBackMapPtr->fuaPendingProgCnt[cmdSlotTag] = 0;
+
+	writeBackMapPtr->oldestGen = 0;
+	writeBackMapPtr->currentGen = 0;
+	writeBackMapPtr->draining = 0;
+}
+
+//program the entry to a new slice, the entry stays cached as a clean one
+void WriteBackDataBufEntry(unsigned int bufEntry, unsigned int cmdSlotTag, unsigned int forceUnitAccess)
+{
+	unsigned int reqSlotTag, virtualSliceAddr;
+
+	//the fill has to read the current NAND copy before the slice is remapped
+	if(dataBufMapPtr->dataBuf[bufEntry].blockValid != DATA_BUF_BLOCK_VALID_ALL)
+		FillDataBufEntry(bufEntry, cmdSlotTag);
+
+	reqSlotTag = GetFromFreeReqQ();
+	virtualSliceAddr =  AddrTransWrite(dataBufMapPtr->dataBuf[bufEntry].logicalSliceAddr);
+
+	reqPoolPtr->reqPool[reqSlotTag].reqType = REQ_TYPE_NAND;
+	reqPoolPtr->reqPool[reqSlotTag].reqCode = REQ_CODE_WRITE;
+	reqPoolPtr->reqPool[reqSlotTag].nvmeCmdSlotTag = cmdSlotTag;
+	reqPoolPtr->reqPool[reqSlotTag].logicalSliceAddr = dataBufMapPtr->dataBuf[bufEntry].logicalSliceAddr;
+	reqPoolPtr->reqPool[reqSlotTag].reqOpt.dataBufFormat = REQ_OPT_DATA_BUF_ENTRY;
+	reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandAddr = REQ_OPT_NAND_ADDR_VSA;
+	reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandEcc = REQ_OPT_NAND_ECC_ON;
+	reqPoolPtr->reqPool[reqSlotTag].reqOpt.nandEccWarning = REQ_OPT_NAND_ECC_WARNING_ON;
+	reqPoolPtr->reqPool[reqSlotTag].reqOpt.rowAddrDependencyCheck = REQ_OPT_ROW_ADDR_DEPENDENCY_CHECK;
+	reqPoolPtr->reqPool[reqSlotTag].reqOpt.blockSpace = REQ_OPT_BLOCK_SPACE_MAIN;
+	reqPoolPtr->reqPool[reqSlotTag].reqOpt.forceUnitAccess = forceUnitAccess;
+	reqPoolPtr->reqPool[reqSlotTag].reqOpt.writeBackGen = writeBackMapPtr->currentGen;
+	reqPoolPtr->reqPool[reqSlotTag].dataBufInfo.entry = bufEntry;
+	UpdateDataBufEntryInfoBlockingReq(bufEntry, reqSlotTag);
+	reqPoolPtr->reqPool[reqSlotTag].nandInfo.virtualSliceAddr = virtualSliceAddr;
+	reqPoolPtr->reqPool[reqSlotTag].nandInfo.writeSeq = checkpointMapPtr->sliceWriteSeq++;
+
+	writeBackMapPtr->gen[writeBackMapPtr->currentGen].pendingProgCnt++;
+
+	SelectLowLevelReqQ(reqSlotTag);
+
+	if(dataBufMapPtr->dataBuf[bufEntry].dirty == DATA_BUF_DIRTY)
+		dirtyDataBufCnt--;
+	dataBufMapPtr->dataBuf[bufEntry].dirty = DATA_BUF_CLEAN;
+}
+
+//an evicted slice takes the complete dirty slices of the next WRITE_BACK_COALESCE_DEPTH addresses along
+//when they are among the entries to be replaced soon anyway, so that a sequential run goes out as back-to-back programs
+void WriteBackDataBufRun(unsigned int bufEntry, unsigned int cmdSlotTag)
+{
+	unsigned int logicalSliceAddr, scanCnt, listNo;
+
+	logicalSliceAddr = dataBufMapPtr->dataBuf[bufEntry].logicalSliceAddr;
+	listNo = dataBufMapPtr->dataBuf[bufEntry].list;
+	WriteBackDataBufEntry(bufEntry, cmdSlotTag, REQ_OPT_FORCE_UNIT_ACCESS_OFF);
+
+	bufEntry = dataBufLruList[listNo].tailEntry;
+	for(scanCnt = 0; (bufEntry != DATA_BUF_NONE) && (scanCnt < WRITE_BACK_COALESCE_SCAN_DEPTH); scanCnt++)
+	{
+		if((dataBufMapPtr->dataBuf[bufEntry].logicalSliceAddr - logicalSliceAddr - 1 < WRITE_BACK_COALESCE_DEPTH)
+				&& (dataBufMapPtr->dataBuf[bufEntry].dirty == DATA_BUF_DIRTY) && (dataBufMapPtr->dataBuf[bufEntry].blockingReqTail == REQ_SLOT_TAG_NONE)
+				&& (dataBufMapPtr->dataBuf[bufEntry].blockValid == DATA_BUF_BLOCK_VALID_ALL))
+			WriteBackDataBufEntry(bufEntry, WRITE_BACK_CMD_SLOT_NONE, REQ_OPT_FORCE_UNIT_ACCESS_OFF);
+
+		bufEntry = dataBufMapPtr->dataBuf[bufEntry].prevEntry;
+	}
+}
+
+static void RetireWriteBackGen()
+{
+	while((writeBackMapPtr->oldestGen != writeBackMapPtr->currentGen) && (writeBackMapPtr->gen[writeBackMapPtr->oldestGen].pendingProgCnt == 0))
+	{
+		set_auto_nvme_cpl(writeBackMapPtr->gen[writeBackMapPtr->oldestGen].flushCmdSlotTag, 0, 0);
+
+		writeBackMapPtr->gen[writeBackMapPtr->oldestGen].flushCmdSlotTag = WRITE_BACK_CMD_SLOT_NONE;
+		writeBackMapPtr->oldestGen = (writeBackMapPtr->oldestGen + 1) % WRITE_BACK_GENERATION_COUNT;
+	}
+}
+
+//called when a program of a data buffer entry is finished
+void WriteBackDone(unsigned int reqSlotTag)
+{
+	unsigned int genNo, cmdSlotTag;
+
+	genNo = reqPoolPtr->reqPool[reqSlotTag].reqOpt.writeBackGen;
+	writeBackMapPtr->gen[genNo].pendingProgCnt--;
+
+	if(reqPoolPtr->reqPool[reqSlotTag].reqOpt.forceUnitAccess == REQ_OPT_FORCE_UNIT_ACCESS_ON)
+	{
+		cmdSlotTag = reqPoolPtr->reqPool[reqSlotTag].nvmeCmdSlotTag;
+		writeBackMapPtr->fuaPendingProgCnt[cmdSlotTag]--;
+		if(writeBackMapPtr->fuaPendingProgCnt[cmdSlotTag] == 0)
+			set_auto_nvme_cpl(cmdSlotTag, 0, 0);
+	}
+
+	if(genNo == writeBackMapPtr->oldestGen)
+		RetireWriteBackGen();
+}
+
+//programs of all dies are queued before waiting, the command completes in RetireWriteBackGen
+void FlushDataBuf(unsigned int cmdSlotTag)
+{
+	unsigned int bufEntry, nextGen, listNo;
+
+	nextGen = (writeBackMapPtr->currentGen + 1) % WRITE_BACK_GENERATION_COUNT;
+	while(nextGen == writeBackMapPtr->oldestGen)
+	{
+		CheckDoneNvmeDmaReq();
+		SchedulingNandReq();
+	}
+
+	for(listNo = 0; listNo < DATA_BUF_LIST_COUNT; listNo++)
+	{
+		bufEntry = dataBufLruList[listNo].tailEntry;
+		while(bufEntry != DATA_BUF_NONE)
+		{
+			if(dataBufMapPtr->dataBuf[bufEntry].dirty == DATA_BUF_DIRTY)
+				WriteBackDataBufEntry(bufEntry, cmdSlotTag, REQ_OPT_FORCE_UNIT_ACCESS_OFF);
+
+			bufEntry = dataBufMapPtr->dataBuf[bufEntry].prevEntry;
+		}
+	}
+
+	writeBackMapPtr->gen[writeBackMapPtr->currentGen].flushCmdSlotTag = cmdSlotTag;
+	writeBackMapPtr->currentGen = nextGen;
+
+	RetireWriteBackGen();
+}
+
+//no command waits for these programs, they are done when the function returns
+void WriteBackAllDataBuf()
+{
+	unsigned int bufEntry, listNo;
+
+	for(listNo = 0; listNo < DATA_BUF_LIST_COUNT; listNo++)
+	{
+		bufEntry = dataBufLruList[listNo].tailEntry;
+		while(bufEntry != DATA_BUF_NONE)
+		{
+			if(dataBufMapPtr->dataBuf[bufEntry].dirty == DATA_BUF_DIRTY)
+				WriteBackDataBufEntry(bufEntry, WRITE_BACK_CMD_SLOT_NONE, REQ_OPT_FORCE_UNIT_ACCESS_OFF);
+
+			bufEntry = dataBufMapPtr->dataBuf[bufEntry].prevEntry;
+		}
+	}
+
+	SyncAllLowLevelReqDone();
+}
+
+//a FUA write completes when all of its slices are programmed instead of at the end of its DMAs
+void StartFuaWrite(unsigned int cmdSlotTag, unsigned int startLba, unsigned int nlb)
+{
+	writeBackMapPtr->fuaPendingProgCnt[cmdSlotTag] = (startLba + nlb) / NVME_BLOCKS_PER_SLICE - startLba / NVME_BLOCKS_PER_SLICE + 1;
+}
+
+unsigned int CheckFuaWrite(unsigned int cmdSlotTag)
+{
+	return (writeBackMapPtr->fuaPendingProgCnt[cmdSlotTag] != 0);
+}
+
+//oldest dirty entry without a request in flight among the next scanDepth entries to be replaced,
+//the list the replacement policy takes from next is scanned first
+static unsigned int FindWriteBackCandidate(unsigned int scanDepth)
+{
+	unsigned int bufEntry, scanCnt, listNo, listCnt;
+
+	scanCnt = 0;
+	listNo = GetDataBufVictimList();
+	for(listCnt = 0; listCnt < DATA_BUF_LIST_COUNT; listCnt++)
+	{
+		bufEntry = dataBufLruList[listNo].tailEntry;
+		for(; (bufEntry != DATA_BUF_NONE) && (scanCnt < scanDepth); scanCnt++)
+		{
+			if((dataBufMapPtr->dataBuf[bufEntry].dirty == DATA_BUF_DIRTY) && (dataBufMapPtr->dataBuf[bufEntry].blockingReqTail == REQ_SLOT_TAG_NONE)
+					&& (dataBufMapPtr->dataBuf[bufEntry].blockValid == DATA_BUF_BLOCK_VALID_ALL))
+				return bufEntry;
+
+			bufEntry = dataBufMapPtr->dataBuf[bufEntry].prevEntry;
+		}
+
+		listNo = (listNo + 1) % DATA_BUF_LIST_COUNT;
+	}
+
+	return DATA_BUF_NONE;
+}
+
+//called from the idle loop, writes back at most one entry per die
+//entries go out while the die of the next slice allocation is idle, or while it is lightly loaded
+//from the high watermark of dirty entries down to the low one
+void WriteBackScheduler()
+{
+	unsigned int bufEntry, dieNo, loop, scanDepth, queuedReqCnt;
+
+	for(loop = 0; loop < USER_DIES; loop++)
+	{
+		if(dirtyDataBufCnt >= WRITE_BACK_HIGH_WATERMARK)
+			writeBackMapPtr->draining = 1;
+		else if(dirtyDataBufCnt <= WRITE_BACK_LOW_WATERMARK)
+			writeBackMapPtr->draining = 0;
+
+		if(freeReqQ.headReq == REQ_SLOT_TAG_NONE)
+			return;
+
+		dieNo = sliceAllocationTargetDie;
+		queuedReqCnt = nandReqQ[Vdie2PchTranslation(dieNo)][Vdie2PwayTranslation(dieNo)].reqCnt;
+		if(writeBackMapPtr->draining && (queuedReqCnt < WRITE_BACK_DRAIN_QUEUE_DEPTH))
+			scanDepth = AVAILABLE_DATA_BUFFER_ENTRY_COUNT;
+		else if(queuedReqCnt == 0)
+			scanDepth = WRITE_BACK_IDLE_SCAN_DEPTH;
+		else
+			return;
+
+		bufEntry = FindWriteBackCandidate(scanDepth);
+		if(bufEntry == DATA_BUF_NONE)
+			return;
+
+		WriteBackDataBufEntry(bufEntry, WRITE_BACK_CMD_SLOT_NONE, REQ_OPT_FORCE_UNIT_ACCESS_OFF);
+	}
+}
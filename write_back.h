@@ -0,0 +1,94 @@
+//////////////////////////////////////////////////////////////////////////////////
+// write_back.h for Cosmos+ OpenSSD
+//
+// This file is part of Cosmos+ OpenSSD.
+//
+// Cosmos+ OpenSSD is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3, or (at your option)
+// any later version.
+//
+// Cosmos+ OpenSSD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Cosmos+ OpenSSD; see the file COPYING.
+// If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Project Name: Cosmos+ OpenSSD
+// Design Name: Cosmos+ Firmware
+// Module Name: Write-Back Engine
+// File Name: write_back.h
+//
+// Version: v1.3.0
+//
+// Description:
+//   - define parameters, data structure and functions of write-back engine
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Revision History:
+//
+// * v1.3.0
+//   - all dirty entries are written back before a shutdown checkpoint (WriteBackAllDataBuf)
+//
+// * v1.2.0
+//   - an evicted entry is programmed together with the dirty run of slices following it
+//
+// * v1.1.0
+//   - background write-back of the LRU tail with dirty entry watermarks
+//
+// * v1.0.0
+//   - First draft
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef WRITE_BACK_H_
+#define WRITE_BACK_H_
+
+#include "data_buffer.h"
+#include "nvme/host_lld.h"
+
+#define WRITE_BACK_GENERATION_COUNT		8	//flush commands in flight + 1, must match REQ_OPTION.writeBackGen
+#define WRITE_BACK_CMD_SLOT_COUNT		(1 << P_SLOT_TAG_WIDTH)
+
+#define WRITE_BACK_CMD_SLOT_NONE		0xffff
+
+#define WRITE_BACK_HIGH_WATERMARK		(AVAILABLE_DATA_BUFFER_ENTRY_COUNT / 2)	//dirty entries that start draining
+#define WRITE_BACK_LOW_WATERMARK		(AVAILABLE_DATA_BUFFER_ENTRY_COUNT / 4)	//dirty entries that stop draining
+#define WRITE_BACK_DRAIN_QUEUE_DEPTH	2	//queued NAND requests of a die below which draining adds one
+#define WRITE_BACK_IDLE_SCAN_DEPTH		(AVAILABLE_DATA_BUFFER_ENTRY_COUNT / 4)	//LRU tail entries cleaned by an idle die
+#define WRITE_BACK_COALESCE_DEPTH		(USER_DIES - 1)	//following slices programmed with an evicted one
+#define WRITE_BACK_COALESCE_SCAN_DEPTH	(WRITE_BACK_COALESCE_DEPTH * 2)	//tail entries searched for them
+
+//programs of buffered host data are counted per generation, a flush closes the current generation
+//and completes when its generation and all older ones have no program in flight
+typedef struct _WRITE_BACK_GENERATION_ENTRY {
+	unsigned int pendingProgCnt : 16;
+	unsigned int flushCmdSlotTag : 16;
+} WRITE_BACK_GENERATION_ENTRY, *P_WRITE_BACK_GENERATION_ENTRY;
+
+typedef struct _WRITE_BACK_MAP {
+	WRITE_BACK_GENERATION_ENTRY gen[WRITE_BACK_GENERATION_COUNT];
+	unsigned short fuaPendingProgCnt[WRITE_BACK_CMD_SLOT_COUNT];	//slices of a FUA write not programmed yet
+	unsigned char oldestGen;
+	unsigned char currentGen;
+	unsigned char draining;
+} WRITE_BACK_MAP, *P_WRITE_BACK_MAP;
+
+void InitWriteBack();
+void WriteBackDataBufEntry(unsigned int bufEntry, unsigned int cmdSlotTag, unsigned int forceUnitAccess);
+void WriteBackDataBufRun(unsigned int bufEntry, unsigned int cmdSlotTag);
+void WriteBackDone(unsigned int reqSlotTag);
+void FlushDataBuf(unsigned int cmdSlotTag);
+void WriteBackAllDataBuf();
+void StartFuaWrite(unsigned int cmdSlotTag, unsigned int startLba, unsigned int nlb);
+unsigned int CheckFuaWrite(unsigned int cmdSlotTag);
+void WriteBackScheduler();
+
+extern P_WRITE_BACK_MAP writeBackMapPtr;
+
+#endif /* WRITE_BACK_H_ */
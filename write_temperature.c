@@ -0,0 +1,132 @@
+//////////////////////////////////////////////////////////////////////////////////
+// write_temperature.c for Cosmos+ OpenSSD
+//
+// This file is part of Cosmos+ OpenSSD.
+//
+// Cosmos+ OpenSSD is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3, or (at your option)
+// any later version.
+//
+// Cosmos+ OpenSSD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Cosmos+ OpenSSD; see the file COPYING.
+// If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Project Name: Cosmos+ OpenSSD
+// Design Name: Cosmos+ Firmware
+// Module Name: Write Temperature Tracker
+// File Name: write_temperature.c
+//
+// Version: v1.0.1
+//
+// Description:
+//   - count recent host writes of logical slice groups in decaying 2-bit counters
+//   - report how many groups are at each temperature
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Revision History:
+//
+// * v1.0.1
+//   - slices of a group are merged within a host write command only, rewrites by separate commands all count
+//
+// * v1.0.0
+//   - First draft
+//////////////////////////////////////////////////////////////////////////////////
+
+
+#include "xil_printf.h"
+#include <assert.h>
+#include "memory_map.h"
+
+P_WRITE_TEMPERATURE_MAP writeTemperatureMapPtr;
+
+void InitWriteTemperature()
+{
+	unsigned int wordNo;
+
+	writeTemperatureMapPtr = (P_WRITE_TEMPERATURE_MAP) WRITE_TEMPERATURE_MAP_ADDR;
+
+	for(wordNo = 0; wordNo < WRITE_TEMPERATURE_WORD_COUNT; wordNo++)
+		writeTemperatureMapPtr->counter[wordNo] = 0;
+
+	//the counters cover all logical slices whatever the capacity
+	writeTemperatureMapPtr->groupShift = 0;
+	while(((SLICES_PER_SSD - 1) >> writeTemperatureMapPtr->groupShift) >= WRITE_TEMPERATURE_GROUP_COUNT)
+		writeTemperatureMapPtr->groupShift++;
+
+	writeTemperatureMapPtr->decayWord = 0;
+	writeTemperatureMapPtr->decayTick = 0;
+	writeTemperatureMapPtr->recordedWriteCnt = 0;
+}
+
+static void RecordGroupWrite(unsigned int group)
+{
+	unsigned int wordNo, shift;
+
+	writeTemperatureMapPtr->recordedWriteCnt++;
+
+	wordNo = group / WRITE_TEMPERATURE_COUNTERS_PER_WORD;
+	shift = (group % WRITE_TEMPERATURE_COUNTERS_PER_WORD) * WRITE_TEMPERATURE_BITS;
+	if(((writeTemperatureMapPtr->counter[wordNo] >> shift) & WRITE_TEMPERATURE_MAX) != WRITE_TEMPERATURE_MAX)
+		writeTemperatureMapPtr->counter[wordNo] += 1 << shift;
+
+	if(++writeTemperatureMapPtr->decayTick == WRITE_TEMPERATURE_DECAY_INTERVAL)
+	{
+		writeTemperatureMapPtr->decayTick = 0;
+
+		wordNo = writeTemperatureMapPtr->decayWord;
+		writeTemperatureMapPtr->counter[wordNo] = (writeTemperatureMapPtr->counter[wordNo] >> 1) & WRITE_TEMPERATURE_LOW_BIT_MASK;
+		writeTemperatureMapPtr->decayWord = (wordNo + 1) % WRITE_TEMPERATURE_WORD_COUNT;
+	}
+}
+
+//called once per host write command, which heats a group once however many of its slices it writes,
+//the counters of a word are halved together every WRITE_TEMPERATURE_DECAY_INTERVAL records
+void RecordHostWrite(unsigned int startLsa, unsigned int endLsa)
+{
+	unsigned int group, endGroup;
+
+	if(startLsa >= SLICES_PER_SSD)
+		return;
+	if(endLsa >= SLICES_PER_SSD)
+		endLsa = SLICES_PER_SSD - 1;
+
+	endGroup = endLsa >> writeTemperatureMapPtr->groupShift;
+	for(group = startLsa >> writeTemperatureMapPtr->groupShift; group <= endGroup; group++)
+		RecordGroupWrite(group);
+}
+
+//0 to WRITE_TEMPERATURE_MAX, the recent host writes of the group of the slice
+unsigned int GetSliceTemperature(unsigned int logicalSliceAddr)
+{
+	unsigned int group;
+
+	group = logicalSliceAddr >> writeTemperatureMapPtr->groupShift;
+
+	return (writeTemperatureMapPtr->counter[group / WRITE_TEMPERATURE_COUNTERS_PER_WORD] >>
+			((group % WRITE_TEMPERATURE_COUNTERS_PER_WORD) * WRITE_TEMPERATURE_BITS)) & WRITE_TEMPERATURE_MAX;
+}
+
+void GetWriteTemperatureLog(P_WRITE_TEMPERATURE_LOG log)
+{
+	unsigned int group, temperature;
+
+	log->groupCnt = ((SLICES_PER_SSD - 1) >> writeTemperatureMapPtr->groupShift) + 1;
+	log->slicesPerGroup = 1 << writeTemperatureMapPtr->groupShift;
+	log->decayPeriod = WRITE_TEMPERATURE_DECAY_PERIOD;
+	log->recordedWriteCnt = writeTemperatureMapPtr->recordedWriteCnt;
+
+	for(temperature = 0; temperature <= WRITE_TEMPERATURE_MAX; temperature++)
+		log->groupCntOfTemperature[temperature] = 0;
+
+	for(group = 0; group < log->groupCnt; group++)
+		log->groupCntOfTemperature[GetSliceTemperature(group << writeTemperatureMapPtr->groupShift)]++;
+}
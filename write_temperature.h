@@ -0,0 +1,84 @@
+//////////////////////////////////////////////////////////////////////////////////
+// write_temperature.h for Cosmos+ OpenSSD
+//
+// This file is part of Cosmos+ OpenSSD.
+//
+// Cosmos+ OpenSSD is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3, or (at your option)
+// any later version.
+//
+// Cosmos+ OpenSSD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// See the GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Cosmos+ OpenSSD; see the file COPYING.
+// If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Project Name: Cosmos+ OpenSSD
+// Design Name: Cosmos+ Firmware
+// Module Name: Write Temperature Tracker
+// File Name: write_temperature.h
+//
+// Version: v1.0.1
+//
+// Description:
+//   - define parameters, data structure and functions of write temperature tracker
+//////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////////
+// Revision History:
+//
+// * v1.0.1
+//   - slices of a group are merged within a host write command only, rewrites by separate commands all count
+//
+// * v1.0.0
+//   - First draft
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef WRITE_TEMPERATURE_H_
+#define WRITE_TEMPERATURE_H_
+
+#include "ftl_config.h"
+
+#define WRITE_TEMPERATURE_BITS				2
+#define WRITE_TEMPERATURE_MAX				((1 << WRITE_TEMPERATURE_BITS) - 1)
+#define WRITE_TEMPERATURE_COUNTERS_PER_WORD	(32 / WRITE_TEMPERATURE_BITS)
+#define WRITE_TEMPERATURE_LOW_BIT_MASK		0x55555555	//low bit of every counter of a word
+
+#define WRITE_TEMPERATURE_GROUP_COUNT		(1 << 18)	//counters, neighbouring slices share one when there are more slices
+#define WRITE_TEMPERATURE_WORD_COUNT		(WRITE_TEMPERATURE_GROUP_COUNT / WRITE_TEMPERATURE_COUNTERS_PER_WORD)
+#define WRITE_TEMPERATURE_DECAY_INTERVAL	4			//recorded writes per word of counters halved
+#define WRITE_TEMPERATURE_DECAY_PERIOD		(WRITE_TEMPERATURE_WORD_COUNT * WRITE_TEMPERATURE_DECAY_INTERVAL)	//recorded writes between two halvings of a counter
+
+//a saturating counter per group of slices counts host writes and is halved once per WRITE_TEMPERATURE_DECAY_PERIOD,
+//so its value is the number of recent writes to the group, up to WRITE_TEMPERATURE_MAX
+typedef struct _WRITE_TEMPERATURE_MAP {
+	unsigned int counter[WRITE_TEMPERATURE_WORD_COUNT];
+	unsigned int groupShift;		//log2 of the slices per group
+	unsigned int decayWord;
+	unsigned int decayTick;
+	unsigned int recordedWriteCnt;
+} WRITE_TEMPERATURE_MAP, *P_WRITE_TEMPERATURE_MAP;
+
+//vendor log page VENDOR_LOG_WRITE_TEMPERATURE
+typedef struct _WRITE_TEMPERATURE_LOG {
+	unsigned int groupCnt;			//groups covering the logical slices
+	unsigned int slicesPerGroup;
+	unsigned int decayPeriod;
+	unsigned int recordedWriteCnt;
+	unsigned int groupCntOfTemperature[WRITE_TEMPERATURE_MAX + 1];
+} WRITE_TEMPERATURE_LOG, *P_WRITE_TEMPERATURE_LOG;
+
+void InitWriteTemperature();
+void RecordHostWrite(unsigned int startLsa, unsigned int endLsa);
+unsigned int GetSliceTemperature(unsigned int logicalSliceAddr);
+void GetWriteTemperatureLog(P_WRITE_TEMPERATURE_LOG log);
+
+extern P_WRITE_TEMPERATURE_MAP writeTemperatureMapPtr;
+
+#endif /* WRITE_TEMPERATURE_H_ */